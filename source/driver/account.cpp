@@ -17,6 +17,11 @@ Account::AcctKey Account::getKey(void) const {
     return std::make_tuple( m_name, m_bank_code, m_branch_code, m_number );
 }
 
+/// Returns the branch of the account.
+Account::BranchKey Account::getBranch(void) const {
+    return std::make_pair( m_bank_code, m_branch_code );
+}
+
 std::ostream& operator<< ( std::ostream & os_, const Account::AcctKey & ak_ ) {
     return os_ << "K{"
                << std::get<0>( ak_ ) << ","
@@ -50,6 +55,9 @@ std::size_t KeyHash::operator()( const Account::AcctKey & _k ) const {
         std::hash< int >()(std::get<3>( _k ));
 }
 
+std::size_t BranchHash::operator()( const Account::BranchKey & _k ) const {
+    return std::hash< int >()( _k.first ) * 31 + std::hash< int >()( _k.second );
+}
 
 // Functor that test two keys for equality.
 bool KeyEqual::operator()( const Account::AcctKey & _lhs, const Account::AcctKey & _rhs ) const {
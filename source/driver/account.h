@@ -9,6 +9,7 @@
 #include <iostream>
 #include <functional>
 #include <tuple>
+#include <utility>
 
 /// Represents a bank account.
 struct Account {
@@ -20,12 +21,17 @@ struct Account {
 
     // Nickname for the account key.
     using AcctKey = std::tuple< std::string, int, int, int >;
+    // Nickname for the branch (bank code, branch code) of an account.
+    using BranchKey = std::pair< int, int >;
 
     /// Basic constructor.
     Account( std::string = "<empty>", int = 0, int = 0, int = 0, float = 0.f );
 		     
 	/// Returns the account key.
 	AcctKey getKey(void) const;
+
+	/// Returns the branch of the account.
+	BranchKey getBranch(void) const;
 	
 	/// Stream extractor of the account information. 
 	friend std::ostream &operator<< ( std::ostream & _os, const Account & _acct );
@@ -39,6 +45,10 @@ struct KeyHash {
     std::size_t operator()( const Account::AcctKey & ) const;
 };
 
+/// Functor that generates a hash number for a given branch.
+struct BranchHash {
+    std::size_t operator()( const Account::BranchKey & ) const;
+};
 
 // Functor that test two keys for equality.
 struct KeyEqual {
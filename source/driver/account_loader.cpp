@@ -0,0 +1,312 @@
+/*!
+ * @file account_loader.cpp
+ * @brief Bulk loading of accounts from memory-mapped files.
+ *
+ * @author Lucas Bazante
+ */
+#include "account_loader.h"
+
+#include <algorithm>    // min, max
+#include <cerrno>       // errno
+#include <charconv>     // from_chars, to_chars
+#include <cstdint>      // uint64_t
+#include <cstring>      // memchr, memcpy
+#include <exception>    // exception_ptr
+#include <fstream>      // ofstream
+#include <iterator>     // back_inserter
+#include <stdexcept>    // invalid_argument
+#include <system_error> // system_error
+#include <thread>       // thread
+
+#include <fcntl.h>      // open
+#include <sys/mman.h>   // mmap, munmap, madvise
+#include <sys/stat.h>   // fstat
+#include <unistd.h>     // close
+
+namespace {
+
+    /// Sets the high bit of every byte of w_ equal to c_ (and possibly of bytes above one).
+    inline std::uint64_t match_byte( std::uint64_t w_, unsigned char c_ )
+    {
+        const std::uint64_t ones = 0x0101010101010101ull;
+        const std::uint64_t x = w_ ^ ( ones * c_ );
+        return ( x - ones ) & ~x & ( ones << 7 );
+    }
+
+    /// First ',' or '\n' in [first_, last_), or last_; scans 8 bytes at a time.
+    const char * find_delim( const char * first_, const char * last_ )
+    {
+#if defined( __BYTE_ORDER__ ) and __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        for ( ; last_ - first_ >= 8; first_ += 8 )
+        {
+            std::uint64_t word;
+            std::memcpy( &word, first_, 8 );
+            // The lowest flagged byte is always a true match.
+            if ( auto m = match_byte( word, ',' ) | match_byte( word, '\n' ) )
+                return first_ + __builtin_ctzll( m ) / 8;
+        }
+#endif
+        while ( first_ != last_ and *first_ != ',' and *first_ != '\n' )
+            ++first_;
+        return first_;
+    }
+
+    [[noreturn]] void malformed( const char * what_ )
+    {
+        throw std::invalid_argument( std::string( "Malformed account record: " ) + what_ );
+    }
+
+    /// Parses a number field ending at the next delimiter; advances first_ past the delimiter.
+    template< typename Number >
+    Number parse_field( const char * & first_, const char * last_, char delim_ )
+    {
+        const char * end = find_delim( first_, last_ );
+        if ( end != last_ and *end != delim_ )
+            malformed( "wrong number of fields" );
+
+        Number value{ };
+        const char * stop = end;
+        if ( delim_ == '\n' and stop != first_ and stop[ -1 ] == '\r' )
+            --stop;
+        auto res = std::from_chars( first_, stop, value );
+        if ( res.ec != std::errc( ) or res.ptr != stop )
+            malformed( "bad number" );
+
+        first_ = end == last_ ? end : end + 1;
+        return value;
+    }
+
+    /// Parses the CSV records in [first_, last_), which starts at a line and ends after one.
+    void parse_chunk( const char * first_, const char * last_, std::vector< Account > & out_ )
+    {
+        while ( first_ != last_ )
+        {
+            if ( *first_ == '\n' or *first_ == '\r' ) // Blank line.
+            {
+                ++first_;
+                continue;
+            }
+
+            const char * comma = find_delim( first_, last_ );
+            if ( comma == last_ or *comma != ',' )
+                malformed( "missing fields" );
+
+            out_.emplace_back( );
+            Account & acct = out_.back( );
+            acct.m_name.assign( first_, comma );
+            first_ = comma + 1;
+            acct.m_bank_code = parse_field< int >( first_, last_, ',' );
+            acct.m_branch_code = parse_field< int >( first_, last_, ',' );
+            acct.m_number = parse_field< int >( first_, last_, ',' );
+            acct.m_balance = parse_field< float >( first_, last_, '\n' );
+        }
+    }
+
+    /// Reads binary records into out_ from first_ (past the magic number) until limit_
+    /// bytes are consumed or last_ is reached; returns the start of the next record.
+    const char * read_binary( const char * first_, const char * last_, std::size_t limit_, std::vector< Account > & out_ )
+    {
+        auto take = [ & ]( void * to_, std::size_t n_ ) {
+            if ( std::size_t( last_ - first_ ) < n_ )
+                malformed( "truncated binary record" );
+            std::memcpy( to_, first_, n_ );
+            first_ += n_;
+        };
+
+        const char * stop = limit_ < std::size_t( last_ - first_ ) ? first_ + limit_ : last_;
+        while ( first_ < stop )
+        {
+            std::int32_t bank, branch, number;
+            float balance;
+            std::uint32_t length;
+            take( &bank, sizeof bank );
+            take( &branch, sizeof branch );
+            take( &number, sizeof number );
+            take( &balance, sizeof balance );
+            take( &length, sizeof length );
+            if ( std::size_t( last_ - first_ ) < length )
+                malformed( "truncated binary record" );
+
+            out_.emplace_back( std::string( first_, length ), bank, branch, number, balance );
+            first_ += length;
+        }
+
+        return first_;
+    }
+
+    /// End of the CSV chunk starting at first_: about limit_ bytes, moved forward past a newline.
+    const char * chunk_end( const char * first_, const char * last_, std::size_t limit_ )
+    {
+        if ( std::size_t( last_ - first_ ) <= limit_ )
+            return last_;
+        auto nl = static_cast< const char * >( std::memchr( first_ + limit_, '\n', last_ - first_ - limit_ ) );
+        return nl == nullptr ? last_ : nl + 1;
+    }
+}
+
+/// Maps the file; throws std::system_error if it cannot be opened or mapped.
+MappedFile::MappedFile( const std::string & path_ )
+{
+    int fd = ::open( path_.c_str(), O_RDONLY );
+    if ( fd < 0 )
+        throw std::system_error( errno, std::generic_category(), path_ );
+
+    struct stat st;
+    if ( ::fstat( fd, &st ) != 0 )
+    {
+        int err = errno;
+        ::close( fd );
+        throw std::system_error( err, std::generic_category(), path_ );
+    }
+
+    m_size = st.st_size;
+    if ( m_size != 0 )
+    {
+        void * addr = ::mmap( nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+        if ( addr == MAP_FAILED )
+        {
+            int err = errno;
+            ::close( fd );
+            throw std::system_error( err, std::generic_category(), path_ );
+        }
+        ::madvise( addr, m_size, MADV_SEQUENTIAL ); // Read-ahead aggressively, drop pages behind.
+        m_data = static_cast< const char * >( addr );
+    }
+    ::close( fd ); // The mapping keeps the file alive.
+}
+
+MappedFile::~MappedFile()
+{
+    if ( m_data != nullptr )
+        ::munmap( const_cast< char * >( m_data ), m_size );
+}
+
+/// Parses the CSV records in [first_, last_), split in chunks parsed by n_threads_ threads.
+std::vector< Account > parse_accounts( const char * first_, const char * last_, std::size_t n_threads_ )
+{
+    // Chunk boundaries, moved forward to the start of a line.
+    const std::size_t length = last_ - first_;
+    n_threads_ = std::max< std::size_t >( 1, std::min( n_threads_, length / 4096 + 1 ) );
+    std::vector< const char * > bounds{ first_ };
+    for ( std::size_t t = 1; t < n_threads_; ++t )
+    {
+        const char * cut = std::max( bounds.back(), first_ + length * t / n_threads_ );
+        auto nl = static_cast< const char * >( std::memchr( cut, '\n', last_ - cut ) );
+        bounds.push_back( nl == nullptr ? last_ : nl + 1 );
+    }
+    bounds.push_back( last_ );
+
+    std::vector< std::vector< Account > > parts( n_threads_ );
+    std::vector< std::exception_ptr > errors( n_threads_ );
+    auto work = [ & ]( std::size_t t_ ) {
+        try { parse_chunk( bounds[ t_ ], bounds[ t_ + 1 ], parts[ t_ ] ); }
+        catch ( ... ) { errors[ t_ ] = std::current_exception(); }
+    };
+
+    std::vector< std::thread > threads;
+    for ( std::size_t t = 1; t < n_threads_; ++t )
+        threads.emplace_back( work, t );
+    work( 0 );
+    for ( auto & th : threads )
+        th.join();
+
+    for ( auto & err : errors )
+        if ( err )
+            std::rethrow_exception( err );
+
+    // Stitch the chunks together, in file order.
+    std::size_t total = 0;
+    for ( const auto & part : parts )
+        total += part.size();
+    std::vector< Account > accounts = std::move( parts[ 0 ] );
+    accounts.reserve( total );
+    for ( std::size_t t = 1; t < n_threads_; ++t )
+        std::move( parts[ t ].begin(), parts[ t ].end(), std::back_inserter( accounts ) );
+
+    return accounts;
+}
+
+/// Maps an account file and inserts its records into the table, a chunk at a time.
+std::size_t load_accounts( const std::string & path_, AccountTbl & table_, std::size_t n_threads_, std::size_t chunk_bytes_ )
+{
+    chunk_bytes_ = std::max< std::size_t >( 1, chunk_bytes_ );
+    MappedFile file( path_ );
+    const char * first = file.data();
+    const char * last = first + file.size();
+    const bool binary = file.size() >= sizeof ACCOUNT_MAGIC and std::memcmp( first, ACCOUNT_MAGIC, sizeof ACCOUNT_MAGIC ) == 0;
+    if ( binary )
+        first += sizeof ACCOUNT_MAGIC;
+
+    // Only one chunk of records is held outside the table. Each record is copied
+    // into its node twice, as the key and the data (both hold the name).
+    std::vector< Account > accounts;
+    std::vector< Account::AcctKey > keys;
+    std::size_t total = 0;
+    bool sized = false;
+    while ( first != last )
+    {
+        const char * start = first;
+        if ( binary )
+        {
+            accounts.clear();
+            first = read_binary( first, last, chunk_bytes_, accounts );
+        }
+        else
+        {
+            first = chunk_end( first, last, chunk_bytes_ );
+            accounts = parse_accounts( start, first, n_threads_ );
+        }
+        if ( accounts.empty() )
+            continue;
+
+        // One resize for the whole file, from the average record length so far.
+        if ( not sized )
+        {
+            const std::size_t record_bytes = std::max< std::size_t >( 1, ( first - start ) / accounts.size() );
+            table_.reserve( table_.size() + std::size_t( last - start ) / record_bytes );
+            sized = true;
+        }
+
+        keys.clear();
+        for ( const auto & acct : accounts )
+            keys.push_back( acct.getKey() );
+        table_.insert_batch( keys.data(), accounts.data(), accounts.size() ); // Later records win.
+        total += accounts.size();
+    }
+
+    return total;
+}
+
+/// Writes the accounts to a file in the given format.
+void save_accounts( const std::string & path_, const std::vector< Account > & accounts_, AccountFormat format_ )
+{
+    std::ofstream out( path_, std::ios::binary );
+    if ( not out )
+        throw std::system_error( errno, std::generic_category(), path_ );
+
+    if ( format_ == AccountFormat::BINARY )
+    {
+        out.write( ACCOUNT_MAGIC, sizeof ACCOUNT_MAGIC );
+        for ( const auto & acct : accounts_ )
+        {
+            std::int32_t fields[ 3 ] = { acct.m_bank_code, acct.m_branch_code, acct.m_number };
+            std::uint32_t length = acct.m_name.size();
+            out.write( reinterpret_cast< const char * >( fields ), sizeof fields );
+            out.write( reinterpret_cast< const char * >( &acct.m_balance ), sizeof acct.m_balance );
+            out.write( reinterpret_cast< const char * >( &length ), sizeof length );
+            out.write( acct.m_name.data(), length );
+        }
+        return;
+    }
+
+    char balance[ 32 ];
+    for ( const auto & acct : accounts_ )
+    {
+        // Shortest representation that reads back to the same float.
+        auto res = std::to_chars( balance, balance + sizeof balance, acct.m_balance );
+        out << acct.m_name << ',' << acct.m_bank_code << ',' << acct.m_branch_code << ','
+            << acct.m_number << ',';
+        out.write( balance, res.ptr - balance );
+        out << '\n';
+    }
+}
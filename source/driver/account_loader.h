@@ -0,0 +1,61 @@
+/*!
+ * @file account_loader.h
+ * @brief Bulk loading of accounts from memory-mapped files.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef ACCOUNT_LOADER_H
+#define ACCOUNT_LOADER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "../include/hashtbl.h"
+#include "account.h"
+
+/// Table of accounts, as built by the driver.
+using AccountTbl = ac::HashTbl< Account::AcctKey, Account, KeyHash, KeyEqual >;
+
+/// Layouts of an account file.
+enum class AccountFormat {
+    CSV,    //!< One "name,bank,branch,number,balance" record per line.
+    BINARY  //!< ACCOUNT_MAGIC, then per record: bank, branch, number (int32), balance (float), name length (uint32), name bytes.
+};
+
+/// First bytes of a binary account file.
+constexpr char ACCOUNT_MAGIC[ 8 ] = { 'A', 'C', 'C', 'T', 'B', 'I', 'N', '1' };
+
+/// A read-only memory mapping of a whole file.
+class MappedFile {
+    public:
+        /// Maps the file; throws std::system_error if it cannot be opened or mapped.
+        explicit MappedFile( const std::string & path_ );
+        MappedFile( const MappedFile & ) = delete;
+        MappedFile & operator=( const MappedFile & ) = delete;
+        ~MappedFile();
+
+        const char * data( void ) const { return m_data; }
+        std::size_t size( void ) const { return m_size; }
+
+    private:
+        const char * m_data = nullptr; //!< Start of the mapping.
+        std::size_t m_size = 0;        //!< Length of the file.
+};
+
+/// Parses the CSV records in [first_, last_), split in chunks parsed by n_threads_ threads.
+/// Throws std::invalid_argument on a malformed record.
+std::vector< Account > parse_accounts( const char * first_, const char * last_, std::size_t n_threads_ = 1 );
+
+/// Maps a CSV or binary (detected by ACCOUNT_MAGIC) account file and inserts its records
+/// into the table, parsing and inserting about chunk_bytes_ of the file at a time. The table
+/// is sized once, from the file size and the average length of the first records.
+/// Returns the number of records read.
+std::size_t load_accounts( const std::string & path_, AccountTbl & table_, std::size_t n_threads_ = 1,
+                           std::size_t chunk_bytes_ = std::size_t( 4 ) << 20 );
+
+/// Writes the accounts to a file in the given format.
+void save_accounts( const std::string & path_, const std::vector< Account > & accounts_, AccountFormat format_ );
+
+#endif
@@ -2,15 +2,17 @@
 #include <functional>
 #include <tuple>
 #include <cassert>
+#include <thread>
 
 #include "../include/hashtbl.h"
 #include "account.h"
+#include "account_loader.h"
 
 using namespace ac;
 
 //=== CLIENT CODE
 
-int main() {
+int main( int argc, char * argv[] ) {
     Account acct("Alex Bastos", 1, 1668, 54321, 1500.f);
     Account myAccounts[] =
     {
@@ -110,6 +112,14 @@ int main() {
             assert( conta_teste == e );
         }
     }
+    if ( argc > 1 )
+    {
+        // Bulk load an account file (CSV or binary).
+        HashTbl< Account::AcctKey, Account, KeyHash, KeyEqual > contas;
+        auto n = load_accounts( argv[1], contas, std::thread::hardware_concurrency() );
+        std::cout << "\n>>> Loaded " << n << " records from \"" << argv[1] << "\", "
+                  << contas.size() << " distinct accounts.\n";
+    }
     
     return EXIT_SUCCESS;
 }
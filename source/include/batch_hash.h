@@ -0,0 +1,258 @@
+/*!
+ * @file batch_hash.h
+ * @brief Hashing of whole arrays of keys, with AVX2 and AVX-512 kernels for MixHash.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _BATCH_HASH_H_
+#define _BATCH_HASH_H_
+
+#include <cstddef>          // size_t
+#include <cstdint>          // uint32_t, uint64_t
+#include <type_traits>      // is_same, is_signed, underlying_type, enable_if
+
+#include "hash_mix.h"       // MixHash, mix64, GOLDEN_GAMMA
+
+// The vector kernels are compiled for their instruction set with function attributes,
+// whatever the -m flags, and chosen at run time; other compilers and targets get the
+// scalar loop only.
+#if ( defined( __x86_64__ ) or defined( __i386__ ) ) and ( defined( __GNUC__ ) or defined( __clang__ ) )
+#define AC_BATCH_X86 1
+#include <immintrin.h>      // _mm256_*, _mm512_*
+#define AC_TARGET( isa_ ) __attribute__( ( target( isa_ ) ) )
+// GCC warns (-Wmaybe-uninitialized, from -O2) about the deliberately undefined
+// vectors inside its AVX-512 intrinsics, so their kernels are compiled without it.
+#if defined( __GNUC__ ) and not defined( __clang__ )
+#define AC_AVX512_BEGIN _Pragma( "GCC diagnostic push" ) _Pragma( "GCC diagnostic ignored \"-Wmaybe-uninitialized\"" )
+#define AC_AVX512_END _Pragma( "GCC diagnostic pop" )
+#else
+#define AC_AVX512_BEGIN
+#define AC_AVX512_END
+#endif
+#endif
+
+namespace ac // Associative container
+{
+    /// Instruction sets the batch kernels can use.
+    enum class SimdLevel {
+        SCALAR, //!< One key at a time.
+        AVX2,   //!< Four keys at a time.
+        AVX512  //!< Eight keys at a time (AVX-512F and DQ).
+    };
+
+    // Finds the best instruction set of the processor running the program.
+    /*!
+     * Detected once.
+     *
+     * @return The widest level whose instructions are all supported.
+     */
+    inline SimdLevel cpu_simd_level( )
+    {
+        static const SimdLevel level = [ ]{
+#if defined( AC_BATCH_X86 )
+            __builtin_cpu_init( );
+            if ( __builtin_cpu_supports( "avx512f" ) and __builtin_cpu_supports( "avx512dq" ) )
+                return SimdLevel::AVX512;
+            if ( __builtin_cpu_supports( "avx2" ) )
+                return SimdLevel::AVX2;
+#endif
+            return SimdLevel::SCALAR;
+        }( );
+        return level;
+    }
+
+    namespace detail
+    {
+        /// How MixHash reads a key: as one integer (widened to 64 bits) or as 64-bit words.
+        template< class KeyType, class = void >
+        struct batch_layout { static constexpr bool integer = false; static constexpr bool is_signed = false; };
+
+        template< class KeyType >
+        struct batch_layout< KeyType, std::enable_if_t< std::is_integral_v< KeyType > or std::is_enum_v< KeyType > > > {
+            using value_type = std::conditional_t< std::is_enum_v< KeyType >, std::underlying_type< KeyType >, std::common_type< KeyType > >;
+            static constexpr bool integer = true;
+            static constexpr bool is_signed = std::is_signed_v< typename value_type::type >;
+        };
+
+        /// Whether a batch of KeyType under KeyHash has a vector kernel: MixHash of 4 or 8-byte integers, or of keys made of 64-bit words.
+        template< class KeyHash, class KeyType >
+        constexpr bool batch_kernel_v = std::is_same_v< KeyHash, MixHash< KeyType > >
+            and ( batch_layout< KeyType >::integer ? ( sizeof( KeyType ) == 4 or sizeof( KeyType ) == 8 )
+                                                   : sizeof( KeyType ) % 8 == 0 );
+
+#if defined( AC_BATCH_X86 )
+        /// 64-bit multiplication of each lane by a constant, from 32-bit products (AVX2 has no 64-bit one).
+        AC_TARGET( "avx2" ) inline __m256i mul64_avx2( __m256i a_, __m256i b_ )
+        {
+            const __m256i lo = _mm256_mul_epu32( a_, b_ );
+            const __m256i cross = _mm256_add_epi64( _mm256_mul_epu32( _mm256_srli_epi64( a_, 32 ), b_ ),
+                                                    _mm256_mul_epu32( a_, _mm256_srli_epi64( b_, 32 ) ) );
+            return _mm256_add_epi64( lo, _mm256_slli_epi64( cross, 32 ) );
+        }
+
+        /// mix64() of four lanes.
+        AC_TARGET( "avx2" ) inline __m256i mix64_avx2( __m256i x_ )
+        {
+            x_ = _mm256_xor_si256( x_, _mm256_srli_epi64( x_, 33 ) );
+            x_ = mul64_avx2( x_, _mm256_set1_epi64x( static_cast< long long >( 0xff51afd7ed558ccdULL ) ) );
+            x_ = _mm256_xor_si256( x_, _mm256_srli_epi64( x_, 33 ) );
+            x_ = mul64_avx2( x_, _mm256_set1_epi64x( static_cast< long long >( 0xc4ceb9fe1a85ec53ULL ) ) );
+            return _mm256_xor_si256( x_, _mm256_srli_epi64( x_, 33 ) );
+        }
+
+        AC_AVX512_BEGIN
+        /// mix64() of eight lanes.
+        AC_TARGET( "avx512f,avx512dq" ) inline __m512i mix64_avx512( __m512i x_ )
+        {
+            x_ = _mm512_xor_si512( x_, _mm512_srli_epi64( x_, 33 ) );
+            x_ = _mm512_mullo_epi64( x_, _mm512_set1_epi64( static_cast< long long >( 0xff51afd7ed558ccdULL ) ) );
+            x_ = _mm512_xor_si512( x_, _mm512_srli_epi64( x_, 33 ) );
+            x_ = _mm512_mullo_epi64( x_, _mm512_set1_epi64( static_cast< long long >( 0xc4ceb9fe1a85ec53ULL ) ) );
+            return _mm512_xor_si512( x_, _mm512_srli_epi64( x_, 33 ) );
+        }
+        AC_AVX512_END
+
+        /// Integer keys, four at a time; returns how many keys were hashed (the rest is left to the scalar loop).
+        template< class KeyType >
+        AC_TARGET( "avx2" ) std::size_t mix_integers_avx2( const KeyType * keys_, std::size_t n_, std::size_t * out_ )
+        {
+            std::size_t i = 0;
+            for ( ; i + 4 <= n_; i += 4 )
+            {
+                __m256i x;
+                if constexpr ( sizeof( KeyType ) == 8 )
+                    x = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( keys_ + i ) );
+                else if constexpr ( batch_layout< KeyType >::is_signed )
+                    x = _mm256_cvtepi32_epi64( _mm_loadu_si128( reinterpret_cast< const __m128i * >( keys_ + i ) ) );
+                else
+                    x = _mm256_cvtepu32_epi64( _mm_loadu_si128( reinterpret_cast< const __m128i * >( keys_ + i ) ) );
+                _mm256_storeu_si256( reinterpret_cast< __m256i * >( out_ + i ), mix64_avx2( x ) );
+            }
+            return i;
+        }
+
+        AC_AVX512_BEGIN
+        /// Integer keys, eight at a time.
+        template< class KeyType >
+        AC_TARGET( "avx512f,avx512dq" ) std::size_t mix_integers_avx512( const KeyType * keys_, std::size_t n_, std::size_t * out_ )
+        {
+            std::size_t i = 0;
+            for ( ; i + 8 <= n_; i += 8 )
+            {
+                __m512i x;
+                if constexpr ( sizeof( KeyType ) == 8 )
+                    x = _mm512_loadu_si512( keys_ + i );
+                else if constexpr ( batch_layout< KeyType >::is_signed )
+                    x = _mm512_cvtepi32_epi64( _mm256_loadu_si256( reinterpret_cast< const __m256i * >( keys_ + i ) ) );
+                else
+                    x = _mm512_cvtepu32_epi64( _mm256_loadu_si256( reinterpret_cast< const __m256i * >( keys_ + i ) ) );
+                _mm512_storeu_si512( out_ + i, mix64_avx512( x ) );
+            }
+            return i;
+        }
+        AC_AVX512_END
+
+        /// Keys of several 64-bit words, four at a time (one key per lane, its words gathered).
+        template< class KeyType >
+        AC_TARGET( "avx2" ) std::size_t mix_words_avx2( const KeyType * keys_, std::size_t n_, std::size_t * out_ )
+        {
+            constexpr long long WORDS = sizeof( KeyType ) / 8;
+            const auto * base = reinterpret_cast< const long long * >( keys_ );
+            std::size_t i = 0;
+            for ( ; i + 4 <= n_; i += 4 )
+            {
+                __m256i index = _mm256_setr_epi64x( 0, WORDS, 2 * WORDS, 3 * WORDS );
+                __m256i h = _mm256_set1_epi64x( sizeof( KeyType ) );
+                for ( long long w = 0; w < WORDS; ++w )
+                {
+                    const __m256i word = _mm256_i64gather_epi64( base + i * WORDS, index, 8 );
+                    const __m256i seed = _mm256_set1_epi64x( static_cast< long long >( 8 * w * GOLDEN_GAMMA ) );
+                    h = mix64_avx2( _mm256_xor_si256( _mm256_xor_si256( h, word ), seed ) );
+                    index = _mm256_add_epi64( index, _mm256_set1_epi64x( 1 ) );
+                }
+                _mm256_storeu_si256( reinterpret_cast< __m256i * >( out_ + i ), h );
+            }
+            return i;
+        }
+
+        AC_AVX512_BEGIN
+        /// Keys of several 64-bit words, eight at a time.
+        template< class KeyType >
+        AC_TARGET( "avx512f,avx512dq" ) std::size_t mix_words_avx512( const KeyType * keys_, std::size_t n_, std::size_t * out_ )
+        {
+            constexpr long long WORDS = sizeof( KeyType ) / 8;
+            const auto * base = reinterpret_cast< const long long * >( keys_ );
+            std::size_t i = 0;
+            for ( ; i + 8 <= n_; i += 8 )
+            {
+                __m512i index = _mm512_mullo_epi64( _mm512_setr_epi64( 0, 1, 2, 3, 4, 5, 6, 7 ), _mm512_set1_epi64( WORDS ) );
+                __m512i h = _mm512_set1_epi64( sizeof( KeyType ) );
+                for ( long long w = 0; w < WORDS; ++w )
+                {
+                    const __m512i word = _mm512_i64gather_epi64( index, base + i * WORDS, 8 );
+                    const __m512i seed = _mm512_set1_epi64( static_cast< long long >( 8 * w * GOLDEN_GAMMA ) );
+                    h = mix64_avx512( _mm512_xor_si512( _mm512_xor_si512( h, word ), seed ) );
+                    index = _mm512_add_epi64( index, _mm512_set1_epi64( 1 ) );
+                }
+                _mm512_storeu_si512( out_ + i, h );
+            }
+            return i;
+        }
+        AC_AVX512_END
+#endif
+    }
+
+    // Hashes an array of keys.
+    /*!
+     * out_[ i ] = hashf_( keys_[ i ] ), for every i. When KeyHash is the MixHash of
+     * 4 or 8-byte integers (or enums), or of keys made of 64-bit words, the keys are
+     * hashed four (AVX2) or eight (AVX-512) at a time, up to the given level;
+     * otherwise, and for the last few keys, one at a time. The results are the same
+     * at every level.
+     *
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyType The key type.
+     *
+     * @param hashf_ The hash function.
+     * @param keys_ The keys.
+     * @param n_ Number of keys.
+     * @param out_ Array of n_ hashes to be filled in.
+     * @param level_ Widest instruction set to use (the processor's by default).
+     */
+    template< class KeyHash, class KeyType >
+    void hash_batch( const KeyHash & hashf_, const KeyType * keys_, std::size_t n_, std::size_t * out_,
+                     SimdLevel level_ = cpu_simd_level( ) )
+    {
+        std::size_t done = 0;
+#if defined( AC_BATCH_X86 )
+        if constexpr ( detail::batch_kernel_v< KeyHash, KeyType > and sizeof( std::size_t ) == 8 )
+        {
+            if constexpr ( detail::batch_layout< KeyType >::integer )
+            {
+                if ( level_ == SimdLevel::AVX512 )
+                    done = detail::mix_integers_avx512( keys_, n_, out_ );
+                else if ( level_ == SimdLevel::AVX2 )
+                    done = detail::mix_integers_avx2( keys_, n_, out_ );
+            }
+            else
+            {
+                if ( level_ == SimdLevel::AVX512 )
+                    done = detail::mix_words_avx512( keys_, n_, out_ );
+                else if ( level_ == SimdLevel::AVX2 )
+                    done = detail::mix_words_avx2( keys_, n_, out_ );
+            }
+        }
+#else
+        ( void ) level_;
+#endif
+        for ( std::size_t i = done; i < n_; ++i )
+            out_[ i ] = hashf_( keys_[ i ] );
+    }
+
+    /// Whether hash_batch() has a vector kernel for KeyType under KeyHash (it hashes one key at a time otherwise).
+    template< class KeyHash, class KeyType >
+    constexpr bool has_batch_kernel_v = detail::batch_kernel_v< KeyHash, KeyType >;
+
+} // Namespace ac.
+#endif
@@ -0,0 +1,176 @@
+/*!
+ * @file bucket_array.h
+ * @brief Allocation of bucket arrays: cache-line alignment and huge pages.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _BUCKET_ARRAY_H_
+#define _BUCKET_ARRAY_H_
+
+#include <cstddef>          // size_t
+#include <cstdint>          // uintptr_t
+#include <memory>           // unique_ptr, uninitialized_value_construct_n, destroy_n
+#include <new>              // operator new, align_val_t, bad_alloc
+
+#if defined( __linux__ )
+#include <sys/mman.h>       // mmap, munmap, madvise
+#endif
+
+namespace ac // Associative container
+{
+    constexpr std::size_t CACHE_LINE_SIZE = 64;          //!< Alignment of every array.
+    constexpr std::size_t HUGE_PAGE_SIZE = 2u << 20;     //!< Huge page size assumed (x86-64, arm64).
+
+    /// Which pages back a large array.
+    enum class PagePolicy {
+        DEFAULT,          //!< The heap, with regular pages.
+        TRANSPARENT_HUGE, //!< An anonymous mapping aligned to a huge page, advised with MADV_HUGEPAGE.
+        EXPLICIT_HUGE     //!< A MAP_HUGETLB mapping (needs reserved huge pages); transparent huge pages if that fails.
+    };
+
+    /// How a table allocates its bucket array.
+    struct AllocationPolicy {
+        PagePolicy m_pages = PagePolicy::DEFAULT;       //!< Pages requested.
+        bool m_prefault = false;                        //!< Whether to populate the pages in one call, up front.
+        std::size_t m_huge_threshold = HUGE_PAGE_SIZE;  //!< Smaller arrays always come from the heap.
+        std::size_t m_max_bytes = 0;                    //!< Larger arrays fail with std::bad_alloc (0: no limit).
+    };
+
+    /*!
+     * Destroys and frees an array made by allocate_array(), remembering where it came from.
+     *
+     * @tparam T The element type.
+     */
+    template< class T >
+    class ArrayDeleter {
+        public:
+            ArrayDeleter( ) = default;
+            ArrayDeleter( std::size_t n_, std::size_t mapped_, PagePolicy pages_ )
+                : m_count{ n_ }, m_mapped{ mapped_ }, m_pages{ pages_ }
+            {/*Empty*/}
+
+            void operator()( T * p_ ) const
+            {
+                std::destroy_n( p_, m_count );
+#if defined( __linux__ )
+                if ( m_mapped != 0 )
+                {
+                    munmap( p_, m_mapped );
+                    return;
+                }
+#endif
+                ::operator delete( p_, std::align_val_t{ CACHE_LINE_SIZE } );
+            }
+
+            /// Pages the array actually got.
+            PagePolicy pages( ) const { return m_pages; };
+
+        private:
+            std::size_t m_count = 0;                   //!< Elements constructed.
+            std::size_t m_mapped = 0;                  //!< Bytes mapped, or 0 if on the heap.
+            PagePolicy m_pages = PagePolicy::DEFAULT;  //!< Pages obtained.
+    };
+
+    /// An array made by allocate_array().
+    template< class T >
+    using array_ptr = std::unique_ptr< T [], ArrayDeleter< T > >;
+
+    namespace detail
+    {
+        /// Maps len_ bytes (a multiple of HUGE_PAGE_SIZE) at a huge-page boundary; nullptr on failure.
+        inline void * map_huge_aligned( std::size_t len_ )
+        {
+#if defined( __linux__ )
+            // Over-map by one huge page and trim both ends.
+            void * raw = mmap( nullptr, len_ + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+            if ( raw == MAP_FAILED )
+                return nullptr;
+
+            const auto first = reinterpret_cast< std::uintptr_t >( raw );
+            const auto start = ( first + HUGE_PAGE_SIZE - 1 ) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+            if ( start > first )
+                munmap( raw, start - first );
+            if ( first + HUGE_PAGE_SIZE > start )
+                munmap( reinterpret_cast< void * >( start + len_ ), first + HUGE_PAGE_SIZE - start );
+            return reinterpret_cast< void * >( start );
+#else
+            ( void ) len_;
+            return nullptr;
+#endif
+        }
+    }
+
+    // Allocates an array of value-initialized elements.
+    /*!
+     * The array is aligned to a cache line. If the policy asks for huge pages and the
+     * array is large enough, it is mapped instead, aligned to a huge page; if that
+     * fails, it comes from the heap. Either way every page is written while the
+     * elements are constructed, so none faults later; m_prefault populates the
+     * mapping in one call instead of one fault per page. An array larger than the
+     * policy's m_max_bytes is refused with std::bad_alloc, as if memory had run out.
+     *
+     * @tparam T The element type.
+     *
+     * @param n_ Number of elements.
+     * @param policy_ Pages requested.
+     *
+     * @return The array, whose deleter tells which pages it got.
+     */
+    template< class T >
+    array_ptr< T > allocate_array( std::size_t n_, const AllocationPolicy & policy_ = AllocationPolicy{ } )
+    {
+        static_assert( alignof( T ) <= CACHE_LINE_SIZE, "over-aligned elements" );
+        const std::size_t bytes = ( n_ == 0 ? 1 : n_ ) * sizeof( T );
+        if ( policy_.m_max_bytes != 0 and bytes > policy_.m_max_bytes )
+            throw std::bad_alloc( );
+        void * mem = nullptr;
+        std::size_t mapped = 0;
+        PagePolicy pages = PagePolicy::DEFAULT;
+
+#if defined( __linux__ )
+        if ( policy_.m_pages != PagePolicy::DEFAULT and bytes >= policy_.m_huge_threshold )
+        {
+            const std::size_t len = ( bytes + HUGE_PAGE_SIZE - 1 ) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+#if defined( MAP_HUGETLB )
+            if ( policy_.m_pages == PagePolicy::EXPLICIT_HUGE )
+            {
+                void * p = mmap( nullptr, len, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | ( policy_.m_prefault ? MAP_POPULATE : 0 ), -1, 0 );
+                if ( p != MAP_FAILED )
+                    mem = p, mapped = len, pages = PagePolicy::EXPLICIT_HUGE;
+            }
+#endif
+            if ( mem == nullptr and ( mem = detail::map_huge_aligned( len ) ) != nullptr )
+            {
+                mapped = len, pages = PagePolicy::TRANSPARENT_HUGE;
+#if defined( MADV_HUGEPAGE )
+                madvise( mem, len, MADV_HUGEPAGE ); // Best effort: THP may be disabled.
+#endif
+                if ( policy_.m_prefault )
+                {
+                    const int MADV_POPULATE_WRITE_ = 23; // Linux 5.14; older kernels fault in on construction.
+                    madvise( mem, len, MADV_POPULATE_WRITE_ );
+                }
+            }
+        }
+#endif
+
+        if ( mem == nullptr )
+            mem = ::operator new( bytes, std::align_val_t{ CACHE_LINE_SIZE } );
+
+        T * first = static_cast< T * >( mem );
+        try
+        {
+            std::uninitialized_value_construct_n( first, n_ );
+        }
+        catch ( ... )
+        {
+            ArrayDeleter< T >( 0, mapped, pages )( first );
+            throw;
+        }
+        return array_ptr< T >( first, ArrayDeleter< T >( n_, mapped, pages ) );
+    }
+
+} // Namespace ac.
+#endif
@@ -0,0 +1,114 @@
+/*!
+ * @file combining_hashtbl.h
+ * @brief Thread-safe hash table whose operations are applied in batches by flat combining.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _COMBINING_HASHTBL_H_
+#define _COMBINING_HASHTBL_H_
+
+#include <algorithm>        // max
+#include <atomic>           // atomic
+#include <exception>        // exception_ptr, current_exception, rethrow_exception
+#include <functional>       // hash, equal_to
+#include <memory>           // unique_ptr
+#include <thread>           // thread, yield
+
+#include "hashtbl.h"        // HashTbl
+
+namespace ac // Associative container
+{
+    /*!
+     * This class implements a thread-safe hash table for write-heavy workloads
+     * where many threads hit the same few keys.
+     *
+     * Instead of each thread taking a lock in turn (handing the lock, and the
+     * table's cache lines, from core to core for every operation), a thread
+     * publishes its operation in a slot of its own cache line and waits. Whichever
+     * waiting thread grabs the combiner flag applies all the pending operations,
+     * several passes over the slots, to the underlying HashTbl, and hands back
+     * each result (or exception); the others just watch their slot. The table
+     * stays in the combiner's cache for the whole batch.
+     *
+     * Operations are linearizable: each takes effect while the combiner applies
+     * it, and callbacks (update(), upsert(), compute(), execute()) run on the
+     * combiner thread, alone on the table, so they must not call back into it.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< class KeyType,
+		      class DataType,
+		      class KeyHash = std::hash< KeyType >,
+		      class KeyEqual = std::equal_to< KeyType > >
+	class CombiningHashTbl {
+        public:
+            // Aliases
+            using table_type = HashTbl< KeyType, DataType, KeyHash, KeyEqual >;
+            using size_type = std::size_t;
+
+            /// Constructors
+            explicit CombiningHashTbl( size_type table_sz_ = DEFAULT_SIZE, size_type n_slots_ = default_slots( ) );
+            CombiningHashTbl( const CombiningHashTbl & ) = delete;
+
+            /// Overloaded operators
+            CombiningHashTbl & operator=( const CombiningHashTbl & ) = delete;
+
+            /// Class methods
+            bool insert( const KeyType &, const DataType & );
+            template< class Function >
+            bool update( const KeyType &, Function );
+            template< class Make, class Update >
+            bool upsert( const KeyType &, Make, Update );
+            template< class Function >
+            bool compute( const KeyType &, Function );
+            bool erase( const KeyType & );
+            bool retrieve( const KeyType &, DataType & );
+            size_type count( const KeyType & );
+            void clear( );
+            template< class Function >
+            bool execute( Function );
+            size_type size( ) const { return m_size.load( std::memory_order_acquire ); };
+            bool empty( ) const { return size( ) == 0; };
+            size_type slots( ) const { return m_n_slots; };
+
+        private:
+            /// States of a slot.
+            enum SlotState : int {
+                FREE,       //!< Available to any thread.
+                WRITING,    //!< Claimed; its owner is filling it in.
+                PENDING,    //!< Waiting for the combiner.
+                DONE        //!< Applied; the result is ready for its owner.
+            };
+
+            /// A published operation, in a cache line of its own.
+            struct alignas( 64 ) Slot {
+                std::atomic< int > m_state{ FREE };
+                bool ( *m_call )( void *, table_type & ) = nullptr; //!< Runs the operation.
+                void * m_op = nullptr;                                //!< The operation, on its owner's stack.
+                bool m_result = false;                                //!< What the operation returned.
+                std::exception_ptr m_error;                           //!< What the operation threw.
+            };
+
+            /// Private methods
+            static size_type default_slots( );
+            static size_type home_slot( );
+            template< class Function >
+            bool run( Function & );
+            void combine( );
+
+        private:
+            table_type m_table;                        //!< The data; touched only by the combiner.
+            std::unique_ptr< Slot[] > m_slots;         //!< Published operations.
+            size_type m_n_slots;                       //!< Number of slots.
+            alignas( 64 ) std::atomic< bool > m_combining{ false }; //!< Held by the thread applying the operations.
+            std::atomic< size_type > m_size{ 0 };      //!< Size of the table after the last operation.
+            static const short DEFAULT_SIZE = 11;
+    };
+
+} // Namespace ac.
+#include "combining_hashtbl.inl"
+#endif
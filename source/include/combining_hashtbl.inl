@@ -0,0 +1,353 @@
+/*!
+ * @file combining_hashtbl.inl
+ * @brief Implementation of the CombiningHashTbl class methods.
+ *
+ * @author Lucas Bazante
+ */
+
+#include "combining_hashtbl.h"
+
+namespace ac {
+
+    /// CONSTRUCTORS
+
+    // Regular constructor.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param table_sz_ Initial number of buckets of the table.
+     * @param n_slots_ Number of slots; more threads than slots works, with threads waiting for a free slot.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+	CombiningHashTbl<KeyType,DataType,KeyHash,KeyEqual>::CombiningHashTbl( size_type table_sz_, size_type n_slots_ )
+        : m_table( table_sz_ )
+        , m_slots( new Slot[ std::max< size_type >( n_slots_, 1 ) ] )
+        , m_n_slots( std::max< size_type >( n_slots_, 1 ) )
+	{/*Empty*/}
+
+    /// CLASS METHODS
+
+    // Inserts data into the hash table according to the associated key.
+    /*!
+     * Inserts the new entry if the key does not exist and updates the data otherwise.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key associated with data.
+     * @param new_data_ New data to be inserted/updated.
+     *
+     * @return True if the insertion was successful; False if the key already existed.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool CombiningHashTbl<KeyType,DataType,KeyHash,KeyEqual>::insert( const KeyType & key_, const DataType & new_data_ )
+    {
+        auto op = [ & ]( table_type & table_ ){ return table_.insert( key_, new_data_ ); };
+        return run( op );
+    }
+
+    // Modifies the data associated with a key in place.
+    /*!
+     * fn_ runs on the combiner thread.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Function A function accepting a DataType &.
+     *
+     * @param key_ Key of the element to modify.
+     * @param fn_ The modification.
+     *
+     * @return True if the key was found (and fn_ called); False otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Function >
+    bool CombiningHashTbl<KeyType,DataType,KeyHash,KeyEqual>::update( const KeyType & key_, Function fn_ )
+    {
+        auto op = [ & ]( table_type & table_ ){ return table_.update( key_, fn_ ); };
+        return run( op );
+    }
+
+    // Modifies the data associated with a key, inserting it first if needed.
+    /*!
+     * See HashTbl::upsert(); the functions run on the combiner thread.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Make A function returning the DataType to insert.
+     * @tparam Update A function accepting a DataType &.
+     *
+     * @param key_ Key of the element.
+     * @param make_fn_ Makes the data of a new element.
+     * @param update_fn_ Modifies the data of an existing element.
+     *
+     * @return True if the element was inserted; False if it was updated.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Make, typename Update >
+    bool CombiningHashTbl<KeyType,DataType,KeyHash,KeyEqual>::upsert( const KeyType & key_, Make make_fn_, Update update_fn_ )
+    {
+        auto op = [ & ]( table_type & table_ ){ return table_.upsert( key_, make_fn_, update_fn_ ); };
+        return run( op );
+    }
+
+    // Computes the data of a key from its current data, if any.
+    /*!
+     * See HashTbl::compute(); fn_ runs on the combiner thread.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Function A function accepting a DataType & and a bool, returning whether the key stays.
+     *
+     * @param key_ Key of the element.
+     * @param fn_ The computation.
+     *
+     * @return True if the key is in the table afterwards; False otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Function >
+    bool CombiningHashTbl<KeyType,DataType,KeyHash,KeyEqual>::compute( const KeyType & key_, Function fn_ )
+    {
+        auto op = [ & ]( table_type & table_ ){ return table_.compute( key_, fn_ ); };
+        return run( op );
+    }
+
+    // Erase element from the hash table.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key of element to be removed.
+     *
+     * @return True if the key was found; False otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool CombiningHashTbl<KeyType,DataType,KeyHash,KeyEqual>::erase( const KeyType & key_ )
+    {
+        auto op = [ & ]( table_type & table_ ){ return table_.erase( key_ ); };
+        return run( op );
+    }
+
+    // Retrieves data from the table.
+    /*!
+     * Lookups go through the combiner as well, so they see every earlier write.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Data key to search for in the table.
+     * @param data_item_ Data record to be filled in when data item is found.
+     *
+     * @return True if the data item is found; False, otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool CombiningHashTbl<KeyType,DataType,KeyHash,KeyEqual>::retrieve( const KeyType & key_, DataType & data_item_ )
+    {
+        auto op = [ & ]( table_type & table_ ){ return table_.retrieve( key_, data_item_ ); };
+        return run( op );
+    }
+
+    // Counts the elements with a key.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ The key.
+     *
+     * @return 1 if the key is in the table; 0 otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename CombiningHashTbl<KeyType,DataType,KeyHash,KeyEqual>::size_type
+    CombiningHashTbl<KeyType,DataType,KeyHash,KeyEqual>::count( const KeyType & key_ )
+    {
+        auto op = [ & ]( table_type & table_ ){ return table_.find( key_ ) != nullptr; };
+        return run( op );
+    }
+
+    // Clears the data table.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void CombiningHashTbl<KeyType,DataType,KeyHash,KeyEqual>::clear( )
+    {
+        auto op = [ ]( table_type & table_ ){ table_.clear( ); return true; };
+        run( op );
+    }
+
+    // Runs a function alone on the underlying table.
+    /*!
+     * For anything the other methods do not offer (iterating, exporting, several
+     * changes that must happen together). fn_ runs on the combiner thread.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Function A function accepting a table_type & and returning bool.
+     *
+     * @param fn_ The function.
+     *
+     * @return What fn_ returned.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Function >
+    bool CombiningHashTbl<KeyType,DataType,KeyHash,KeyEqual>::execute( Function fn_ )
+    {
+        return run( fn_ );
+    }
+
+    // Number of slots used when none is given.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @return Two per hardware thread.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename CombiningHashTbl<KeyType,DataType,KeyHash,KeyEqual>::size_type
+    CombiningHashTbl<KeyType,DataType,KeyHash,KeyEqual>::default_slots( )
+    {
+        return 2 * std::max< size_type >( std::thread::hardware_concurrency( ), 1 );
+    }
+
+    // The slot a thread tries first.
+    /*!
+     * Threads are numbered as they first call it, so that up to slots() threads
+     * each have a slot of their own.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @return The number of the calling thread.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename CombiningHashTbl<KeyType,DataType,KeyHash,KeyEqual>::size_type
+    CombiningHashTbl<KeyType,DataType,KeyHash,KeyEqual>::home_slot( )
+    {
+        static std::atomic< size_type > next{ 0 };
+        thread_local const size_type mine = next.fetch_add( 1, std::memory_order_relaxed );
+        return mine;
+    }
+
+    // Publishes an operation and waits for it to be applied, combining if no one else is.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Function A function accepting a table_type & and returning bool.
+     *
+     * @param op_ The operation; it stays on this thread's stack until applied.
+     *
+     * @return What op_ returned (or what it threw is rethrown).
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Function >
+    bool CombiningHashTbl<KeyType,DataType,KeyHash,KeyEqual>::run( Function & op_ )
+    {
+        const size_type SPINS = 64; // Checks of the slot before yielding the processor.
+
+        // Claim a free slot, starting from this thread's own.
+        size_type i = home_slot( ) % m_n_slots;
+        for ( size_type tries = 1; ; ++tries, i = ( i + 1 ) % m_n_slots )
+        {
+            int expected = FREE;
+            if ( m_slots[ i ].m_state.load( std::memory_order_relaxed ) == FREE
+                 and m_slots[ i ].m_state.compare_exchange_strong( expected, WRITING, std::memory_order_acquire ) )
+                break;
+            if ( tries % m_n_slots == 0 )
+                std::this_thread::yield( );
+        }
+
+        Slot & slot = m_slots[ i ];
+        slot.m_op = &op_;
+        slot.m_call = [ ]( void * what_, table_type & table_ ) -> bool { return ( *static_cast< Function * >( what_ ) )( table_ ); };
+        slot.m_error = nullptr;
+        slot.m_state.store( PENDING, std::memory_order_release );
+
+        for ( size_type spins = 0; slot.m_state.load( std::memory_order_acquire ) != DONE; ++spins )
+        {
+            if ( not m_combining.load( std::memory_order_relaxed )
+                 and not m_combining.exchange( true, std::memory_order_acquire ) )
+            {
+                combine( );
+                m_combining.store( false, std::memory_order_release );
+            }
+            else if ( spins >= SPINS )
+                std::this_thread::yield( );
+        }
+
+        const bool result = slot.m_result;
+        auto error = std::move( slot.m_error );
+        slot.m_state.store( FREE, std::memory_order_release );
+        if ( error )
+            std::rethrow_exception( error );
+        return result;
+    }
+
+    // Applies the pending operations.
+    /*!
+     * Called with the combiner flag held. Scans the slots a few times, so that
+     * operations published meanwhile join the batch.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void CombiningHashTbl<KeyType,DataType,KeyHash,KeyEqual>::combine( )
+    {
+        const size_type PASSES = 3; // Scans of the slots per turn as combiner.
+
+        for ( size_type pass = 0; pass < PASSES; ++pass )
+        {
+            size_type applied = 0;
+            for ( size_type i = 0; i < m_n_slots; ++i )
+            {
+                Slot & slot = m_slots[ i ];
+                if ( slot.m_state.load( std::memory_order_acquire ) != PENDING )
+                    continue;
+
+                try
+                {
+                    slot.m_result = slot.m_call( slot.m_op, m_table );
+                }
+                catch ( ... )
+                {
+                    slot.m_error = std::current_exception( );
+                }
+                m_size.store( m_table.size( ), std::memory_order_release );
+                slot.m_state.store( DONE, std::memory_order_release );
+                ++applied;
+            }
+            if ( applied == 0 )
+                break;
+        }
+    }
+
+} // Namespace ac.
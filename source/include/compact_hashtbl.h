@@ -0,0 +1,141 @@
+/*!
+ * @file compact_hashtbl.h
+ * @brief Hash table storing its entries densely, in insertion order.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _COMPACT_HASHTBL_H_
+#define _COMPACT_HASHTBL_H_
+
+#include <algorithm>        // fill, clamp
+#include <cstdint>          // uint32_t
+#include <functional>       // hash, equal_to
+#include <iostream>         // ostream
+#include <iterator>         // forward_iterator_tag
+#include <optional>         // optional
+#include <stdexcept>        // out_of_range, length_error
+#include <utility>          // in_place, move
+#include <vector>           // vector
+
+#include "hash_entry.h"     // HashEntry
+#include "hash_mix.h"       // mix64
+
+namespace ac // Associative container
+{
+    /*!
+     * This class implements a hash table in two parts: the entries, stored one
+     * after the other in an array in the order they were inserted, and an index,
+     * an open-addressing array of 32-bit entry positions (linear probing).
+     *
+     * Iterating the table is a sequential scan of the entry array, always in
+     * insertion order, which no rehash changes. The hash of each key is kept with
+     * its entry, so growing the table rebuilds only the small index, without
+     * hashing or moving any entry. An erased entry leaves a hole, skipped by the
+     * iteration and squeezed out when the index is next rebuilt; insertions and
+     * erasures may therefore move the entries.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< class KeyType,
+		      class DataType,
+		      class KeyHash = std::hash< KeyType >,
+		      class KeyEqual = std::equal_to< KeyType > >
+	class CompactHashTbl {
+        public:
+            // Aliases
+            using entry_type = HashEntry<KeyType,DataType>;
+            using size_type = std::size_t;
+            using index_type = std::uint32_t;
+
+            /// Iterates over the entries in insertion order.
+            class const_iterator {
+                public:
+                    using iterator_category = std::forward_iterator_tag;
+                    using value_type = entry_type;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = const entry_type *;
+                    using reference = const entry_type &;
+
+                    const_iterator( ) = default;
+                    reference operator*( ) const { return **m_it; };
+                    pointer operator->( ) const { return &**m_it; };
+                    const_iterator & operator++( ) { ++m_it; skip( ); return *this; };
+                    const_iterator operator++( int ) { auto old = *this; ++*this; return old; };
+                    bool operator==( const const_iterator & other_ ) const { return m_it == other_.m_it; };
+                    bool operator!=( const const_iterator & other_ ) const { return m_it != other_.m_it; };
+
+                private:
+                    friend class CompactHashTbl;
+                    using base_type = typename std::vector< std::optional< entry_type > >::const_iterator;
+
+                    const_iterator( base_type it_, base_type end_ ) : m_it{ it_ }, m_end{ end_ } { skip( ); };
+                    void skip( ) { while ( m_it != m_end and not m_it->has_value( ) ) ++m_it; };
+
+                    base_type m_it;   //!< Current entry.
+                    base_type m_end;  //!< End of the entries.
+            };
+
+            /// Constructors
+            explicit CompactHashTbl( size_type table_sz_ = DEFAULT_SIZE );
+
+            /// Class methods
+            bool insert( const KeyType &, const DataType & );
+            bool retrieve( const KeyType &, DataType & ) const;
+            DataType* find( const KeyType & );
+            const DataType* find( const KeyType & ) const;
+            template< class Function >
+            bool update( const KeyType &, Function );
+            bool erase( const KeyType & );
+            void clear( );
+            bool empty( ) const { return m_count == 0; };
+            size_type size( ) const { return m_count; };
+            DataType& at( const KeyType & );
+            DataType& operator[]( const KeyType & );
+            size_type count( const KeyType & key_ ) const { return find( key_ ) != nullptr; };
+            float load_factor( ) const { return ( float ) m_count / m_index.size( ); };
+            float max_load_factor( ) const { return m_max_load_factor; };
+            /// Clamped to [0.125, 1]: probing stops at an EMPTY slot, so the index always keeps one.
+            void max_load_factor( float mlf ) { m_max_load_factor = std::clamp( mlf, 0.125f, 1.f ); };
+            size_type bucket_count( ) const { return m_index.size( ); };
+            size_type holes( ) const { return m_entries.size( ) - m_count; };
+            void reserve( size_type );
+            void shrink_to_fit( );
+            const_iterator begin( ) const { return { m_entries.cbegin( ), m_entries.cend( ) }; };
+            const_iterator end( ) const { return { m_entries.cend( ), m_entries.cend( ) }; };
+            template< class Function >
+            void for_each( Function ) const;
+
+            /// Friend functions
+            friend std::ostream & operator<<( std::ostream & os_, const CompactHashTbl & ht_ ) {
+                for ( const auto & en : ht_ )
+                    os_ << en << "\n";
+                return os_;
+            }
+
+        private:
+            /// Private methods
+            size_type locate( const KeyType &, std::size_t ) const;
+            size_type emplace( const KeyType &, std::size_t, const DataType & );
+            size_type size_for( size_type ) const;
+            void place( std::size_t, index_type );
+            void rebuild( size_type );
+
+        private:
+            std::vector< std::optional< entry_type > > m_entries; //!< The entries, in insertion order (erased ones empty).
+            std::vector< std::size_t > m_hashes;                  //!< Hash of each entry's key.
+            std::vector< index_type > m_index;                    //!< Position of an entry, EMPTY or ERASED; a power of two long.
+            size_type m_count = 0;                                //!< Number of elements in the table.
+            float m_max_load_factor = 2.f / 3;                    //!< Rebuild the index when its used slots exceed this fraction.
+            static constexpr index_type EMPTY = ~index_type{ 0 };
+            static constexpr index_type ERASED = EMPTY - 1;
+            static constexpr size_type NOT_FOUND = ~size_type{ 0 };
+            static const short DEFAULT_SIZE = 11;
+    };
+
+} // Namespace ac.
+#include "compact_hashtbl.inl"
+#endif
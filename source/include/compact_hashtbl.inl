@@ -0,0 +1,432 @@
+/*!
+ * @file compact_hashtbl.inl
+ * @brief Implementation of the CompactHashTbl class methods.
+ *
+ * @author Lucas Bazante
+ */
+
+#include "compact_hashtbl.h"
+
+namespace ac {
+
+    /// CONSTRUCTORS
+
+    // Regular constructor.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param table_sz_ Number of elements the table holds before its index is rebuilt.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+	CompactHashTbl<KeyType,DataType,KeyHash,KeyEqual>::CompactHashTbl( size_type table_sz_ )
+	{
+        m_index.assign( size_for( table_sz_ ), EMPTY );
+        m_entries.reserve( table_sz_ );
+        m_hashes.reserve( table_sz_ );
+	}
+
+    /// CLASS METHODS
+
+    // Inserts data into the hash table according to the associated key.
+    /*!
+     * Inserts the new entry, after the others, if the key does not exist and
+     * updates the data otherwise (the entry keeps its place).
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key associated with data.
+     * @param new_data_ New data to be inserted/updated.
+     *
+     * @return True if the insertion was successful; False if the key already existed.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool CompactHashTbl<KeyType,DataType,KeyHash,KeyEqual>::insert( const KeyType & key_, const DataType & new_data_ )
+    {
+        const auto h = KeyHash{ }( key_ );
+        const auto slot = locate( key_, h );
+        if ( slot != NOT_FOUND )
+        {
+            m_entries[ m_index[ slot ] ]->m_data = new_data_;
+            return false;
+        }
+
+        emplace( key_, h, new_data_ );
+        return true;
+    }
+
+    // Retrieves data from the table.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Data key to search for in the table.
+     * @param data_item_ Data record to be filled in when data item is found.
+     *
+     * @return True if the data item is found; False, otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool CompactHashTbl<KeyType,DataType,KeyHash,KeyEqual>::retrieve( const KeyType & key_, DataType & data_item_ ) const
+    {
+        auto data = find( key_ );
+        if ( data != nullptr )
+            data_item_ = *data;
+        return data != nullptr;
+    }
+
+    // Locates the data associated with a key.
+    /*!
+     * The pointer remains valid until the next insertion or erasure.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Data key to search for in the table.
+     *
+     * @return Pointer to the data associated with the key, or nullptr if the key is not in the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    const DataType* CompactHashTbl<KeyType,DataType,KeyHash,KeyEqual>::find( const KeyType & key_ ) const
+    {
+        const auto slot = locate( key_, KeyHash{ }( key_ ) );
+        return slot == NOT_FOUND ? nullptr : &m_entries[ m_index[ slot ] ]->m_data;
+    }
+
+    // Locates the data associated with a key.
+    /*!
+     * Non-const version of find().
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Data key to search for in the table.
+     *
+     * @return Pointer to the data associated with the key, or nullptr if the key is not in the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    DataType* CompactHashTbl<KeyType,DataType,KeyHash,KeyEqual>::find( const KeyType & key_ )
+    {
+        return const_cast< DataType * >( static_cast< const CompactHashTbl & >( *this ).find( key_ ) );
+    }
+
+    // Modifies the data associated with a key in place.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Function A function accepting a DataType &.
+     *
+     * @param key_ Key of the element to modify.
+     * @param fn_ The modification.
+     *
+     * @return True if the key was found (and fn_ called); False otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Function >
+    bool CompactHashTbl<KeyType,DataType,KeyHash,KeyEqual>::update( const KeyType & key_, Function fn_ )
+    {
+        auto data = find( key_ );
+        if ( data != nullptr )
+            fn_( *data );
+        return data != nullptr;
+    }
+
+    // Erase element from the hash table.
+    /*!
+     * The entry leaves a hole in the entry array; once the holes outnumber the
+     * elements, the entries are compacted (keeping their order) and the index rebuilt.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key of element to be removed.
+     *
+     * @return True if the key was found; False otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool CompactHashTbl<KeyType,DataType,KeyHash,KeyEqual>::erase( const KeyType & key_ )
+    {
+        const auto slot = locate( key_, KeyHash{ }( key_ ) );
+        if ( slot == NOT_FOUND )
+            return false;
+
+        m_entries[ m_index[ slot ] ].reset( );
+        m_index[ slot ] = ERASED;
+        --m_count;
+
+        if ( holes( ) > m_count + DEFAULT_SIZE )
+            rebuild( size_for( 2 * m_count ) );
+
+        return true;
+    }
+
+    // Clears the data table.
+    /*!
+     * The index keeps its size.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void CompactHashTbl<KeyType,DataType,KeyHash,KeyEqual>::clear( )
+    {
+        m_entries.clear( );
+        m_hashes.clear( );
+        std::fill( m_index.begin( ), m_index.end( ), EMPTY );
+        m_count = 0;
+    }
+
+    // Reference to the element at given position.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key to wanted element.
+     *
+     * @return Data associated with the key.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    DataType& CompactHashTbl<KeyType,DataType,KeyHash,KeyEqual>::at( const KeyType & key_ )
+    {
+        auto data = find( key_ );
+        if ( data != nullptr )
+            return *data;
+
+        throw std::out_of_range( "Not present" );
+    }
+
+    // Accesses the element associated with the key or inserts a new element.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key possibly associated with an element in the table.
+     *
+     * @return A reference to the data associated with the key.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    DataType& CompactHashTbl<KeyType,DataType,KeyHash,KeyEqual>::operator[]( const KeyType & key_ )
+    {
+        const auto h = KeyHash{ }( key_ );
+        const auto slot = locate( key_, h );
+        const auto pos = slot != NOT_FOUND ? m_index[ slot ] : emplace( key_, h, DataType{ } );
+        return m_entries[ pos ]->m_data;
+    }
+
+    // Prepares the table to hold a number of elements.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param n_ Number of elements expected in the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void CompactHashTbl<KeyType,DataType,KeyHash,KeyEqual>::reserve( size_type n_ )
+    {
+        m_entries.reserve( n_ );
+        m_hashes.reserve( n_ );
+        if ( size_for( n_ ) > m_index.size( ) )
+            rebuild( size_for( n_ ) );
+    }
+
+    // Squeezes out the holes and makes the index as small as the elements allow.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void CompactHashTbl<KeyType,DataType,KeyHash,KeyEqual>::shrink_to_fit( )
+    {
+        rebuild( size_for( m_count ) );
+        m_entries.shrink_to_fit( );
+        m_hashes.shrink_to_fit( );
+        m_index.shrink_to_fit( );
+    }
+
+    // Visits every element of the table, in insertion order.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Function A function accepting a key and a data item.
+     *
+     * @param fn_ The function to be called.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Function >
+    void CompactHashTbl<KeyType,DataType,KeyHash,KeyEqual>::for_each( Function fn_ ) const
+    {
+        for ( const auto & en : m_entries )
+            if ( en )
+                fn_( en->m_key, en->m_data );
+    }
+
+    // Finds the index slot of a key.
+    /*!
+     * Probes from the slot of the mixed hash until an empty slot; erased slots are
+     * passed over, and keys are compared only when the stored hashes are equal.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ The key.
+     * @param h_ Its hash.
+     *
+     * @return The slot of m_index holding the key's entry, or NOT_FOUND.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename CompactHashTbl<KeyType,DataType,KeyHash,KeyEqual>::size_type
+    CompactHashTbl<KeyType,DataType,KeyHash,KeyEqual>::locate( const KeyType & key_, std::size_t h_ ) const
+    {
+        KeyEqual eq;
+        const size_type mask = m_index.size( ) - 1;
+        for ( size_type i = mix64( h_ ) & mask; ; i = ( i + 1 ) & mask )
+        {
+            const auto pos = m_index[ i ];
+            if ( pos == EMPTY )
+                return NOT_FOUND;
+            if ( pos != ERASED and m_hashes[ pos ] == h_ and eq( m_entries[ pos ]->m_key, key_ ) )
+                return i;
+        }
+    }
+
+    // Appends a new entry, rebuilding the index first if it is full.
+    /*!
+     * The key must not be in the table.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ The key.
+     * @param h_ Its hash.
+     * @param data_ The data.
+     *
+     * @return The position of the new entry.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename CompactHashTbl<KeyType,DataType,KeyHash,KeyEqual>::size_type
+    CompactHashTbl<KeyType,DataType,KeyHash,KeyEqual>::emplace( const KeyType & key_, std::size_t h_, const DataType & data_ )
+    {
+        // Erased slots are not reused, so every entry, hole or not, occupies one index slot;
+        // at least one slot stays EMPTY to end the probes of missing keys.
+        if ( m_entries.size( ) + 1 >= m_max_load_factor * m_index.size( ) )
+            rebuild( size_for( 2 * ( m_count + 1 ) ) );
+        if ( m_entries.size( ) >= ERASED )
+            throw std::length_error( "CompactHashTbl is limited to 2^32 - 2 entries" );
+
+        const auto pos = static_cast< index_type >( m_entries.size( ) );
+        m_entries.emplace_back( std::in_place, key_, data_ );
+        m_hashes.push_back( h_ );
+        place( h_, pos );
+        ++m_count;
+        return pos;
+    }
+
+    // Computes the index size for a number of entries.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param n_ Number of entries.
+     *
+     * @return The smallest power of two, at least 8, that holds n_ entries below the maximum load factor.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename CompactHashTbl<KeyType,DataType,KeyHash,KeyEqual>::size_type
+    CompactHashTbl<KeyType,DataType,KeyHash,KeyEqual>::size_for( size_type n_ ) const
+    {
+        size_type size = 8;
+        while ( n_ >= m_max_load_factor * size )
+            size *= 2;
+        return size;
+    }
+
+    // Puts an entry position in the first empty slot of its probe sequence.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param h_ Hash of the entry's key.
+     * @param pos_ Position of the entry.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void CompactHashTbl<KeyType,DataType,KeyHash,KeyEqual>::place( std::size_t h_, index_type pos_ )
+    {
+        const size_type mask = m_index.size( ) - 1;
+        size_type i = mix64( h_ ) & mask;
+        while ( m_index[ i ] != EMPTY )
+            i = ( i + 1 ) & mask;
+        m_index[ i ] = pos_;
+    }
+
+    // Compacts the entries and rebuilds the index with the given size.
+    /*!
+     * Entries keep their relative order; the stored hashes spare hashing the keys.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param new_size_ The new index size (a power of two that holds the elements).
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void CompactHashTbl<KeyType,DataType,KeyHash,KeyEqual>::rebuild( size_type new_size_ )
+    {
+        if ( holes( ) != 0 )
+        {
+            size_type to = 0;
+            for ( size_type from = 0; from < m_entries.size( ); ++from )
+            {
+                if ( not m_entries[ from ] )
+                    continue;
+                if ( to != from )
+                {
+                    m_entries[ to ] = std::move( m_entries[ from ] );
+                    m_hashes[ to ] = m_hashes[ from ];
+                }
+                ++to;
+            }
+            m_entries.resize( to );
+            m_hashes.resize( to );
+        }
+
+        m_index.assign( new_size_, EMPTY );
+        for ( size_type pos = 0; pos < m_entries.size( ); ++pos )
+            place( m_hashes[ pos ], static_cast< index_type >( pos ) );
+    }
+
+} // Namespace ac.
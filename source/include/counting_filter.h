@@ -0,0 +1,101 @@
+/*!
+ * @file counting_filter.h
+ * @brief Blocked counting Bloom filter for fast negative lookups.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _COUNTING_FILTER_H_
+#define _COUNTING_FILTER_H_
+
+#include <algorithm>        // max, fill
+#include <cstdint>          // uint64_t
+#include <vector>           // vector
+
+#include "hash_mix.h"       // mix64
+
+namespace ac // Associative container
+{
+    /*!
+     * This class implements a counting Bloom filter over 64-bit hash values.
+     *
+     * Counters are 4 bits wide and grouped in 64-byte blocks; all the counters of
+     * a key live in the same block, so a query reads a single cache line. Keys can
+     * be removed as well as added. A counter that reaches its maximum sticks there
+     * (removals no longer decrement it), which can only cause false positives.
+     *
+     * The filter answers "definitely absent" or "maybe present".
+     */
+    class CountingFilter {
+        public:
+            // Aliases
+            using size_type = std::size_t;
+
+            /// Constructors
+            explicit CountingFilter( size_type n_keys_ = 0 ) { reset( n_keys_ ); }
+
+            /// Class methods
+
+            /// Empties the filter and sizes it for the given number of keys.
+            void reset( size_type n_keys_ )
+            {
+                const size_type n_counters = std::max< size_type >( 1, n_keys_ ) * COUNTERS_PER_KEY;
+                m_blocks.assign( ( n_counters + COUNTERS_PER_BLOCK - 1 ) / COUNTERS_PER_BLOCK, Block{ } );
+            }
+            /// Removes every key.
+            void clear( ) { std::fill( std::begin( m_blocks ), std::end( m_blocks ), Block{ } ); }
+            /// Adds a key, given its hash value.
+            void add( std::uint64_t hash_ ) { update( hash_, +1 ); }
+            /// Removes a key that was added, given its hash value.
+            void remove( std::uint64_t hash_ ) { update( hash_, -1 ); }
+            /// Tests whether a key may have been added, given its hash value.
+            bool may_contain( std::uint64_t hash_ ) const
+            {
+                const std::uint64_t h = mix64( hash_ );
+                const Block & block = m_blocks[ block_of( h ) ];
+                for ( unsigned k = 0; k < PROBES; ++k )
+                {
+                    const unsigned c = counter_of( h, k );
+                    if ( ( ( block.m_words[ c / 16 ] >> ( 4 * ( c % 16 ) ) ) & 0xf ) == 0 )
+                        return false;
+                }
+                return true;
+            }
+
+        private:
+            /// One cache line of 128 counters.
+            struct alignas( 64 ) Block {
+                std::uint64_t m_words[ 8 ] = { };
+            };
+
+            static constexpr unsigned PROBES = 4;               //!< Counters per key.
+            static constexpr size_type COUNTERS_PER_KEY = 8;    //!< Sizing ratio (about 2% false positives).
+            static constexpr size_type COUNTERS_PER_BLOCK = 128; //!< 4-bit counters in a block.
+
+            size_type block_of( std::uint64_t h_ ) const { return ( h_ >> 32 ) % m_blocks.size(); }
+            static unsigned counter_of( std::uint64_t h_, unsigned k_ ) { return ( h_ >> ( 7 * k_ ) ) & 127; }
+
+            void update( std::uint64_t hash_, int delta_ )
+            {
+                const std::uint64_t h = mix64( hash_ );
+                Block & block = m_blocks[ block_of( h ) ];
+                for ( unsigned k = 0; k < PROBES; ++k )
+                {
+                    const unsigned c = counter_of( h, k );
+                    std::uint64_t & word = block.m_words[ c / 16 ];
+                    const unsigned shift = 4 * ( c % 16 );
+                    const std::uint64_t value = ( word >> shift ) & 0xf;
+
+                    // Saturated counters stick; empty ones cannot be decremented.
+                    if ( value == 0xf or ( delta_ < 0 and value == 0 ) )
+                        continue;
+                    word = delta_ > 0 ? word + ( std::uint64_t{ 1 } << shift ) : word - ( std::uint64_t{ 1 } << shift );
+                }
+            }
+
+        private:
+            std::vector< Block > m_blocks; //!< The counters.
+    };
+
+} // Namespace ac.
+#endif
@@ -0,0 +1,130 @@
+/*!
+ * @file cow_hashtbl.h
+ * @brief Hash table with copy-on-write snapshots.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _COW_HASHTBL_H_
+#define _COW_HASHTBL_H_
+
+#include <algorithm>        // find_if, count_if
+#include <atomic>           // atomic_thread_fence
+#include <forward_list>     // forward_list
+#include <functional>       // hash, equal_to
+#include <iostream>         // ostream
+#include <iterator>         // next
+#include <memory>           // shared_ptr
+#include <vector>           // vector
+
+#include "hash_entry.h"     // HashEntry
+#include "hash_primes.h"    // next_prime
+
+namespace ac // Associative container
+{
+    /*!
+     * This class implements a hash table whose state can be captured in O(1) by
+     * snapshot(), e.g. for consistent reporting over a live table.
+     *
+     * The buckets are grouped in fixed-size chunks, held by reference-counted
+     * pointers in a directory, itself reference counted. A snapshot shares the
+     * directory; the first write afterwards copies the directory (one pointer per
+     * chunk), and a write to a chunk that is still shared copies that chunk only.
+     * Memory thus grows with the chunks written while snapshots live. Copies of
+     * the table share their chunks in the same way.
+     *
+     * A snapshot may be read (and released) by another thread while the table
+     * keeps changing; the table itself is not thread-safe.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< class KeyType,
+		      class DataType,
+		      class KeyHash = std::hash< KeyType >,
+		      class KeyEqual = std::equal_to< KeyType > >
+	class CowHashTbl {
+        public:
+            // Aliases
+            using entry_type = HashEntry<KeyType,DataType>;
+            using list_type = std::forward_list< entry_type >;
+            using size_type = std::size_t;
+
+            static constexpr size_type CHUNK_BUCKETS = 64; //!< Buckets copied together.
+
+        private:
+            /// A group of consecutive buckets.
+            struct Chunk {
+                list_type m_buckets[ CHUNK_BUCKETS ];
+            };
+            using Directory = std::vector< std::shared_ptr< Chunk > >;
+
+        public:
+            /// A read-only view of the table at the time it was taken.
+            class Snapshot {
+                public:
+                    const DataType* find( const KeyType & ) const;
+                    bool retrieve( const KeyType &, DataType & ) const;
+                    size_type size() const { return m_count; };
+                    bool empty() const { return m_count == 0; };
+                    template< class Function >
+                    void for_each( Function ) const;
+
+                private:
+                    friend class CowHashTbl;
+                    Snapshot( std::shared_ptr< const Directory > dir_, size_type size_, size_type count_ )
+                        : m_dir{ std::move( dir_ ) }, m_size{ size_ }, m_count{ count_ }
+                    {/*Empty*/}
+
+                    std::shared_ptr< const Directory > m_dir; //!< The shared chunks.
+                    size_type m_size;  //!< Number of buckets.
+                    size_type m_count; //!< Number of elements.
+            };
+
+            /// Constructors
+            explicit CowHashTbl( size_type table_sz_ = DEFAULT_SIZE );
+
+            /// Class methods
+            bool insert( const KeyType &, const DataType & );
+            bool retrieve( const KeyType &, DataType & ) const;
+            const DataType* find( const KeyType & ) const;
+            bool erase( const KeyType & );
+            void clear();
+            bool empty() const { return m_count == 0; };
+            size_type size() const { return m_count; };
+            size_type bucket_count() const { return m_size; };
+            float load_factor() const { return ( float ) m_count / m_size; };
+            float max_load_factor() const { return m_max_load_factor; };
+            void max_load_factor( float mlf ) { m_max_load_factor = mlf; };
+            Snapshot snapshot() const;
+            size_type shared_chunks() const;
+            template< class Function >
+            void for_each( Function ) const;
+
+            /// Friend functions
+            friend std::ostream & operator<<( std::ostream & os_, const CowHashTbl & ht_ ) {
+                ht_.for_each( [ & ]( const KeyType &, const DataType & data_ ){ os_ << data_ << "\n"; } );
+                return os_;
+            }
+
+        private:
+            /// Private methods
+            static const list_type & bucket_in( const Directory &, size_type );
+            static const DataType* find_in( const Directory &, size_type, const KeyType & );
+            static std::shared_ptr< Directory > allocate( size_type );
+            list_type & writable( size_type );
+            void rehash( size_type );
+
+        private:
+            std::shared_ptr< Directory > m_dir; //!< Chunks of buckets.
+            size_type m_size;                   //!< Number of buckets.
+            size_type m_count;                  //!< Number of elements.
+            float m_max_load_factor = 1.0f;     //!< Grow when the load factor exceeds this.
+            static const short DEFAULT_SIZE = 11;
+    };
+
+} // Namespace ac.
+#include "cow_hashtbl.inl"
+#endif
@@ -0,0 +1,419 @@
+/*!
+ * @file cow_hashtbl.inl
+ * @brief Implementation of the CowHashTbl class methods.
+ *
+ * @author Lucas Bazante
+ */
+
+#include "cow_hashtbl.h"
+
+namespace ac {
+
+    /// CONSTRUCTORS
+
+    // Size constructor.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param table_sz_ The minimun number of buckets.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+	CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::CowHashTbl( size_type table_sz_ )
+	{
+        m_size = detail::next_prime( table_sz_ );
+        m_count = 0;
+        m_dir = allocate( m_size );
+	}
+
+    /// CLASS METHODS
+
+    // Inserts data into the hash table according to the associated key.
+    /*!
+     * Inserts the new entry if the key does not exist and updates the data otherwise.
+     * Only the chunk of the key's bucket is copied, if a snapshot shares it.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key associated with data.
+     * @param new_data_ New data to be inserted/updated.
+     *
+     * @return True if the insertion was successful; False if the key already existed.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::insert( const KeyType & key_, const DataType & new_data_ )
+    {
+        KeyHash hashf;
+        KeyEqual eq;
+        auto & which = writable( hashf( key_ ) % m_size );
+
+        auto item = std::find_if( std::begin( which ), std::end( which ), [ & ]( const entry_type & en ){ return eq( en.m_key, key_ ); } );
+        if ( item != std::end( which ) )
+        {
+            item->m_data = new_data_;
+            return false;
+        }
+
+        which.emplace_front( key_, new_data_ );
+        if ( ++m_count > m_max_load_factor * m_size )
+            rehash( detail::next_prime( 2 * m_size ) );
+
+        return true;
+    }
+
+    // Retrieves data from the table.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Data key to search for in the table.
+     * @param data_item_ Data record to be filled in when data item is found.
+     *
+     * @return True if the data item is found; False, otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::retrieve( const KeyType & key_, DataType & data_item_ ) const
+    {
+        auto data = find( key_ );
+        if ( data != nullptr )
+            data_item_ = *data;
+        return data != nullptr;
+    }
+
+    // Locates the data associated with a key.
+    /*!
+     * The pointer is only valid until the next change to the table.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Data key to search for in the table.
+     *
+     * @return Pointer to the data associated with the key, or nullptr if the key is not in the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    const DataType* CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::find( const KeyType & key_ ) const
+    {
+        return find_in( *m_dir, m_size, key_ );
+    }
+
+    // Erase element from the hash table.
+    /*!
+     * The chunk of the key's bucket is copied only if the key is there.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key of element to be removed.
+     *
+     * @return True if the key was found; False otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::erase( const KeyType & key_ )
+    {
+        if ( find( key_ ) == nullptr )
+            return false;
+
+        KeyHash hashf;
+        KeyEqual eq;
+        auto & which = writable( hashf( key_ ) % m_size );
+
+        auto prev = which.before_begin();
+        while ( not eq( std::next( prev )->m_key, key_ ) )
+            ++prev;
+        which.erase_after( prev );
+        --m_count;
+
+        return true;
+    }
+
+    // Clears the data table.
+    /*!
+     * Snapshots keep their data; the table gets new, empty chunks.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::clear()
+    {
+        m_dir = allocate( m_size );
+        m_count = 0;
+    }
+
+    // Takes a snapshot of the table.
+    /*!
+     * Costs a reference count increment: nothing is copied until the table changes.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @return A read-only view of the current contents.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::Snapshot
+    CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::snapshot() const
+    {
+        return Snapshot( m_dir, m_size, m_count );
+    }
+
+    // Counts the chunks shared with snapshots.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @return Number of chunks that a write would have to copy.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::size_type
+    CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::shared_chunks() const
+    {
+        if ( m_dir.use_count() != 1 )
+            return m_dir->size();
+        return std::count_if( std::begin( *m_dir ), std::end( *m_dir ), []( const std::shared_ptr< Chunk > & c_ ){ return c_.use_count() != 1; } );
+    }
+
+    // Visits every element of the table.
+    /*!
+     * Calls fn_( key, data ) for each element, bucket by bucket.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Function A function accepting a key and a data item.
+     *
+     * @param fn_ The function to be called.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Function >
+    void CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::for_each( Function fn_ ) const
+    {
+        snapshot().for_each( fn_ );
+    }
+
+    // Bucket of a directory.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param dir_ The directory.
+     * @param n_ Index of the bucket.
+     *
+     * @return The bucket.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    const typename CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::list_type &
+    CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::bucket_in( const Directory & dir_, size_type n_ )
+    {
+        return dir_[ n_ / CHUNK_BUCKETS ]->m_buckets[ n_ % CHUNK_BUCKETS ];
+    }
+
+    // Locates the data associated with a key in a directory.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param dir_ The directory.
+     * @param size_ Number of buckets.
+     * @param key_ Data key to search for.
+     *
+     * @return Pointer to the data associated with the key, or nullptr if the key is not there.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    const DataType* CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::find_in( const Directory & dir_, size_type size_, const KeyType & key_ )
+    {
+        KeyHash hashf;
+        KeyEqual eq;
+        const auto & which = bucket_in( dir_, hashf( key_ ) % size_ );
+
+        auto item = std::find_if( std::begin( which ), std::end( which ), [ & ]( const entry_type & en ){ return eq( en.m_key, key_ ); } );
+        return item == std::end( which ) ? nullptr : &item->m_data;
+    }
+
+    // Allocates a directory of empty chunks.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param n_ Number of buckets.
+     *
+     * @return The directory.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    std::shared_ptr< typename CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::Directory >
+    CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::allocate( size_type n_ )
+    {
+        auto dir = std::make_shared< Directory >( ( n_ + CHUNK_BUCKETS - 1 ) / CHUNK_BUCKETS );
+        for ( auto & chunk : *dir )
+            chunk = std::make_shared< Chunk >( );
+        return dir;
+    }
+
+    // Gives write access to a bucket.
+    /*!
+     * Copies the directory, then the bucket's chunk, if they are shared with a snapshot.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param n_ Index of the bucket.
+     *
+     * @return The bucket, owned by this table only.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::list_type &
+    CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::writable( size_type n_ )
+    {
+        if ( m_dir.use_count() != 1 )
+            m_dir = std::make_shared< Directory >( *m_dir );
+
+        auto & chunk = ( *m_dir )[ n_ / CHUNK_BUCKETS ];
+        if ( chunk.use_count() != 1 )
+            chunk = std::make_shared< Chunk >( *chunk );
+
+        // A snapshot released by another thread must be done reading before we write.
+        std::atomic_thread_fence( std::memory_order_acquire );
+        return chunk->m_buckets[ n_ % CHUNK_BUCKETS ];
+    }
+
+    // Redistributes the elements into a bucket array of the given size.
+    /*!
+     * Nodes of chunks owned by this table only are relinked; the others are copied,
+     * so that the snapshots sharing them are left intact.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param new_size_ The new number of buckets.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::rehash( size_type new_size_ )
+    {
+        KeyHash hashf;
+        auto dir = allocate( new_size_ );
+        auto to = [ & ]( const KeyType & key_ ) -> list_type & {
+            auto n = hashf( key_ ) % new_size_;
+            return ( *dir )[ n / CHUNK_BUCKETS ]->m_buckets[ n % CHUNK_BUCKETS ];
+        };
+
+        const bool own_dir = m_dir.use_count() == 1;
+        for ( auto & chunk : *m_dir )
+        {
+            const bool own = own_dir and chunk.use_count() == 1;
+            for ( auto & from : chunk->m_buckets )
+            {
+                if ( own )
+                {
+                    while ( not from.empty() )
+                    {
+                        auto & which = to( from.front().m_key );
+                        which.splice_after( which.before_begin(), from, from.before_begin() );
+                    }
+                }
+                else
+                {
+                    for ( const auto & en : from )
+                        to( en.m_key ).push_front( en );
+                }
+            }
+        }
+
+        // Inserting at the front reversed the lists; restore the original relative order.
+        for ( auto & chunk : *dir )
+            for ( auto & which : chunk->m_buckets )
+                which.reverse();
+
+        m_dir = std::move( dir );
+        m_size = new_size_;
+    }
+
+    /// SNAPSHOT METHODS
+
+    // Locates the data associated with a key in the snapshot.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Data key to search for.
+     *
+     * @return Pointer to the data associated with the key, or nullptr if the key was not in the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    const DataType* CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::Snapshot::find( const KeyType & key_ ) const
+    {
+        return find_in( *m_dir, m_size, key_ );
+    }
+
+    // Retrieves data from the snapshot.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Data key to search for.
+     * @param data_item_ Data record to be filled in when data item is found.
+     *
+     * @return True if the data item is found; False, otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::Snapshot::retrieve( const KeyType & key_, DataType & data_item_ ) const
+    {
+        auto data = find( key_ );
+        if ( data != nullptr )
+            data_item_ = *data;
+        return data != nullptr;
+    }
+
+    // Visits every element of the snapshot.
+    /*!
+     * Calls fn_( key, data ) for each element, bucket by bucket.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Function A function accepting a key and a data item.
+     *
+     * @param fn_ The function to be called.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Function >
+    void CowHashTbl<KeyType,DataType,KeyHash,KeyEqual>::Snapshot::for_each( Function fn_ ) const
+    {
+        for ( size_type i = 0; i < m_size; ++i )
+            for ( const auto & en : bucket_in( *m_dir, i ) )
+                fn_( en.m_key, en.m_data );
+    }
+
+} // Namespace ac.
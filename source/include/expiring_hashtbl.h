@@ -0,0 +1,82 @@
+/*!
+ * @file expiring_hashtbl.h
+ * @brief Hash table whose entries may expire, driven by a timer wheel.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _EXPIRING_HASHTBL_H_
+#define _EXPIRING_HASHTBL_H_
+
+#include <chrono>           // steady_clock
+#include <cstdint>          // uint64_t
+#include <functional>       // function, hash, equal_to
+#include <limits>           // numeric_limits
+
+#include "hashtbl.h"        // HashTbl
+#include "timer_wheel.h"    // TimerWheel
+
+namespace ac // Associative container
+{
+    /*!
+     * This class implements a hash table in which each entry may have a time to live.
+     *
+     * Expired entries are removed in two ways: lazily, when a lookup finds one,
+     * and actively, by expire(), which advances a hierarchical timer wheel and
+     * removes at most a given number of expired entries per call. The work done
+     * is proportional to the number of expired entries (plus the ticks elapsed),
+     * never to the size of the table.
+     *
+     * Time is read from a clock returning ticks; by default, milliseconds of the
+     * steady clock.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< class KeyType,
+		      class DataType,
+		      class KeyHash = std::hash< KeyType >,
+		      class KeyEqual = std::equal_to< KeyType > >
+	class ExpiringHashTbl {
+        public:
+            // Aliases
+            using size_type = std::size_t;
+            using clock_type = std::function< std::uint64_t() >;
+
+            /// Time to live of entries that never expire.
+            static constexpr std::uint64_t NO_EXPIRY = 0;
+
+            /// Constructors
+            explicit ExpiringHashTbl( clock_type clock_ = nullptr, size_type table_sz_ = 11 );
+            ExpiringHashTbl( const ExpiringHashTbl & ) = delete;
+            ExpiringHashTbl & operator=( const ExpiringHashTbl & ) = delete;
+
+            /// Class methods
+            bool insert( const KeyType &, const DataType &, std::uint64_t ttl_ = NO_EXPIRY );
+            bool retrieve( const KeyType &, DataType & );
+            bool erase( const KeyType & );
+            size_type expire( size_type max_entries_ = std::numeric_limits< size_type >::max() );
+            void clear();
+            bool empty() const { return m_table.empty(); };
+            size_type size() const { return m_table.size(); };
+
+        private:
+            using wheel_type = TimerWheel< KeyType >;
+
+            /// What the underlying table stores for each key.
+            struct Record {
+                DataType m_data;                   //!< The data.
+                typename wheel_type::Node m_timer; //!< Expiry timer; unscheduled if the entry never expires.
+            };
+
+        private:
+            clock_type m_clock;                                     //!< Source of the current tick.
+            wheel_type m_wheel;                                     //!< Expiry timers (must outlive m_table).
+            HashTbl< KeyType, Record, KeyHash, KeyEqual > m_table;  //!< The entries.
+    };
+
+} // Namespace ac.
+#include "expiring_hashtbl.inl"
+#endif
@@ -0,0 +1,177 @@
+/*!
+ * @file expiring_hashtbl.inl
+ * @brief Implementation of the ExpiringHashTbl class methods.
+ *
+ * @author Lucas Bazante
+ */
+
+#include "expiring_hashtbl.h"
+
+namespace ac {
+
+    /// CONSTRUCTORS
+
+    // Clock constructor.
+    /*!
+     * This constructor creates an empty table.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param clock_ Function returning the current tick; steady clock milliseconds if not provided.
+     * @param table_sz_ The minimum size of the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+	ExpiringHashTbl<KeyType,DataType,KeyHash,KeyEqual>::ExpiringHashTbl( clock_type clock_, size_type table_sz_ )
+        : m_clock( clock_ ? clock_ : [ ]( ){
+                return static_cast< std::uint64_t >( std::chrono::duration_cast< std::chrono::milliseconds >(
+                    std::chrono::steady_clock::now( ).time_since_epoch( ) ).count( ) ); } )
+        , m_wheel( m_clock( ) )
+        , m_table( table_sz_ )
+	{/*Empty*/}
+
+    /// CLASS METHODS
+
+    // Inserts data into the table according to the associated key.
+    /*!
+     * Inserts the new entry if the key does not exist and updates the data otherwise.
+     * The time to live replaces that of an existing entry.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key associated with data.
+     * @param new_data_ New data to be inserted/updated.
+     * @param ttl_ Number of ticks until the entry expires, or NO_EXPIRY.
+     *
+     * @return True if the insertion was successful; False if the key already existed.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool ExpiringHashTbl<KeyType,DataType,KeyHash,KeyEqual>::insert( const KeyType & key_, const DataType & new_data_, std::uint64_t ttl_ )
+    {
+        const std::uint64_t now = m_clock( );
+        auto before = m_table.size( );
+        auto & record = m_table[ key_ ];
+        bool fresh = m_table.size( ) != before;
+
+        // An expired entry that was not removed yet counts as absent.
+        if ( not fresh and record.m_timer.linked( ) and record.m_timer.m_expiry <= now )
+            fresh = true;
+
+        record.m_data = new_data_;
+        if ( ttl_ == NO_EXPIRY )
+            record.m_timer.unlink( );
+        else
+        {
+            record.m_timer.m_key = key_;
+            record.m_timer.m_expiry = now + ttl_;
+            m_wheel.schedule( record.m_timer );
+        }
+
+        return fresh;
+    }
+
+    // Retrieves data from the table.
+    /*!
+     * Retrieves a data item from the table; an expired entry is removed on the spot.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Data key to search for in the table.
+     * @param data_item_ Data record to be filled in when data item is found.
+     *
+     * @return True if the data item is found and alive; False, otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool ExpiringHashTbl<KeyType,DataType,KeyHash,KeyEqual>::retrieve( const KeyType & key_, DataType & data_item_ )
+    {
+        auto record = m_table.find( key_ );
+        if ( record == nullptr )
+            return false;
+
+        if ( record->m_timer.linked( ) and record->m_timer.m_expiry <= m_clock( ) )
+        {
+            m_table.erase( key_ );
+            return false;
+        }
+
+        data_item_ = record->m_data;
+        return true;
+    }
+
+    // Erase element from the table.
+    /*!
+     * Its timer, if any, is cancelled.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key of element to be removed.
+     *
+     * @return True if the key was found; False otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool ExpiringHashTbl<KeyType,DataType,KeyHash,KeyEqual>::erase( const KeyType & key_ )
+    {
+        return m_table.erase( key_ );
+    }
+
+    // Removes expired entries.
+    /*!
+     * Advances the timer wheel to the current tick and removes up to max_entries_
+     * expired entries. Entries left over stay due and are removed by the next calls
+     * (or by lookups).
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param max_entries_ Maximum number of entries to remove.
+     *
+     * @return Number of entries removed.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename ExpiringHashTbl<KeyType,DataType,KeyHash,KeyEqual>::size_type
+    ExpiringHashTbl<KeyType,DataType,KeyHash,KeyEqual>::expire( size_type max_entries_ )
+    {
+        m_wheel.advance( m_clock( ) );
+
+        size_type removed = 0;
+        while ( removed < max_entries_ )
+        {
+            auto timer = m_wheel.pop_due( );
+            if ( timer == nullptr )
+                break;
+
+            KeyType key = timer->m_key; // The timer dies with the entry.
+            m_table.erase( key );
+            ++removed;
+        }
+
+        return removed;
+    }
+
+    // Clears the table.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void ExpiringHashTbl<KeyType,DataType,KeyHash,KeyEqual>::clear()
+    {
+        m_table.clear( );
+    }
+
+} // Namespace ac.
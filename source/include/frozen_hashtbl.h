@@ -0,0 +1,161 @@
+/*!
+ * @file frozen_hashtbl.h
+ * @brief Immutable hash table whose layout is computed at compile time.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _FROZEN_HASHTBL_H_
+#define _FROZEN_HASHTBL_H_
+
+#include <array>            // array
+#include <cstdint>          // uint64_t, int64_t
+#include <functional>       // equal_to
+#include <iostream>         // ostream
+#include <stdexcept>        // out_of_range, invalid_argument
+#include <string_view>      // string_view
+#include <type_traits>      // enable_if, is_integral, is_enum
+#include <utility>          // index_sequence
+
+#include "hash_entry.h"     // HashEntry
+#include "hash_mix.h"       // mix64
+
+namespace ac // Associative container
+{
+    /*!
+     * Seeded hash function usable in constant expressions.
+     * Only integral, enumeration and string_view keys are supported out of the box;
+     * clients may provide their own functor with the same signature.
+     *
+     * @tparam KeyType The key type.
+     */
+    template< class KeyType, class Enable = void >
+    struct FrozenHash;
+
+    /// Seeded hash of integral and enumeration keys.
+    template< class KeyType >
+    struct FrozenHash< KeyType, typename std::enable_if< std::is_integral< KeyType >::value or
+                                                         std::is_enum< KeyType >::value >::type >
+    {
+        constexpr std::uint64_t operator()( const KeyType & key_, std::uint64_t seed_ ) const
+        {
+            return mix64( static_cast< std::uint64_t >( key_ ), seed_ );
+        }
+    };
+
+    /// Seeded hash of string keys (FNV-1a followed by a mix).
+    template<>
+    struct FrozenHash< std::string_view >
+    {
+        constexpr std::uint64_t operator()( std::string_view key_, std::uint64_t seed_ ) const
+        {
+            std::uint64_t h = 0xcbf29ce484222325ULL;
+            for ( char c : key_ )
+            {
+                h ^= static_cast< unsigned char >( c );
+                h *= 0x100000001b3ULL;
+            }
+            return mix64( h, seed_ );
+        }
+    };
+
+    namespace detail
+    {
+        /// Smallest power of two not less than n_.
+        constexpr std::size_t next_pow2( std::size_t n_ )
+        {
+            std::size_t p = 1;
+            while ( p < n_ )
+                p <<= 1;
+            return p;
+        }
+    }
+
+    /*!
+     * This class implements an immutable hash table built from literal entries.
+     *
+     * The layout is a perfect hash computed by hash-and-displace: keys are split
+     * into buckets by a first hash, and each bucket gets the seed of a second hash
+     * that sends all of its keys to free slots. Buckets with a single key store
+     * their slot directly. A lookup is therefore two hash computations, one seed
+     * read, one slot read and one key comparison, with no loops over a chain.
+     *
+     * When declared `constexpr` the whole table lives in read-only data: there is
+     * no heap allocation and no work to be done at startup.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam N The number of entries.
+     * @tparam KeyHash A constexpr function that reads a key and a seed and returns an unsigned integer.
+     * @tparam KeyEqual  A constexpr function that compares two keys.
+     */
+	template< class KeyType,
+		      class DataType,
+		      std::size_t N,
+		      class KeyHash = FrozenHash< KeyType >,
+		      class KeyEqual = std::equal_to< KeyType > >
+	class FrozenHashTbl {
+        static_assert( N > 0, "A frozen hash table must have at least one entry." );
+
+        public:
+            // Aliases
+            using entry_type = HashEntry<KeyType,DataType>;
+            using size_type = std::size_t;
+            using const_iterator = const entry_type *;
+
+            /// Constructors
+            constexpr explicit FrozenHashTbl( const entry_type (&)[N] );
+
+            /// Class methods
+            constexpr bool retrieve( const KeyType &, DataType & ) const;
+            constexpr const DataType& at( const KeyType& ) const;
+            constexpr size_type count( const KeyType& ) const;
+            constexpr bool empty() const { return false; };
+            constexpr size_type size() const { return N; };
+            constexpr const_iterator begin() const { return m_entries.data(); };
+            constexpr const_iterator end() const { return m_entries.data() + N; };
+
+            /// Friend functions
+            friend std::ostream & operator<<( std::ostream & os_, const FrozenHashTbl & ht_ ) {
+                for ( const auto & en : ht_ )
+                    os_ << en << "\n";
+                return os_;
+            }
+
+        private:
+            /// Private methods
+            template< std::size_t... Is >
+            constexpr FrozenHashTbl( const entry_type (&)[N], std::index_sequence< Is... > );
+            constexpr void build( void );
+            constexpr size_type locate( const KeyType & ) const;
+
+        private:
+            static constexpr size_type BUCKET_COUNT = N;                   //!< Number of first-level buckets.
+            static constexpr size_type SLOT_COUNT = detail::next_pow2( N ); //!< Number of slots (a power of two).
+
+            std::array< entry_type, N > m_entries;         //!< Entries, in the order provided.
+            std::array< std::int64_t, BUCKET_COUNT > m_seeds; //!< Per bucket: seed if positive, -(slot+1) if negative.
+            std::array< size_type, SLOT_COUNT > m_slots;   //!< Per slot: index into m_entries.
+    };
+
+    // Creates a frozen table deducing the number of entries.
+    /*!
+     * @code
+     * constexpr auto codes = ac::make_frozen_hashtbl<char,int>( {{'a', 27}, {'b', 3}} );
+     * static_assert( codes.at('b') == 3, "" );
+     * @endcode
+     */
+    template< class KeyType,
+              class DataType,
+              class KeyHash = FrozenHash< KeyType >,
+              class KeyEqual = std::equal_to< KeyType >,
+              std::size_t N >
+    constexpr FrozenHashTbl< KeyType, DataType, N, KeyHash, KeyEqual >
+    make_frozen_hashtbl( const HashEntry< KeyType, DataType > (&entries_)[N] )
+    {
+        return FrozenHashTbl< KeyType, DataType, N, KeyHash, KeyEqual >( entries_ );
+    }
+
+} // Namespace ac.
+#include "frozen_hashtbl.inl"
+#endif
@@ -0,0 +1,258 @@
+/*!
+ * @file frozen_hashtbl.inl
+ * @brief Implementation of the FrozenHashTbl class methods.
+ *
+ * @author Lucas Bazante
+ */
+
+#include "frozen_hashtbl.h"
+
+namespace ac {
+
+    /// CONSTRUCTORS
+
+    // Entries constructor.
+    /*!
+     * This constructor copies the entries and computes the perfect hash layout.
+     * Duplicated keys make the construction fail (at compile time, if constexpr).
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam N The number of entries.
+     * @tparam KeyHash A constexpr function that reads a key and a seed and returns an unsigned integer.
+     * @tparam KeyEqual  A constexpr function that compares two keys.
+     *
+     * @param entries_ The entries of the table.
+     */
+	template< typename KeyType, typename DataType, std::size_t N, typename KeyHash, typename KeyEqual >
+	constexpr FrozenHashTbl<KeyType,DataType,N,KeyHash,KeyEqual>::FrozenHashTbl( const entry_type (&entries_)[N] )
+        : FrozenHashTbl( entries_, std::make_index_sequence< N >{ } )
+	{/*Empty*/}
+
+    // Entries constructor (implementation).
+    /*!
+     * The index sequence lets us copy the entries into the array in the member
+     * initializer list, since entry_type need not be default constructible.
+     */
+	template< typename KeyType, typename DataType, std::size_t N, typename KeyHash, typename KeyEqual >
+    template< std::size_t... Is >
+	constexpr FrozenHashTbl<KeyType,DataType,N,KeyHash,KeyEqual>::FrozenHashTbl( const entry_type (&entries_)[N],
+                                                                                 std::index_sequence< Is... > )
+        : m_entries{ { entries_[ Is ]... } }
+        , m_seeds{ }
+        , m_slots{ }
+	{
+        build( );
+	}
+
+    /// CLASS METHODS
+
+    // Retrieves data from the table.
+    /*!
+     * Retrieves a data item from the table, based on the key associated with the data.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam N The number of entries.
+     * @tparam KeyHash A constexpr function that reads a key and a seed and returns an unsigned integer.
+     * @tparam KeyEqual  A constexpr function that compares two keys.
+     *
+     * @param key_ Data key to search for in the table.
+     * @param data_item_ Data record to be filled in when data item is found.
+     *
+     * @return True if the data item is found; False, otherwise.
+     */
+	template< typename KeyType, typename DataType, std::size_t N, typename KeyHash, typename KeyEqual >
+    constexpr bool FrozenHashTbl<KeyType,DataType,N,KeyHash,KeyEqual>::retrieve( const KeyType & key_, DataType & data_item_ ) const
+    {
+        KeyEqual eq;
+        const auto & entry = m_entries[ locate( key_ ) ];
+
+        if ( eq( entry.m_key, key_ ) )
+        {
+            data_item_ = entry.m_data;
+            return true;
+        }
+
+        return false;
+    }
+
+    // Reference to the element associated with a key.
+    /*!
+     * This function finds the data associated with a certain key, if it doesn't exist, an exception is thrown.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam N The number of entries.
+     * @tparam KeyHash A constexpr function that reads a key and a seed and returns an unsigned integer.
+     * @tparam KeyEqual  A constexpr function that compares two keys.
+     *
+     * @param key_ Key to wanted element.
+     *
+     * @return Data associated with the key.
+     */
+	template< typename KeyType, typename DataType, std::size_t N, typename KeyHash, typename KeyEqual >
+    constexpr const DataType& FrozenHashTbl<KeyType,DataType,N,KeyHash,KeyEqual>::at( const KeyType & key_ ) const
+    {
+        KeyEqual eq;
+        const auto & entry = m_entries[ locate( key_ ) ];
+
+        if ( not eq( entry.m_key, key_ ) )
+            throw std::out_of_range( "Not present" );
+
+        return entry.m_data;
+    }
+
+    // Counts the elements associated with a key.
+    /*!
+     * Keys are unique, so this is either zero or one.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam N The number of entries.
+     * @tparam KeyHash A constexpr function that reads a key and a seed and returns an unsigned integer.
+     * @tparam KeyEqual  A constexpr function that compares two keys.
+     *
+     * @param key_ Key to search for.
+     *
+     * @return 1 if the key is in the table; 0 otherwise.
+     */
+	template< typename KeyType, typename DataType, std::size_t N, typename KeyHash, typename KeyEqual >
+    constexpr typename FrozenHashTbl<KeyType,DataType,N,KeyHash,KeyEqual>::size_type
+    FrozenHashTbl<KeyType,DataType,N,KeyHash,KeyEqual>::count( const KeyType & key_ ) const
+    {
+        KeyEqual eq;
+        return eq( m_entries[ locate( key_ ) ].m_key, key_ ) ? 1 : 0;
+    }
+
+    // Finds the only entry that may hold a key.
+    /*!
+     * Empty slots point to an arbitrary entry, so the caller must still compare keys.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam N The number of entries.
+     * @tparam KeyHash A constexpr function that reads a key and a seed and returns an unsigned integer.
+     * @tparam KeyEqual  A constexpr function that compares two keys.
+     *
+     * @param key_ Key to search for.
+     *
+     * @return Index of the candidate entry.
+     */
+	template< typename KeyType, typename DataType, std::size_t N, typename KeyHash, typename KeyEqual >
+    constexpr typename FrozenHashTbl<KeyType,DataType,N,KeyHash,KeyEqual>::size_type
+    FrozenHashTbl<KeyType,DataType,N,KeyHash,KeyEqual>::locate( const KeyType & key_ ) const
+    {
+        KeyHash hashf;
+        const std::int64_t seed = m_seeds[ hashf( key_, 0 ) % BUCKET_COUNT ];
+        const size_type slot = seed < 0 ? static_cast< size_type >( -seed - 1 )
+                                        : static_cast< size_type >( hashf( key_, seed ) & ( SLOT_COUNT - 1 ) );
+        return m_slots[ slot ];
+    }
+
+    // Computes the perfect hash layout.
+    /*!
+     * Buckets are processed from the most to the least loaded, so that the hardest
+     * ones are placed while the table is still mostly empty. For each bucket with
+     * more than one key we try seeds until every key lands on a distinct free slot.
+     * Single-key buckets are then given the remaining free slots directly.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam N The number of entries.
+     * @tparam KeyHash A constexpr function that reads a key and a seed and returns an unsigned integer.
+     * @tparam KeyEqual  A constexpr function that compares two keys.
+     */
+	template< typename KeyType, typename DataType, std::size_t N, typename KeyHash, typename KeyEqual >
+    constexpr void FrozenHashTbl<KeyType,DataType,N,KeyHash,KeyEqual>::build( void )
+    {
+        KeyHash hashf;
+        KeyEqual eq;
+        std::array< size_type, N > bucket_of{ };
+        std::array< size_type, BUCKET_COUNT > load{ };
+
+        for ( size_type i = 0; i < N; ++i )
+        {
+            for ( size_type j = 0; j < i; ++j )
+                if ( eq( m_entries[ i ].m_key, m_entries[ j ].m_key ) )
+                    throw std::invalid_argument( "Duplicated key in frozen hash table" );
+
+            bucket_of[ i ] = hashf( m_entries[ i ].m_key, 0 ) % BUCKET_COUNT;
+            ++load[ bucket_of[ i ] ];
+        }
+
+        // Sort the buckets by decreasing load (insertion sort, N is small).
+        std::array< size_type, BUCKET_COUNT > order{ };
+        for ( size_type b = 0; b < BUCKET_COUNT; ++b )
+        {
+            size_type pos = b;
+            while ( pos > 0 and load[ order[ pos - 1 ] ] < load[ b ] )
+            {
+                order[ pos ] = order[ pos - 1 ];
+                --pos;
+            }
+            order[ pos ] = b;
+        }
+
+        std::array< bool, SLOT_COUNT > taken{ };
+        size_type next_free = 0;
+
+        for ( size_type b : order )
+        {
+            if ( load[ b ] == 0 )
+                break; // The remaining buckets are empty as well.
+
+            if ( load[ b ] == 1 )
+            {
+                while ( taken[ next_free ] )
+                    ++next_free;
+
+                size_type i = 0;
+                while ( bucket_of[ i ] != b )
+                    ++i;
+
+                m_seeds[ b ] = -static_cast< std::int64_t >( next_free + 1 );
+                m_slots[ next_free ] = i;
+                taken[ next_free ] = true;
+                continue;
+            }
+
+            for ( std::int64_t seed = 1; ; ++seed )
+            {
+                if ( seed == ( std::int64_t{ 1 } << 20 ) )
+                    throw std::invalid_argument( "No perfect hash found; is the hash function degenerate?" );
+
+                std::array< size_type, N > slots{ };
+                std::array< size_type, N > members{ };
+                size_type n_members = 0;
+                bool fits = true;
+
+                for ( size_type i = 0; i < N and fits; ++i )
+                {
+                    if ( bucket_of[ i ] != b )
+                        continue;
+
+                    const size_type slot = hashf( m_entries[ i ].m_key, seed ) & ( SLOT_COUNT - 1 );
+                    fits = not taken[ slot ];
+                    for ( size_type k = 0; k < n_members and fits; ++k )
+                        fits = slots[ k ] != slot;
+
+                    slots[ n_members ] = slot;
+                    members[ n_members++ ] = i;
+                }
+
+                if ( not fits )
+                    continue;
+
+                m_seeds[ b ] = seed;
+                for ( size_type k = 0; k < n_members; ++k )
+                {
+                    m_slots[ slots[ k ] ] = members[ k ];
+                    taken[ slots[ k ] ] = true;
+                }
+                break;
+            }
+        }
+    }
+
+} // Namespace ac.
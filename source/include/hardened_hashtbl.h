@@ -0,0 +1,157 @@
+/*!
+ * @file hardened_hashtbl.h
+ * @brief Hash table resistant to hash flooding: seeded hashing and chains that turn into trees.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _HARDENED_HASHTBL_H_
+#define _HARDENED_HASHTBL_H_
+
+#include <algorithm>        // max
+#include <cstdint>          // uint64_t
+#include <forward_list>     // forward_list
+#include <functional>       // equal_to, less
+#include <iostream>         // ostream
+#include <map>              // map
+#include <memory>           // unique_ptr, make_unique
+#include <random>           // random_device
+#include <stdexcept>        // out_of_range
+#include <type_traits>      // is_invocable
+#include <utility>          // pair, move, swap
+
+#include "hash_mix.h"       // seeded_hash_t, mix64
+#include "hash_primes.h"    // next_prime
+
+namespace ac // Associative container
+{
+    /*!
+     * This class implements a chained hash table for keys that may be chosen by
+     * an adversary, e.g. names typed in by clients.
+     *
+     * Each table draws a random seed. A KeyHash callable as hashf( key, seed )
+     * (such as the default SeededHash, a SipHash for strings and bitwise keys) is
+     * given the seed; any other is called as hashf( key ) and its result mixed with
+     * the seed, which hides the bucket of each key but cannot separate keys whose
+     * hashes are equal.
+     *
+     * So that even such keys cost O(log n), a chain longer than the treeify
+     * threshold becomes a balanced tree (a std::map) ordered by hash, then by
+     * KeyLess, which must agree with KeyEqual; it turns back into a chain when it
+     * shrinks to half the threshold. Each entry keeps its hash, so rehashing does
+     * not call KeyHash again.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key (and a seed) and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam KeyLess A strict weak order of keys, consistent with KeyEqual.
+     */
+	template< class KeyType,
+		      class DataType,
+		      class KeyHash = seeded_hash_t< KeyType >,
+		      class KeyEqual = std::equal_to< KeyType >,
+              class KeyLess = std::less< KeyType > >
+	class HardenedHashTbl {
+        public:
+            // Aliases
+            using size_type = std::size_t;
+
+        private:
+            /// A chain element, with the hash of its key.
+            struct Node {
+                std::size_t m_hash;
+                KeyType m_key;
+                DataType m_data;
+
+                Node( std::size_t h_, KeyType kt_, DataType dt_ )
+                    : m_hash{ h_ }, m_key{ std::move( kt_ ) }, m_data{ std::move( dt_ ) } {}
+            };
+
+            /// Orders tree entries by hash, then by key; looks them up by ( hash, &key ) without copying the key.
+            struct TreeLess {
+                using is_transparent = void;
+
+                template< class A, class B >
+                bool operator()( const A & a_, const B & b_ ) const
+                {
+                    if ( a_.first != b_.first )
+                        return a_.first < b_.first;
+                    return KeyLess{ }( key_of( a_.second ), key_of( b_.second ) );
+                }
+
+                static const KeyType & key_of( const KeyType & key_ ) { return key_; }
+                static const KeyType & key_of( const KeyType * key_ ) { return *key_; }
+            };
+
+            using chain_type = std::forward_list< Node >;
+            using tree_type = std::map< std::pair< std::size_t, KeyType >, DataType, TreeLess >;
+
+            /// A chain, or a tree once the chain grew too long.
+            struct Bucket {
+                chain_type m_chain;                 //!< The elements, while there is no tree.
+                std::unique_ptr< tree_type > m_tree; //!< The elements of a treeified bucket.
+                size_type m_length = 0;             //!< Length of the chain.
+            };
+
+        public:
+            /// Constructors
+            explicit HardenedHashTbl( size_type table_sz_ = DEFAULT_SIZE, std::uint64_t seed_ = random_seed( ) );
+            HardenedHashTbl( const HardenedHashTbl & );
+
+            /// Overloaded operators
+            HardenedHashTbl & operator=( HardenedHashTbl );
+
+            /// Class methods
+            bool insert( const KeyType &, const DataType & );
+            bool retrieve( const KeyType &, DataType & ) const;
+            DataType* find( const KeyType & );
+            const DataType* find( const KeyType & ) const;
+            bool erase( const KeyType & );
+            void clear( );
+            bool empty( ) const { return m_count == 0; };
+            size_type size( ) const { return m_count; };
+            DataType& at( const KeyType & );
+            DataType& operator[]( const KeyType & );
+            size_type count( const KeyType & key_ ) const { return find( key_ ) != nullptr; };
+            float load_factor( ) const { return ( float ) m_count / m_size; };
+            float max_load_factor( ) const { return m_max_load_factor; };
+            void max_load_factor( float mlf ) { m_max_load_factor = mlf; };
+            size_type bucket_count( ) const { return m_size; };
+            std::uint64_t seed( ) const { return m_seed; };
+            size_type treeify_threshold( ) const { return m_treeify; };
+            void treeify_threshold( size_type n_ ) { m_treeify = n_; };
+            size_type tree_count( ) const { return m_trees; };
+            template< class Function >
+            void for_each( Function ) const;
+
+            /// Friend functions
+            friend std::ostream & operator<<( std::ostream & os_, const HardenedHashTbl & ht_ ) {
+                ht_.for_each( [ & ]( const KeyType &, const DataType & data_ ){ os_ << data_ << "\n"; } );
+                return os_;
+            }
+
+        private:
+            /// Private methods
+            static std::uint64_t random_seed( );
+            std::size_t hash( const KeyType & ) const;
+            const DataType* locate( const KeyType &, std::size_t ) const;
+            void link( std::size_t, KeyType, DataType );
+            void treeify( Bucket & );
+            void untreeify( Bucket & );
+            void rehash( size_type );
+
+        private:
+            std::unique_ptr< Bucket[] > m_table; //!< Bucket array.
+            size_type m_size;                    //!< Table size.
+            size_type m_count = 0;               //!< Number of elements in the table.
+            size_type m_trees = 0;               //!< Number of treeified buckets.
+            size_type m_treeify = 8;             //!< Chains longer than this become trees (0: never).
+            std::uint64_t m_seed;                //!< Seed of the hash, drawn per table.
+            float m_max_load_factor = 1.0f;      //!< Grow when the load factor exceeds this.
+            static const short DEFAULT_SIZE = 11;
+    };
+
+} // Namespace ac.
+#include "hardened_hashtbl.inl"
+#endif
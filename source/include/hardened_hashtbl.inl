@@ -0,0 +1,524 @@
+/*!
+ * @file hardened_hashtbl.inl
+ * @brief Implementation of the HardenedHashTbl class methods.
+ *
+ * @author Lucas Bazante
+ */
+
+#include "hardened_hashtbl.h"
+
+namespace ac {
+
+    /// CONSTRUCTORS
+
+    // Regular constructor.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key (and a seed) and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam KeyLess A strict weak order of keys, consistent with KeyEqual.
+     *
+     * @param table_sz_ Table size.
+     * @param seed_ Seed of the hash; random unless given (e.g. to reproduce a run).
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, typename KeyLess >
+	HardenedHashTbl<KeyType,DataType,KeyHash,KeyEqual,KeyLess>::HardenedHashTbl( size_type table_sz_, std::uint64_t seed_ )
+        : m_table( new Bucket[ std::max< size_type >( table_sz_, 1 ) ] )
+        , m_size( std::max< size_type >( table_sz_, 1 ) )
+        , m_seed( seed_ )
+	{/*Empty*/}
+
+    // Copy constructor.
+    /*!
+     * The copy has the same seed, hence the same buckets and trees.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key (and a seed) and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam KeyLess A strict weak order of keys, consistent with KeyEqual.
+     *
+     * @param source_ Table to be copied.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, typename KeyLess >
+	HardenedHashTbl<KeyType,DataType,KeyHash,KeyEqual,KeyLess>::HardenedHashTbl( const HardenedHashTbl & source_ )
+        : m_table( new Bucket[ source_.m_size ] )
+        , m_size( source_.m_size )
+        , m_count( source_.m_count )
+        , m_trees( source_.m_trees )
+        , m_treeify( source_.m_treeify )
+        , m_seed( source_.m_seed )
+        , m_max_load_factor( source_.m_max_load_factor )
+	{
+        for ( size_type i = 0; i < m_size; ++i )
+        {
+            m_table[ i ].m_chain = source_.m_table[ i ].m_chain;
+            m_table[ i ].m_length = source_.m_table[ i ].m_length;
+            if ( source_.m_table[ i ].m_tree )
+                m_table[ i ].m_tree = std::make_unique< tree_type >( *source_.m_table[ i ].m_tree );
+        }
+	}
+
+    /// OVERLOADED OPERATORS
+
+    // Assignment operator.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key (and a seed) and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam KeyLess A strict weak order of keys, consistent with KeyEqual.
+     *
+     * @param other_ Copy of the table to be assigned.
+     *
+     * @return This table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, typename KeyLess >
+	HardenedHashTbl<KeyType,DataType,KeyHash,KeyEqual,KeyLess> &
+    HardenedHashTbl<KeyType,DataType,KeyHash,KeyEqual,KeyLess>::operator=( HardenedHashTbl other_ )
+	{
+        std::swap( m_table, other_.m_table );
+        std::swap( m_size, other_.m_size );
+        std::swap( m_count, other_.m_count );
+        std::swap( m_trees, other_.m_trees );
+        std::swap( m_treeify, other_.m_treeify );
+        std::swap( m_seed, other_.m_seed );
+        std::swap( m_max_load_factor, other_.m_max_load_factor );
+        return *this;
+	}
+
+    /// CLASS METHODS
+
+    // Inserts data into the hash table according to the associated key.
+    /*!
+     * Inserts the new entry if the key does not exist and updates the data otherwise.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key (and a seed) and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam KeyLess A strict weak order of keys, consistent with KeyEqual.
+     *
+     * @param key_ Key associated with data.
+     * @param new_data_ New data to be inserted/updated.
+     *
+     * @return True if the insertion was successful; False if the key already existed.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, typename KeyLess >
+    bool HardenedHashTbl<KeyType,DataType,KeyHash,KeyEqual,KeyLess>::insert( const KeyType & key_, const DataType & new_data_ )
+    {
+        const auto h = hash( key_ );
+        auto data = locate( key_, h );
+        if ( data != nullptr )
+        {
+            *const_cast< DataType * >( data ) = new_data_;
+            return false;
+        }
+
+        link( h, key_, new_data_ );
+        if ( ++m_count > m_max_load_factor * m_size )
+            rehash( detail::next_prime( 2 * m_size ) );
+
+        return true;
+    }
+
+    // Retrieves data from the table.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key (and a seed) and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam KeyLess A strict weak order of keys, consistent with KeyEqual.
+     *
+     * @param key_ Data key to search for in the table.
+     * @param data_item_ Data record to be filled in when data item is found.
+     *
+     * @return True if the data item is found; False, otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, typename KeyLess >
+    bool HardenedHashTbl<KeyType,DataType,KeyHash,KeyEqual,KeyLess>::retrieve( const KeyType & key_, DataType & data_item_ ) const
+    {
+        auto data = find( key_ );
+        if ( data != nullptr )
+            data_item_ = *data;
+        return data != nullptr;
+    }
+
+    // Locates the data associated with a key.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key (and a seed) and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam KeyLess A strict weak order of keys, consistent with KeyEqual.
+     *
+     * @param key_ Data key to search for in the table.
+     *
+     * @return Pointer to the data associated with the key, or nullptr if the key is not in the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, typename KeyLess >
+    const DataType* HardenedHashTbl<KeyType,DataType,KeyHash,KeyEqual,KeyLess>::find( const KeyType & key_ ) const
+    {
+        return locate( key_, hash( key_ ) );
+    }
+
+    // Locates the data associated with a key.
+    /*!
+     * Non-const version of find().
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key (and a seed) and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam KeyLess A strict weak order of keys, consistent with KeyEqual.
+     *
+     * @param key_ Data key to search for in the table.
+     *
+     * @return Pointer to the data associated with the key, or nullptr if the key is not in the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, typename KeyLess >
+    DataType* HardenedHashTbl<KeyType,DataType,KeyHash,KeyEqual,KeyLess>::find( const KeyType & key_ )
+    {
+        return const_cast< DataType * >( static_cast< const HardenedHashTbl & >( *this ).find( key_ ) );
+    }
+
+    // Erase element from the hash table.
+    /*!
+     * A tree that shrinks to half the treeify threshold turns back into a chain.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key (and a seed) and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam KeyLess A strict weak order of keys, consistent with KeyEqual.
+     *
+     * @param key_ Key of element to be removed.
+     *
+     * @return True if the key was found; False otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, typename KeyLess >
+    bool HardenedHashTbl<KeyType,DataType,KeyHash,KeyEqual,KeyLess>::erase( const KeyType & key_ )
+    {
+        KeyEqual eq;
+        const auto h = hash( key_ );
+        auto & which = m_table[ h % m_size ];
+
+        if ( which.m_tree )
+        {
+            auto item = which.m_tree->find( std::make_pair( h, &key_ ) );
+            if ( item == which.m_tree->end( ) )
+                return false;
+
+            which.m_tree->erase( item );
+            if ( which.m_tree->size( ) <= m_treeify / 2 )
+                untreeify( which );
+            --m_count;
+            return true;
+        }
+
+        auto prev = which.m_chain.before_begin( );
+        for ( auto it = which.m_chain.begin( ); it != which.m_chain.end( ); prev = it++ )
+        {
+            if ( it->m_hash == h and eq( it->m_key, key_ ) )
+            {
+                which.m_chain.erase_after( prev );
+                --which.m_length;
+                --m_count;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Clears the data table.
+    /*!
+     * The bucket array keeps its size, and the table its seed.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key (and a seed) and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam KeyLess A strict weak order of keys, consistent with KeyEqual.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, typename KeyLess >
+    void HardenedHashTbl<KeyType,DataType,KeyHash,KeyEqual,KeyLess>::clear( )
+    {
+        for ( size_type i = 0; i < m_size; ++i )
+            m_table[ i ] = Bucket{ };
+        m_count = 0;
+        m_trees = 0;
+    }
+
+    // Reference to the element at given position.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key (and a seed) and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam KeyLess A strict weak order of keys, consistent with KeyEqual.
+     *
+     * @param key_ Key to wanted element.
+     *
+     * @return Data associated with the key.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, typename KeyLess >
+    DataType& HardenedHashTbl<KeyType,DataType,KeyHash,KeyEqual,KeyLess>::at( const KeyType & key_ )
+    {
+        auto data = find( key_ );
+        if ( data != nullptr )
+            return *data;
+
+        throw std::out_of_range( "Not present" );
+    }
+
+    // Accesses the element associated with the key or inserts a new element.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key (and a seed) and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam KeyLess A strict weak order of keys, consistent with KeyEqual.
+     *
+     * @param key_ Key possibly associated with an element in the table.
+     *
+     * @return A reference to the data associated with the key.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, typename KeyLess >
+    DataType& HardenedHashTbl<KeyType,DataType,KeyHash,KeyEqual,KeyLess>::operator[]( const KeyType & key_ )
+    {
+        auto data = find( key_ );
+        if ( data != nullptr )
+            return *data;
+
+        insert( key_, DataType{ } );
+        return *find( key_ );
+    }
+
+    // Visits every element of the table.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key (and a seed) and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam KeyLess A strict weak order of keys, consistent with KeyEqual.
+     * @tparam Function A function accepting a key and a data item.
+     *
+     * @param fn_ The function to be called.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, typename KeyLess >
+    template< typename Function >
+    void HardenedHashTbl<KeyType,DataType,KeyHash,KeyEqual,KeyLess>::for_each( Function fn_ ) const
+    {
+        for ( size_type i = 0; i < m_size; ++i )
+        {
+            if ( m_table[ i ].m_tree )
+                for ( const auto & en : *m_table[ i ].m_tree )
+                    fn_( en.first.second, en.second );
+            else
+                for ( const auto & node : m_table[ i ].m_chain )
+                    fn_( node.m_key, node.m_data );
+        }
+    }
+
+    // Draws a seed.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key (and a seed) and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam KeyLess A strict weak order of keys, consistent with KeyEqual.
+     *
+     * @return 64 bits from std::random_device.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, typename KeyLess >
+    std::uint64_t HardenedHashTbl<KeyType,DataType,KeyHash,KeyEqual,KeyLess>::random_seed( )
+    {
+        std::random_device device;
+        return ( std::uint64_t( device( ) ) << 32 ) ^ device( );
+    }
+
+    // Hashes a key under the table's seed.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key (and a seed) and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam KeyLess A strict weak order of keys, consistent with KeyEqual.
+     *
+     * @param key_ The key.
+     *
+     * @return hashf( key_, seed ) if KeyHash takes a seed; hashf( key_ ) mixed with the seed otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, typename KeyLess >
+    std::size_t HardenedHashTbl<KeyType,DataType,KeyHash,KeyEqual,KeyLess>::hash( const KeyType & key_ ) const
+    {
+        KeyHash hashf;
+        if constexpr ( std::is_invocable_v< const KeyHash &, const KeyType &, std::uint64_t > )
+            return hashf( key_, m_seed );
+        else
+            return mix64( hashf( key_ ), m_seed );
+    }
+
+    // Locates the data associated with a hashed key.
+    /*!
+     * Walks a chain (no longer than the treeify threshold) or searches a tree.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key (and a seed) and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam KeyLess A strict weak order of keys, consistent with KeyEqual.
+     *
+     * @param key_ Data key to search for in the table.
+     * @param h_ Its hash.
+     *
+     * @return Pointer to the data associated with the key, or nullptr if the key is not in the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, typename KeyLess >
+    const DataType* HardenedHashTbl<KeyType,DataType,KeyHash,KeyEqual,KeyLess>::locate( const KeyType & key_, std::size_t h_ ) const
+    {
+        KeyEqual eq;
+        const auto & which = m_table[ h_ % m_size ];
+
+        if ( which.m_tree )
+        {
+            auto item = which.m_tree->find( std::make_pair( h_, &key_ ) );
+            return item == which.m_tree->end( ) ? nullptr : &item->second;
+        }
+
+        for ( const auto & node : which.m_chain )
+            if ( node.m_hash == h_ and eq( node.m_key, key_ ) )
+                return &node.m_data;
+        return nullptr;
+    }
+
+    // Adds an element whose key is not in the table.
+    /*!
+     * The bucket is treeified if its chain becomes too long.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key (and a seed) and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam KeyLess A strict weak order of keys, consistent with KeyEqual.
+     *
+     * @param h_ Hash of the key.
+     * @param key_ The key.
+     * @param data_ The data.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, typename KeyLess >
+    void HardenedHashTbl<KeyType,DataType,KeyHash,KeyEqual,KeyLess>::link( std::size_t h_, KeyType key_, DataType data_ )
+    {
+        auto & which = m_table[ h_ % m_size ];
+        if ( which.m_tree )
+        {
+            which.m_tree->emplace( std::make_pair( h_, std::move( key_ ) ), std::move( data_ ) );
+            return;
+        }
+
+        which.m_chain.emplace_front( h_, std::move( key_ ), std::move( data_ ) );
+        ++which.m_length;
+        if ( m_treeify != 0 and which.m_length > m_treeify )
+            treeify( which );
+    }
+
+    // Turns the chain of a bucket into a tree.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key (and a seed) and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam KeyLess A strict weak order of keys, consistent with KeyEqual.
+     *
+     * @param bucket_ The bucket.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, typename KeyLess >
+    void HardenedHashTbl<KeyType,DataType,KeyHash,KeyEqual,KeyLess>::treeify( Bucket & bucket_ )
+    {
+        auto tree = std::make_unique< tree_type >( );
+        for ( auto & node : bucket_.m_chain )
+            tree->emplace( std::make_pair( node.m_hash, std::move( node.m_key ) ), std::move( node.m_data ) );
+
+        bucket_.m_chain.clear( );
+        bucket_.m_length = 0;
+        bucket_.m_tree = std::move( tree );
+        ++m_trees;
+    }
+
+    // Turns the tree of a bucket back into a chain.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key (and a seed) and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam KeyLess A strict weak order of keys, consistent with KeyEqual.
+     *
+     * @param bucket_ The bucket.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, typename KeyLess >
+    void HardenedHashTbl<KeyType,DataType,KeyHash,KeyEqual,KeyLess>::untreeify( Bucket & bucket_ )
+    {
+        auto & tree = *bucket_.m_tree;
+        while ( not tree.empty( ) )
+        {
+            auto node = tree.extract( tree.begin( ) );
+            bucket_.m_chain.emplace_front( node.key( ).first, std::move( node.key( ).second ), std::move( node.mapped( ) ) );
+            ++bucket_.m_length;
+        }
+
+        bucket_.m_tree.reset( );
+        --m_trees;
+    }
+
+    // Redistributes the elements into a bucket array of the given size.
+    /*!
+     * Chain nodes are relinked and tree entries moved into chains, by their stored
+     * hashes; chains that end up too long are then treeified.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key (and a seed) and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam KeyLess A strict weak order of keys, consistent with KeyEqual.
+     *
+     * @param new_size_ The new number of buckets.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, typename KeyLess >
+    void HardenedHashTbl<KeyType,DataType,KeyHash,KeyEqual,KeyLess>::rehash( size_type new_size_ )
+    {
+        std::unique_ptr< Bucket[] > table( new Bucket[ new_size_ ] );
+
+        for ( size_type i = 0; i < m_size; ++i )
+        {
+            auto & from = m_table[ i ];
+            while ( not from.m_chain.empty( ) )
+            {
+                auto & to = table[ from.m_chain.front( ).m_hash % new_size_ ];
+                to.m_chain.splice_after( to.m_chain.before_begin( ), from.m_chain, from.m_chain.before_begin( ) );
+                ++to.m_length;
+            }
+            if ( from.m_tree )
+            {
+                auto & tree = *from.m_tree;
+                while ( not tree.empty( ) )
+                {
+                    auto node = tree.extract( tree.begin( ) );
+                    auto & to = table[ node.key( ).first % new_size_ ];
+                    to.m_chain.emplace_front( node.key( ).first, std::move( node.key( ).second ), std::move( node.mapped( ) ) );
+                    ++to.m_length;
+                }
+                from.m_tree.reset( );
+            }
+        }
+
+        m_table = std::move( table );
+        m_size = new_size_;
+        m_trees = 0;
+        for ( size_type i = 0; i < m_size; ++i )
+            if ( m_treeify != 0 and m_table[ i ].m_length > m_treeify )
+                treeify( m_table[ i ] );
+    }
+
+} // Namespace ac.
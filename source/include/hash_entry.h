@@ -0,0 +1,78 @@
+/*!
+ * @file hash_entry.h
+ * @brief Key/data pair stored by the hash tables of this library, and a handle owning one.
+ *
+ * @author Selan
+ */
+
+#ifndef _HASH_ENTRY_H_
+#define _HASH_ENTRY_H_
+
+#include <forward_list>     // forward_list
+#include <iostream>         // ostream
+#include <utility>          // move
+
+namespace ac // Associative container
+{
+    /*!
+     * Struct representing a hash table element.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     */
+	template<class KeyType, class DataType>
+	struct HashEntry {
+        KeyType m_key;   //! Data key
+        DataType m_data; //! The data
+
+        // Regular constructor.
+        constexpr HashEntry( KeyType kt_, DataType dt_ ) : m_key{ std::move( kt_ ) } , m_data{ std::move( dt_ ) }
+        {/*Empty*/}
+
+        friend std::ostream & operator<<( std::ostream & os_, const HashEntry & he_ ) {
+            // os_ << "{" << he_.m_key << "," << he_.m_data << "}";
+            os_ << he_.m_data;
+            return os_;
+        }
+    };
+
+    template< class, class, class, class > class HashTbl;
+
+    /*!
+     * Owns an element taken out of a HashTbl (HashTbl::extract()), node and all, so
+     * that it can be inserted into another table with the same key and data types
+     * by relinking the node: the key and data are neither copied nor moved, and
+     * nothing is allocated or freed. An empty handle owns nothing.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     */
+    template< class KeyType, class DataType >
+    class HashNode {
+        public:
+            /// Constructors
+            HashNode( ) = default;
+            HashNode( KeyType kt_, DataType dt_ ) { m_node.emplace_front( std::move( kt_ ), std::move( dt_ ) ); };
+            HashNode( HashNode && ) = default;
+            HashNode( const HashNode & ) = delete;
+
+            /// Overloaded operators
+            HashNode & operator=( HashNode && other_ ) { m_node.clear( ); m_node.swap( other_.m_node ); return *this; };
+            HashNode & operator=( const HashNode & ) = delete;
+            explicit operator bool( ) const { return not empty( ); };
+
+            /// Class methods
+            bool empty( ) const { return m_node.empty( ); };
+            KeyType & key( ) { return m_node.front( ).m_key; };
+            const KeyType & key( ) const { return m_node.front( ).m_key; };
+            DataType & data( ) { return m_node.front( ).m_data; };
+            const DataType & data( ) const { return m_node.front( ).m_data; };
+
+        private:
+            template< class, class, class, class > friend class HashTbl;
+
+            std::forward_list< HashEntry< KeyType, DataType > > m_node; //!< The element, or nothing.
+    };
+
+} // Namespace ac.
+#endif
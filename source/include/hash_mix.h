@@ -0,0 +1,201 @@
+/*!
+ * @file hash_mix.h
+ * @brief Integer mixing and hash functions shared by the hash tables of this library.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _HASH_MIX_H_
+#define _HASH_MIX_H_
+
+#include <cstddef>          // size_t
+#include <cstdint>          // uint64_t
+#include <cstring>          // memcpy, memcmp
+#include <functional>       // hash, equal_to
+#include <string>           // string
+#include <string_view>      // string_view
+#include <type_traits>      // is_integral, has_unique_object_representations
+
+namespace ac // Associative container
+{
+    /// Multiplier derived from the golden ratio, used to spread seeds.
+    constexpr std::uint64_t GOLDEN_GAMMA = 0x9e3779b97f4a7c15ULL;
+
+    // Mixes the bits of a 64-bit integer.
+    /*!
+     * Finalizer of MurmurHash3: a bijection in which every input bit
+     * affects every output bit, so low and high bits are equally good.
+     *
+     * @param x_ The value to be mixed.
+     *
+     * @return The mixed value.
+     */
+    constexpr std::uint64_t mix64( std::uint64_t x_ )
+    {
+        x_ ^= x_ >> 33;
+        x_ *= 0xff51afd7ed558ccdULL;
+        x_ ^= x_ >> 33;
+        x_ *= 0xc4ceb9fe1a85ec53ULL;
+        x_ ^= x_ >> 33;
+        return x_;
+    }
+
+    // Mixes the bits of a 64-bit integer under a seed.
+    /*!
+     * Different seeds yield independent-looking functions of the same input.
+     *
+     * @param x_ The value to be mixed.
+     * @param seed_ The seed selecting the function.
+     *
+     * @return The mixed value.
+     */
+    constexpr std::uint64_t mix64( std::uint64_t x_, std::uint64_t seed_ )
+    {
+        return mix64( x_ ^ ( seed_ * GOLDEN_GAMMA ) );
+    }
+
+    /// Whether a key is hashed and compared by its bytes: integers, enums and padding-free trivially copyable types.
+    template< class KeyType >
+    constexpr bool is_bitwise_key_v = std::is_integral_v< KeyType > or std::is_enum_v< KeyType >
+        or ( std::is_trivially_copyable_v< KeyType > and std::has_unique_object_representations_v< KeyType > );
+
+    /*!
+     * Hash of bitwise keys: their bytes, as 64-bit words, run through mix64().
+     *
+     * Unlike the identity std::hash of integers, keys that differ by a multiple of the
+     * table size (strided IDs, aligned addresses) do not share a bucket.
+     *
+     * @tparam KeyType The key type.
+     */
+    template< class KeyType >
+    struct MixHash {
+        static_assert( is_bitwise_key_v< KeyType >, "MixHash hashes the bytes of the key" );
+
+        std::size_t operator()( const KeyType & key_ ) const noexcept
+        {
+            if constexpr ( std::is_integral_v< KeyType > or std::is_enum_v< KeyType > )
+                return mix64( static_cast< std::uint64_t >( key_ ) );
+            else
+            {
+                const auto * bytes = reinterpret_cast< const unsigned char * >( &key_ );
+                std::uint64_t h = sizeof( KeyType );
+                std::size_t i = 0;
+                for ( ; i + 8 <= sizeof( KeyType ); i += 8 )
+                {
+                    std::uint64_t word;
+                    std::memcpy( &word, bytes + i, 8 );
+                    h = mix64( h ^ word, i );
+                }
+                if ( i < sizeof( KeyType ) )
+                {
+                    std::uint64_t word = 0;
+                    std::memcpy( &word, bytes + i, sizeof( KeyType ) - i );
+                    h = mix64( h ^ word, i );
+                }
+                return h;
+            }
+        }
+    };
+
+    /*!
+     * Equality of bitwise keys: a comparison of their bytes, so that plain structs need no operator==.
+     *
+     * @tparam KeyType The key type.
+     */
+    template< class KeyType >
+    struct BitwiseEqual {
+        static_assert( is_bitwise_key_v< KeyType >, "BitwiseEqual compares the bytes of the key" );
+
+        bool operator()( const KeyType & a_, const KeyType & b_ ) const noexcept
+        {
+            if constexpr ( std::is_integral_v< KeyType > or std::is_enum_v< KeyType > )
+                return a_ == b_;
+            else
+                return std::memcmp( &a_, &b_, sizeof( KeyType ) ) == 0;
+        }
+    };
+
+    // SipHash-2-4 of a byte string.
+    /*!
+     * A keyed hash: without the key, finding inputs that collide is as hard as
+     * guessing it, so tables hashing untrusted keys with a secret key cannot be
+     * flooded.
+     *
+     * @param data_ The bytes.
+     * @param len_ Number of bytes.
+     * @param k0_ First half of the key.
+     * @param k1_ Second half of the key.
+     *
+     * @return The hash.
+     */
+    inline std::uint64_t siphash24( const void * data_, std::size_t len_, std::uint64_t k0_, std::uint64_t k1_ )
+    {
+        auto rotl = []( std::uint64_t x_, int b_ ){ return ( x_ << b_ ) | ( x_ >> ( 64 - b_ ) ); };
+        std::uint64_t v0 = k0_ ^ 0x736f6d6570736575ULL, v1 = k1_ ^ 0x646f72616e646f6dULL;
+        std::uint64_t v2 = k0_ ^ 0x6c7967656e657261ULL, v3 = k1_ ^ 0x7465646279746573ULL;
+        auto round = [ & ]{
+            v0 += v1; v1 = rotl( v1, 13 ); v1 ^= v0; v0 = rotl( v0, 32 );
+            v2 += v3; v3 = rotl( v3, 16 ); v3 ^= v2;
+            v0 += v3; v3 = rotl( v3, 21 ); v3 ^= v0;
+            v2 += v1; v1 = rotl( v1, 17 ); v1 ^= v2; v2 = rotl( v2, 32 );
+        };
+        auto absorb = [ & ]( std::uint64_t m_ ){ v3 ^= m_; round( ); round( ); v0 ^= m_; };
+
+        const auto * bytes = static_cast< const unsigned char * >( data_ );
+        std::size_t i = 0;
+        for ( ; i + 8 <= len_; i += 8 )
+        {
+            std::uint64_t m = 0;
+            for ( int b = 0; b < 8; ++b )
+                m |= std::uint64_t( bytes[ i + b ] ) << ( 8 * b );
+            absorb( m );
+        }
+        std::uint64_t last = std::uint64_t( len_ ) << 56;
+        for ( int b = 0; i + b < len_; ++b )
+            last |= std::uint64_t( bytes[ i + b ] ) << ( 8 * b );
+        absorb( last );
+
+        v2 ^= 0xff;
+        round( ); round( ); round( ); round( );
+        return v0 ^ v1 ^ v2 ^ v3;
+    }
+
+    /// Whether SeededHash hashes a key type: bitwise keys (by their bytes) and strings.
+    template< class KeyType >
+    constexpr bool is_seedable_key_v = is_bitwise_key_v< KeyType >
+        or std::is_same_v< KeyType, std::string > or std::is_same_v< KeyType, std::string_view >;
+
+    /*!
+     * Hash of bitwise keys and strings under a seed: SipHash-2-4 of their bytes,
+     * keyed by the seed. Tables that pick a random seed cannot be flooded with
+     * keys chosen to collide.
+     *
+     * @tparam KeyType The key type.
+     */
+    template< class KeyType >
+    struct SeededHash {
+        static_assert( is_seedable_key_v< KeyType >, "SeededHash hashes the bytes of the key" );
+
+        std::size_t operator()( const KeyType & key_, std::uint64_t seed_ ) const noexcept
+        {
+            if constexpr ( std::is_same_v< KeyType, std::string > or std::is_same_v< KeyType, std::string_view > )
+                return siphash24( key_.data( ), key_.size( ), seed_, mix64( seed_ ) );
+            else
+                return siphash24( &key_, sizeof( KeyType ), seed_, mix64( seed_ ) );
+        }
+    };
+
+    /// MixHash for bitwise keys, std::hash otherwise.
+    template< class KeyType >
+    using fast_hash_t = std::conditional_t< is_bitwise_key_v< KeyType >, MixHash< KeyType >, std::hash< KeyType > >;
+
+    /// BitwiseEqual for bitwise keys, std::equal_to otherwise.
+    template< class KeyType >
+    using fast_equal_t = std::conditional_t< is_bitwise_key_v< KeyType >, BitwiseEqual< KeyType >, std::equal_to< KeyType > >;
+
+    /// SeededHash for the keys it hashes, std::hash otherwise.
+    template< class KeyType >
+    using seeded_hash_t = std::conditional_t< is_seedable_key_v< KeyType >, SeededHash< KeyType >, std::hash< KeyType > >;
+
+} // Namespace ac.
+#endif
@@ -0,0 +1,88 @@
+/*!
+ * @file hash_multitbl.h
+ * @brief Hash table that accepts several elements with the same key.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _HASH_MULTITBL_H_
+#define _HASH_MULTITBL_H_
+
+#include <iostream>         // ostream
+#include <utility>          // pair
+
+#include "hashtbl.h"        // HashTbl
+
+namespace ac // Associative container
+{
+    /*!
+     * This class implements a hash table in which keys need not be unique.
+     *
+     * Elements with equal keys are kept next to each other in their bucket's list
+     * (rehashing preserves this), so count() and equal_range() stop as soon as the
+     * group ends. retrieve() and find() return the first element of a group.
+     *
+     * HashTbl is a protected base: its operations that assume unique keys (update,
+     * upsert, compute, insert_batch, apply_batch, extract, merge, operator[], ...)
+     * would break groups, so only those that read the table, or resize it as a
+     * whole, are made public again.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< class KeyType,
+		      class DataType,
+		      class KeyHash = std::hash< KeyType >,
+		      class KeyEqual = std::equal_to< KeyType > >
+	class HashMultiTbl : protected HashTbl< KeyType, DataType, KeyHash, KeyEqual > {
+        public:
+            // Aliases
+            using base_type = HashTbl< KeyType, DataType, KeyHash, KeyEqual >;
+            using typename base_type::entry_type;
+            using typename base_type::size_type;
+            using typename base_type::const_local_iterator;
+
+            /// Constructors
+            explicit HashMultiTbl( size_type table_sz_ = 11 ) : base_type( table_sz_ ) {/*Empty*/}
+            HashMultiTbl( const std::initializer_list< entry_type > & );
+
+            /// Overloaded operators
+            HashMultiTbl& operator=( const std::initializer_list< entry_type > & );
+
+            /// Class methods
+            bool insert( const KeyType &, const DataType & );
+            size_type erase( const KeyType & );
+            size_type count( const KeyType& ) const;
+            std::pair< const_local_iterator, const_local_iterator > equal_range( const KeyType& ) const;
+
+            /// Operations of HashTbl that keep groups intact
+            using base_type::retrieve;
+            using base_type::find;
+            using base_type::clear;
+            using base_type::empty;
+            using base_type::size;
+            using base_type::load_factor;
+            using base_type::max_load_factor;
+            using base_type::min_load_factor;
+            using base_type::bucket_count;
+            using base_type::bucket;
+            using base_type::begin;
+            using base_type::end;
+            using base_type::reserve;
+            using base_type::shrink_to_fit;
+            using base_type::observer;
+            using base_type::long_chain_threshold;
+            using base_type::membership_filter;
+            using base_type::for_each;
+
+            /// Friend functions
+            friend std::ostream & operator<<( std::ostream & os_, const HashMultiTbl & ht_ ) {
+                return os_ << static_cast< const base_type & >( ht_ );
+            }
+    };
+
+} // Namespace ac.
+#include "hash_multitbl.inl"
+#endif
@@ -0,0 +1,199 @@
+/*!
+ * @file hash_multitbl.inl
+ * @brief Implementation of the HashMultiTbl class methods.
+ *
+ * @author Lucas Bazante
+ */
+
+#include "hash_multitbl.h"
+
+namespace ac {
+
+    /// CONSTRUCTORS
+
+    // Initializer constructor
+    /*!
+     * This constructor creates a table with all the values from the initializer list,
+     * including repeated keys.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param ilist List of values.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+	HashMultiTbl<KeyType,DataType,KeyHash,KeyEqual>::HashMultiTbl( const std::initializer_list< entry_type > & ilist )
+        : base_type( ilist.size() * 2 ) // double the size for a good ratio
+    {
+        for ( const auto & en : ilist )
+            insert( en.m_key, en.m_data );
+    }
+
+    /// OVERLOADED OPERATORS
+
+    // Assignment initializer list.
+    /*!
+     * This operator replaces the contents of the table by the values from the initializer list.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param ilist List of values.
+     *
+     * @return A reference to the modified hash table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+	HashMultiTbl<KeyType,DataType,KeyHash,KeyEqual>&
+    HashMultiTbl<KeyType,DataType,KeyHash,KeyEqual>::operator=( const std::initializer_list< entry_type > & ilist )
+    {
+        this->clear( );
+        this->reserve( ilist.size() );
+        for ( const auto & en : ilist )
+            insert( en.m_key, en.m_data );
+
+        return *this;
+    }
+
+    /// CLASS METHODS
+
+    // Inserts data into the hash table.
+    /*!
+     * The new element is placed right after the last element with the same key,
+     * or at the front of its bucket if the key is new.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key associated with data.
+     * @param new_data_ New data to be inserted.
+     *
+     * @return True if this is the first element with this key; False otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool HashMultiTbl<KeyType,DataType,KeyHash,KeyEqual>::insert( const KeyType & key_, const DataType & new_data_ )
+    {
+        KeyHash hashf;
+        KeyEqual eq;
+        const auto h = hashf( key_ );
+        auto & which = this->m_table[ h % this->m_size ];
+
+        // Find the last element of the group, if there is one.
+        auto prev = which.before_begin();
+        auto it = std::begin( which );
+        while ( it != std::end( which ) and not eq( it->m_key, key_ ) )
+            prev = it++;
+
+        bool fresh = it == std::end( which );
+        if ( fresh )
+            which.emplace_front( key_, new_data_ );
+        else
+        {
+            while ( it != std::end( which ) and eq( it->m_key, key_ ) )
+                prev = it++;
+            which.emplace_after( prev, key_, new_data_ );
+        }
+        if ( this->m_filter )
+            this->m_filter->add( h );
+        if ( this->m_observer or AC_PROBE_ENABLED( long__chain ) )
+            this->observe_chain( h % this->m_size );
+
+        if ( ++this->m_count > this->max_load_factor( ) * this->m_size )
+            this->rehash( );
+
+        return fresh;
+    }
+
+    // Erase elements from the hash table.
+    /*!
+     * This function removes all elements with the given key.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key of elements to be removed.
+     *
+     * @return Number of elements removed.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename HashMultiTbl<KeyType,DataType,KeyHash,KeyEqual>::size_type
+    HashMultiTbl<KeyType,DataType,KeyHash,KeyEqual>::erase( const KeyType & key_ )
+    {
+        KeyHash hashf;
+        KeyEqual eq;
+        const auto h = hashf( key_ );
+        auto & which = this->m_table[ h % this->m_size ];
+
+        auto prev = which.before_begin();
+        while ( std::next( prev ) != std::end( which ) and not eq( std::next( prev )->m_key, key_ ) )
+            ++prev;
+
+        size_type removed = 0;
+        while ( std::next( prev ) != std::end( which ) and eq( std::next( prev )->m_key, key_ ) )
+        {
+            which.erase_after( prev );
+            ++removed;
+            if ( this->m_filter )
+                this->m_filter->remove( h );
+        }
+
+        if ( removed != 0 )
+        {
+            this->m_count -= removed;
+            this->shrink_if_sparse( );
+        }
+        return removed;
+    }
+
+    // Count the elements with a key.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key to search for.
+     *
+     * @return Number of elements whose key is equal to key_.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename HashMultiTbl<KeyType,DataType,KeyHash,KeyEqual>::size_type
+    HashMultiTbl<KeyType,DataType,KeyHash,KeyEqual>::count( const KeyType & key_ ) const
+    {
+        auto range = equal_range( key_ );
+        return std::distance( range.first, range.second );
+    }
+
+    // Range of the elements with a key.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key to search for.
+     *
+     * @return Iterators to the first element with the key and past the last one (equal if there is none).
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    std::pair< typename HashMultiTbl<KeyType,DataType,KeyHash,KeyEqual>::const_local_iterator,
+               typename HashMultiTbl<KeyType,DataType,KeyHash,KeyEqual>::const_local_iterator >
+    HashMultiTbl<KeyType,DataType,KeyHash,KeyEqual>::equal_range( const KeyType & key_ ) const
+    {
+        KeyHash hashf;
+        KeyEqual eq;
+        const auto & which = this->m_table[ hashf( key_ ) % this->m_size ];
+
+        auto first = std::find_if( std::begin( which ), std::end( which ), [ & ]( const entry_type & en ){ return eq( en.m_key, key_ ); } );
+        auto last = std::find_if( first, std::end( which ), [ & ]( const entry_type & en ){ return not eq( en.m_key, key_ ); } );
+        return { first, last };
+    }
+
+} // Namespace ac.
@@ -0,0 +1,39 @@
+/*!
+ * @file hash_mutation.h
+ * @brief Operations applied in batches by HashTbl::apply_batch().
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _HASH_MUTATION_H_
+#define _HASH_MUTATION_H_
+
+namespace ac // Associative container
+{
+    /// What a mutation does to its key.
+    enum class MutationKind {
+        INSERT, //!< Inserts the key, or updates its data if it is already there (as HashTbl::insert()).
+        UPDATE, //!< Updates the data of the key, if it is there.
+        ERASE   //!< Removes the key, if it is there.
+    };
+
+    /*!
+     * Struct representing a change to a hash table element.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     */
+	template<class KeyType, class DataType>
+	struct HashMutation {
+        MutationKind m_kind; //! The change
+        KeyType m_key;       //! Data key
+        DataType m_data;     //! The new data (unused by ERASE)
+
+        // Regular constructor.
+        HashMutation( MutationKind kind_, KeyType kt_, DataType dt_ = DataType{ } )
+            : m_kind{kind_} , m_key{kt_} , m_data{dt_}
+        {/*Empty*/}
+    };
+
+} // Namespace ac.
+#endif
@@ -0,0 +1,77 @@
+/*!
+ * @file hash_observer.h
+ * @brief Events of a HashTbl (rehashing, long chains, allocation failures) and static tracepoints.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _HASH_OBSERVER_H_
+#define _HASH_OBSERVER_H_
+
+#include <chrono>           // nanoseconds
+#include <cstddef>          // size_t
+
+// USDT probes (provider "ac_hashtbl"), visible to perf, bpftrace and SystemTap, when
+// built with -DHASHTBL_USDT and <sys/sdt.h> is available; nothing otherwise.
+//
+// Each probe has a semaphore, which the tracer raises while it is attached, so
+// that AC_PROBE_ENABLED( name ) lets a table skip the work of computing a probe's
+// arguments when nobody listens. _SDT_HAS_SEMAPHORES applies to every probe of a
+// translation unit, so the tables must be included before other users of <sys/sdt.h>.
+#if defined( HASHTBL_USDT ) and defined( __has_include )
+#if __has_include( <sys/sdt.h> )
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>        // DTRACE_PROBE
+#define AC_SEMAPHORE( name_ ) \
+    inline volatile unsigned short ac_hashtbl_##name_##_semaphore __attribute__( ( section( ".probes" ), used ) ) = 0
+AC_SEMAPHORE( rehash__start );
+AC_SEMAPHORE( rehash__end );
+AC_SEMAPHORE( long__chain );
+AC_SEMAPHORE( alloc__fail );
+#undef AC_SEMAPHORE
+#define AC_PROBE_ENABLED( name_ ) __builtin_expect( ac_hashtbl_##name_##_semaphore != 0, 0 )
+#define AC_PROBE1( name_, a_ ) DTRACE_PROBE1( ac_hashtbl, name_, a_ )
+#define AC_PROBE2( name_, a_, b_ ) DTRACE_PROBE2( ac_hashtbl, name_, a_, b_ )
+#define AC_PROBE3( name_, a_, b_, c_ ) DTRACE_PROBE3( ac_hashtbl, name_, a_, b_, c_ )
+#endif
+#endif
+#ifndef AC_PROBE1
+#define AC_PROBE_ENABLED( name_ ) false
+#define AC_PROBE1( name_, a_ ) ( ( void ) 0 )
+#define AC_PROBE2( name_, a_, b_ ) ( ( void ) 0 )
+#define AC_PROBE3( name_, a_, b_, c_ ) ( ( void ) 0 )
+#endif
+
+namespace ac // Associative container
+{
+    /// A change of bucket array.
+    struct RehashEvent {
+        std::size_t m_old_buckets;           //!< Buckets before.
+        std::size_t m_new_buckets;           //!< Buckets after.
+        std::size_t m_entries;               //!< Entries moved.
+        std::chrono::nanoseconds m_duration; //!< Time taken (zero at the start).
+    };
+
+    /*!
+     * Receives the events of the tables it is attached to (HashTbl::observer()).
+     *
+     * Calls are made by the thread changing the table, in the middle of the
+     * operation: observers must be quick and must not touch the table. A table
+     * without an observer only tests a null pointer.
+     */
+    class HashTblObserver {
+        public:
+            virtual ~HashTblObserver( ) = default;
+
+            /// A rehash is starting (it is not followed by an end if its allocation fails).
+            virtual void on_rehash_start( const RehashEvent & ) {}
+            /// A rehash has ended.
+            virtual void on_rehash_end( const RehashEvent & ) {}
+            /// An insertion made a chain longer than the table's threshold.
+            virtual void on_long_chain( std::size_t bucket_, std::size_t length_ ) { ( void ) bucket_, ( void ) length_; }
+            /// A bucket array of this many bytes could not be allocated (std::bad_alloc follows).
+            virtual void on_allocation_failure( std::size_t bytes_ ) { ( void ) bytes_; }
+    };
+
+} // Namespace ac.
+#endif
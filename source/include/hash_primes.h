@@ -0,0 +1,36 @@
+/*!
+ * @file hash_primes.h
+ * @brief Prime table sizes for the chained tables that do not derive from HashTbl.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _HASH_PRIMES_H_
+#define _HASH_PRIMES_H_
+
+#include <cstddef>          // size_t
+
+namespace ac // Associative container
+{
+    namespace detail
+    {
+        /// Smallest prime greater than n_.
+        inline std::size_t next_prime( std::size_t n_ )
+        {
+            auto is_prime = []( std::size_t p_ ){
+                if ( p_ < 4 )
+                    return p_ > 1;
+                if ( p_ % 2 == 0 or p_ % 3 == 0 )
+                    return false;
+                for ( std::size_t d = 5; d * d <= p_; d += 6 )
+                    if ( p_ % d == 0 or p_ % ( d + 2 ) == 0 )
+                        return false;
+                return true;
+            };
+            while ( not is_prime( ++n_ ) );
+            return n_;
+        }
+    }
+
+} // Namespace ac.
+#endif
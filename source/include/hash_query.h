@@ -0,0 +1,42 @@
+/*!
+ * @file hash_query.h
+ * @brief Batch query operators (join, group-by) over HashTbl.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _HASH_QUERY_H_
+#define _HASH_QUERY_H_
+
+#include <algorithm>        // max, min
+#include <atomic>           // atomic
+#include <functional>       // hash, equal_to
+#include <iterator>         // distance
+#include <numeric>          // partial_sum
+#include <thread>           // thread
+#include <vector>           // vector
+
+#include "hashtbl.h"        // HashTbl
+#include "parallel.h"       // run_parallel
+
+namespace ac // Associative container
+{
+    /// Size of the slice of a bucket array probed by one join partition (about a L2 cache).
+    constexpr std::size_t JOIN_PARTITION_BYTES = 256 * 1024;
+
+    /// Joins a table with a sequence of probe records on the table key.
+    template< class KeyType, class DataType, class KeyHash, class KeyEqual,
+              class Iterator, class KeyOf, class Emit >
+    std::size_t hash_join( const HashTbl< KeyType, DataType, KeyHash, KeyEqual > &,
+                           Iterator, Iterator, KeyOf, Emit, std::size_t n_threads_ = 1 );
+
+    /// Aggregates a sequence of records by a key.
+    template< class GroupKey, class Agg,
+              class GroupHash = std::hash< GroupKey >, class GroupEqual = std::equal_to< GroupKey >,
+              class Iterator, class KeyOf, class Fold, class Merge >
+    HashTbl< GroupKey, Agg, GroupHash, GroupEqual >
+    group_by( Iterator, Iterator, KeyOf, Fold, Merge, std::size_t n_threads_ = 1 );
+
+} // Namespace ac.
+#include "hash_query.inl"
+#endif
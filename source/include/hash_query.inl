@@ -0,0 +1,158 @@
+/*!
+ * @file hash_query.inl
+ * @brief Implementation of the batch query operators.
+ *
+ * @author Lucas Bazante
+ */
+
+#include "hash_query.h"
+
+namespace ac {
+
+    // Joins a table with a sequence of probe records on the table key.
+    /*!
+     * For each probe record whose key is in the table, emit_( probe, data ) is called.
+     *
+     * The probes are first radix-partitioned by the bucket they hash to, so that
+     * each partition only touches a slice of the bucket array small enough to stay
+     * in cache. Partitions are then processed in parallel; emit_ must therefore be
+     * safe to call concurrently when n_threads_ > 1. Each probe key is hashed once.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Iterator A random access iterator over the probe records.
+     * @tparam KeyOf A function that reads a probe record and returns its key.
+     * @tparam Emit A function accepting a probe record and a data item.
+     *
+     * @param build_ The table.
+     * @param first_ Beginning of the probe records.
+     * @param last_ End of the probe records.
+     * @param key_of_ The key of a probe record.
+     * @param emit_ Called for each matching pair.
+     * @param n_threads_ Number of threads.
+     *
+     * @return The number of matches.
+     */
+    template< class KeyType, class DataType, class KeyHash, class KeyEqual,
+              class Iterator, class KeyOf, class Emit >
+    std::size_t hash_join( const HashTbl< KeyType, DataType, KeyHash, KeyEqual > & build_,
+                           Iterator first_, Iterator last_, KeyOf key_of_, Emit emit_, std::size_t n_threads_ )
+    {
+        using table_type = HashTbl< KeyType, DataType, KeyHash, KeyEqual >;
+        using size_type = std::size_t;
+
+        KeyEqual eq;
+        const size_type n_probes = std::distance( first_, last_ );
+        const size_type n_buckets = build_.bucket_count();
+        n_threads_ = std::max< size_type >( 1, n_threads_ );
+
+        size_type n_parts = n_buckets * sizeof( typename table_type::list_type ) / JOIN_PARTITION_BYTES;
+        n_parts = std::min( n_buckets, std::max( n_parts, n_threads_ ) );
+
+        // Hash every probe once.
+        std::vector< size_type > bucket_of( n_probes );
+        detail::run_parallel( n_threads_, [ & ]( size_type t_ ){
+            for ( size_type i = n_probes * t_ / n_threads_; i < n_probes * ( t_ + 1 ) / n_threads_; ++i )
+                bucket_of[ i ] = build_.bucket( key_of_( first_[ i ] ) );
+        } );
+
+        // Partition by contiguous bucket ranges (counting sort).
+        std::vector< size_type > start( n_parts + 1, 0 );
+        for ( auto b : bucket_of )
+            ++start[ b * n_parts / n_buckets + 1 ];
+        std::partial_sum( std::begin( start ), std::end( start ), std::begin( start ) );
+
+        std::vector< size_type > order( n_probes );
+        {
+            std::vector< size_type > next( std::begin( start ), std::end( start ) - 1 );
+            for ( size_type i = 0; i < n_probes; ++i )
+                order[ next[ bucket_of[ i ] * n_parts / n_buckets ]++ ] = i;
+        }
+
+        // Probe, one partition at a time per thread.
+        std::atomic< size_type > next_part{ 0 };
+        std::atomic< size_type > matches{ 0 };
+        detail::run_parallel( n_threads_, [ & ]( size_type ){
+            size_type found = 0;
+            for ( size_type p = next_part++; p < n_parts; p = next_part++ )
+            {
+                for ( size_type k = start[ p ]; k < start[ p + 1 ]; ++k )
+                {
+                    const auto & probe = first_[ order[ k ] ];
+                    const auto & key = key_of_( probe );
+                    const size_type b = bucket_of[ order[ k ] ];
+                    for ( auto it = build_.begin( b ); it != build_.end( b ); ++it )
+                        if ( eq( it->m_key, key ) )
+                        {
+                            emit_( probe, it->m_data );
+                            ++found;
+                            break;
+                        }
+                }
+            }
+            matches += found;
+        } );
+
+        return matches;
+    }
+
+    // Aggregates a sequence of records by a key.
+    /*!
+     * Each thread folds a contiguous chunk of the records into its own partial
+     * table, with fold_( aggregate, record ); the partial tables are then combined
+     * with merge_( aggregate, partial_aggregate ). Aggregates start default-constructed,
+     * which must be the identity of both functions (e.g. zero for a sum).
+     *
+     * @code
+     * auto per_branch = ac::group_by< Account::BranchKey, float, BranchHash >( begin, end,
+     *     []( const Account & a ){ return a.getBranch(); },
+     *     []( float & sum, const Account & a ){ sum += a.m_balance; },
+     *     []( float & sum, float partial ){ sum += partial; }, 8 );
+     * @endcode
+     *
+     * @tparam GroupKey The group key type.
+     * @tparam Agg The aggregate type.
+     * @tparam GroupHash A function that reads a group key and returns an unsigned integer.
+     * @tparam GroupEqual  A function that compares two group keys.
+     * @tparam Iterator A random access iterator over the records.
+     * @tparam KeyOf A function that reads a record and returns its group key.
+     * @tparam Fold A function that accumulates a record into an aggregate.
+     * @tparam Merge A function that accumulates an aggregate into another.
+     *
+     * @param first_ Beginning of the records.
+     * @param last_ End of the records.
+     * @param key_of_ The group key of a record.
+     * @param fold_ Accumulates a record.
+     * @param merge_ Combines partial aggregates.
+     * @param n_threads_ Number of threads.
+     *
+     * @return A table with the aggregate of each group.
+     */
+    template< class GroupKey, class Agg, class GroupHash, class GroupEqual,
+              class Iterator, class KeyOf, class Fold, class Merge >
+    HashTbl< GroupKey, Agg, GroupHash, GroupEqual >
+    group_by( Iterator first_, Iterator last_, KeyOf key_of_, Fold fold_, Merge merge_, std::size_t n_threads_ )
+    {
+        using table_type = HashTbl< GroupKey, Agg, GroupHash, GroupEqual >;
+        using size_type = std::size_t;
+
+        const size_type n_records = std::distance( first_, last_ );
+        n_threads_ = std::max< size_type >( 1, n_threads_ );
+
+        std::vector< table_type > partials( n_threads_ );
+        detail::run_parallel( n_threads_, [ & ]( size_type t_ ){
+            auto & partial = partials[ t_ ];
+            for ( size_type i = n_records * t_ / n_threads_; i < n_records * ( t_ + 1 ) / n_threads_; ++i )
+                fold_( partial[ key_of_( first_[ i ] ) ], first_[ i ] );
+        } );
+
+        table_type result;
+        for ( const auto & partial : partials )
+            partial.for_each( [ & ]( const GroupKey & key_, const Agg & agg_ ){ merge_( result[ key_ ], agg_ ); } );
+
+        return result;
+    }
+
+} // Namespace ac.
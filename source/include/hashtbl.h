@@ -11,37 +11,29 @@
 #include <memory>           // unique_ptr
 #include <iostream>         // cout, endl, ostream
 #include <forward_list>     // forward_list
-#include <algorithm>        // copy, find_if, for_each
+#include <algorithm>        // copy, find_if, for_each, max, sort, unique
+#include <chrono>           // steady_clock
+#include <cstdint>          // uint32_t
 #include <cmath>            // sqrt
 #include <iterator>         // std::begin(), std::end()
 #include <initializer_list>
+#include <numeric>          // partial_sum
+#include <type_traits>      // is_lvalue_reference
 #include <utility>          // std::pair
 #include <vector>           // vector
 
+#include "batch_hash.h"     // hash_batch
+#include "bucket_array.h"   // allocate_array, AllocationPolicy
+#include "counting_filter.h" // CountingFilter
+#include "hash_entry.h"     // HashEntry, HashNode
+#include "hash_mix.h"       // fast_hash_t, fast_equal_t
+#include "hash_observer.h"  // HashTblObserver, AC_PROBE, AC_PROBE_ENABLED
+#include "hash_mutation.h"  // HashMutation
+#include "parallel.h"       // run_parallel
+#include "perfect_hashtbl.h" // PerfectHashTbl
+
 namespace ac // Associative container
 {
-    /*!
-     * Struct representing a hash table element.
-     *
-     * @tparam KeyType The key type.
-     * @tparam DataType The data type.
-     */
-	template<class KeyType, class DataType>
-	struct HashEntry {
-        KeyType m_key;   //! Data key
-        DataType m_data; //! The data
-
-        // Regular constructor.
-        HashEntry( KeyType kt_, DataType dt_ ) : m_key{kt_} , m_data{dt_}
-        {/*Empty*/}
-
-        friend std::ostream & operator<<( std::ostream & os_, const HashEntry & he_ ) {
-            // os_ << "{" << he_.m_key << "," << he_.m_data << "}";
-            os_ << he_.m_data;
-            return os_;
-        }
-    };
-
     /*! 
      * This class implements an STL hash table.
      *
@@ -60,9 +52,12 @@ namespace ac // Associative container
             using entry_type = HashEntry<KeyType,DataType>;
             using list_type = std::forward_list< entry_type >;
             using size_type = std::size_t;
+            using const_local_iterator = typename list_type::const_iterator;
+            using mutation_type = HashMutation<KeyType,DataType>;
+            using node_type = HashNode<KeyType,DataType>;
 
             /// Constructors
-            explicit HashTbl( size_type table_sz_ = DEFAULT_SIZE );
+            explicit HashTbl( size_type table_sz_ = DEFAULT_SIZE, const AllocationPolicy & policy_ = AllocationPolicy{ } );
             HashTbl( const HashTbl& );
             HashTbl( const std::initializer_list< entry_type > & );
             
@@ -76,15 +71,52 @@ namespace ac // Associative container
             /// Class methods
             bool insert( const KeyType &, const DataType &  );
             bool retrieve( const KeyType &, DataType & ) const;
+            template< class Function >
+            bool update( const KeyType &, Function );
+            template< class Make, class Update >
+            bool upsert( const KeyType &, Make, Update );
+            template< class Function >
+            bool compute( const KeyType &, Function );
+            DataType* find( const KeyType & );
+            const DataType* find( const KeyType & ) const;
+            size_type insert_batch( const KeyType *, const DataType *, size_type );
+            size_type find_batch( const KeyType *, size_type, const DataType ** ) const;
             bool erase( const KeyType & );
-            void clear();
+            node_type extract( const KeyType & );
+            bool insert( node_type && );
+            template< class OtherHash, class OtherEqual >
+            size_type merge( HashTbl< KeyType, DataType, OtherHash, OtherEqual > & );
+            void clear( bool release_ = false );
             bool empty() const;
             inline size_type size() const { return m_count; };
             DataType& at( const KeyType& );
             DataType& operator[]( const KeyType& );
             size_type count( const KeyType& ) const;
+            float load_factor() const { return ( float ) m_count / m_size; };
             float max_load_factor() const { return m_max_load_factor; };
             void max_load_factor(float mlf) { m_max_load_factor = mlf; };
+            float min_load_factor() const { return m_min_load_factor; };
+            void min_load_factor(float mlf) { m_min_load_factor = mlf; };
+            inline size_type bucket_count() const { return m_size; };
+            size_type bucket( const KeyType & ) const;
+            const_local_iterator begin( size_type n_ ) const { return m_table[ n_ ].begin(); };
+            const_local_iterator end( size_type n_ ) const { return m_table[ n_ ].end(); };
+            void reserve( size_type );
+            void shrink_to_fit();
+            const AllocationPolicy & allocation_policy() const { return m_policy; };
+            void allocation_policy( const AllocationPolicy & );
+            PagePolicy bucket_pages() const { return m_table.get_deleter().pages(); };
+            HashTblObserver * observer() const { return m_observer; };
+            void observer( HashTblObserver * obs_ ) { m_observer = obs_; };
+            size_type long_chain_threshold() const { return m_long_chain; };
+            void long_chain_threshold( size_type n_ ) { m_long_chain = n_; };
+            bool membership_filter() const { return m_filter != nullptr; };
+            void membership_filter( bool );
+            PerfectHashTbl< KeyType, DataType, KeyHash, KeyEqual > freeze( size_type n_threads_ = 1 ) const;
+            template< class Function >
+            void for_each( Function ) const;
+            template< class Iterator >
+            void apply_batch( Iterator, Iterator, size_type n_threads_ = 1 );
 
             /// Friend functions
             friend std::ostream & operator<<( std::ostream & os_, const HashTbl & ht_ ) {
@@ -107,20 +139,47 @@ namespace ac // Associative container
                 return os_;
             }
 
-        private:
-            /// Private methods
+        protected:
+            /// Internal methods (also used by derived tables)
             static bool is_prime( size_type );
             static size_type find_next_prime( size_type );
+            array_ptr< list_type > allocate( size_type ) const;
+            size_type size_for( size_type, float ) const;
             void rehash( void );
+            void rehash( size_type );
+            void shrink_if_sparse( void );
+            void rebuild_filter( void );
+            void observe_chain( size_type ) const;
+            static void hash_keys( const KeyType *, size_type, std::size_t * );
+            bool adopt( list_type &, typename list_type::const_iterator );
 
-        private:
+        protected:
             size_type m_size;           //!< Table size.
             size_type m_count;          //!< Number of elements in the table.
-            float m_max_load_factor;    //!< Load factor, i.e. ratio between m_count and m_size.
-            std::unique_ptr< std::forward_list< entry_type > [] > m_table;
+            float m_max_load_factor = 1.0f;  //!< Grow when the load factor (m_count / m_size) exceeds this.
+            float m_min_load_factor = 0.25f; //!< Shrink when an erase takes the load factor below this.
+            size_type m_min_size = 0;        //!< Size asked for by the constructor or reserve(); erasures never shrink below it.
+            array_ptr< list_type > m_table;          //!< Bucket array, allocated as m_policy says.
+            AllocationPolicy m_policy;               //!< Pages and prefaulting of the bucket array.
+            std::unique_ptr< CountingFilter > m_filter; //!< Optional filter consulted before the buckets.
+            HashTblObserver * m_observer = nullptr;  //!< Receives the events of this table (not copied).
+            size_type m_long_chain = 8;              //!< Chains longer than this are reported to the observer.
             static const short DEFAULT_SIZE = 11;
+
+            template< class, class, class, class > friend class HashTbl;
     };
 
+    /*!
+     * A HashTbl whose hash and key comparison are chosen from the key type: for
+     * integers, enums and padding-free trivially copyable keys, MixHash and
+     * BitwiseEqual; for any other key, std::hash and std::equal_to.
+     *
+     * HashTbl< int, ... > itself keeps the identity std::hash< int >, whose bucket
+     * of each key is predictable (key % bucket_count()).
+     */
+    template< class KeyType, class DataType >
+    using FastHashTbl = HashTbl< KeyType, DataType, fast_hash_t< KeyType >, fast_equal_t< KeyType > >;
+
 } // MyHashTable
 #include "hashtbl.inl"
 #endif
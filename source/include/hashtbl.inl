@@ -22,13 +22,16 @@ namespace ac {
      * @tparam KeyEqual  A function that compares two keys.
      *
      * @param sz The minimun size of the new table.
+     * @param policy_ How the bucket array is allocated (e.g. on huge pages).
      */
 	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
-	HashTbl<KeyType,DataType,KeyHash,KeyEqual>::HashTbl( size_type sz )
+	HashTbl<KeyType,DataType,KeyHash,KeyEqual>::HashTbl( size_type sz, const AllocationPolicy & policy_ )
+        : m_policy{ policy_ }
 	{
         m_size = find_next_prime( sz );
+        m_min_size = m_size;
         m_count = 0;
-        m_table = std::make_unique< std::forward_list< entry_type > [] >( m_size );
+        m_table = allocate( m_size );
 	}
 
     // Copy constructor.
@@ -46,9 +49,14 @@ namespace ac {
 	HashTbl<KeyType,DataType,KeyHash,KeyEqual>::HashTbl( const HashTbl& source )
 	{
         m_size = source.m_size;
+        m_min_size = source.m_min_size;
         m_count = source.m_count;
         max_load_factor( source.max_load_factor( ) );
-        m_table = std::make_unique< std::forward_list< entry_type > [] >( m_size );
+        min_load_factor( source.min_load_factor( ) );
+        m_policy = source.m_policy;
+        m_table = allocate( m_size );
+        if ( source.m_filter )
+            m_filter = std::make_unique< CountingFilter >( *source.m_filter );
 
         for ( size_type i = 0; i < m_size; ++i )
         {
@@ -75,9 +83,9 @@ namespace ac {
         m_count = 0;
         
         m_table.reset( nullptr ); // if there was already something
-        m_table = std::make_unique< std::forward_list< entry_type> [] >( m_size );
+        m_table = allocate( m_size );
         
-        for ( auto en : ilist )
+        for ( const auto & en : ilist )
             insert( en.m_key, en.m_data );
     }
 
@@ -101,9 +109,13 @@ namespace ac {
     HashTbl<KeyType,DataType,KeyHash,KeyEqual>::operator=( const HashTbl& clone )
     {
         m_size = clone.m_size;
+        m_min_size = clone.m_min_size;
         m_count = clone.m_count;
         max_load_factor( clone.max_load_factor( ) );
-        m_table = std::make_unique< std::forward_list< entry_type > [] >( m_size );
+        min_load_factor( clone.min_load_factor( ) );
+        m_policy = clone.m_policy;
+        m_table = allocate( m_size );
+        m_filter.reset( clone.m_filter ? new CountingFilter( *clone.m_filter ) : nullptr );
 
         for ( size_type i = 0; i < m_size; ++i )
         {
@@ -135,9 +147,11 @@ namespace ac {
         m_count = 0;
 
         m_table.reset( nullptr );
-        m_table = std::make_unique< std::forward_list< entry_type > [] >( m_size );
+        m_table = allocate( m_size );
+        if ( m_filter )
+            rebuild_filter( );
 
-        for ( auto en : ilist )
+        for ( const auto & en : ilist )
             insert( en.m_key, en.m_data );
 
         return *this;
@@ -175,42 +189,281 @@ namespace ac {
     {
         KeyHash hashf;
         KeyEqual eq;
-        auto & which = m_table[ hashf( key_ ) % m_size ];
+        const auto h = hashf( key_ );
+        auto & which = m_table[ h % m_size ];
 
-        auto item = std::find_if( std::begin( which ), std::end( which ), [ & ]( entry_type en ){ return eq( en.m_key, key_ ); } ); 
+        auto item = std::find_if( std::begin( which ), std::end( which ), [ & ]( const entry_type & en ){ return eq( en.m_key, key_ ); } ); 
         if ( item != std::end( which ) )
         {
             item->m_data = new_data_;
             return false;
         }
 
-        entry_type entry( key_, new_data_ );
-        which.push_front( entry );
+        which.emplace_front( key_, new_data_ );
+        if ( m_filter )
+            m_filter->add( h );
+        if ( m_observer or AC_PROBE_ENABLED( long__chain ) )
+            observe_chain( h % m_size );
         
-        max_load_factor( ( float ) ++m_count / m_size );
-
-        if ( max_load_factor( ) > 1.0 )
+        if ( ++m_count > max_load_factor( ) * m_size )
             rehash( );
 
         return true;
     }
 	
+    // Modifies the data associated with a key in place.
+    /*!
+     * Runs fn_( data ) on the stored data, which is neither copied out nor copied
+     * back, with a single hash of the key.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Function A function accepting a DataType &.
+     *
+     * @param key_ Key of the element to modify.
+     * @param fn_ The modification.
+     *
+     * @return True if the key was found (and fn_ called); False otherwise.
+     */
+    template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Function >
+    bool HashTbl<KeyType,DataType,KeyHash,KeyEqual>::update( const KeyType & key_, Function fn_ )
+    {
+        auto data = find( key_ );
+        if ( data == nullptr )
+            return false;
+
+        fn_( *data );
+        return true;
+    }
+
+    // Modifies the data associated with a key in place, inserting it if absent.
+    /*!
+     * If the key is in the table, runs update_fn_( data ) on the stored data;
+     * otherwise inserts the data returned by make_fn_( ). Either way the key is
+     * hashed and its bucket scanned once.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Make A function returning a DataType.
+     * @tparam Update A function accepting a DataType &.
+     *
+     * @param key_ Key of the element.
+     * @param make_fn_ Creates the data of a new element.
+     * @param update_fn_ Modifies the data of an existing element.
+     *
+     * @return True if the element was inserted; False if it was updated.
+     */
+    template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Make, typename Update >
+    bool HashTbl<KeyType,DataType,KeyHash,KeyEqual>::upsert( const KeyType & key_, Make make_fn_, Update update_fn_ )
+    {
+        KeyHash hashf;
+        KeyEqual eq;
+        const auto h = hashf( key_ );
+        auto & which = m_table[ h % m_size ];
+
+        auto item = std::find_if( std::begin( which ), std::end( which ), [ & ]( const entry_type & en ){ return eq( en.m_key, key_ ); } );
+        if ( item != std::end( which ) )
+        {
+            update_fn_( item->m_data );
+            return false;
+        }
+
+        which.emplace_front( key_, make_fn_( ) );
+        if ( m_filter )
+            m_filter->add( h );
+        if ( m_observer or AC_PROBE_ENABLED( long__chain ) )
+            observe_chain( h % m_size );
+
+        if ( ++m_count > max_load_factor( ) * m_size )
+            rehash( );
+
+        return true;
+    }
+
+    // Computes the new state of a key in place.
+    /*!
+     * Calls fn_( data, present ), where data is the stored data if the key is in the
+     * table and a default-constructed DataType otherwise. The key is kept (or
+     * inserted with data) if fn_ returns true and erased (or not inserted) if it
+     * returns false. The key is hashed and its bucket scanned once.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Function A function accepting a DataType & and a bool, and returning a bool.
+     *
+     * @param key_ Key of the element.
+     * @param fn_ The computation.
+     *
+     * @return True if the key is in the table afterwards; False otherwise.
+     */
+    template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Function >
+    bool HashTbl<KeyType,DataType,KeyHash,KeyEqual>::compute( const KeyType & key_, Function fn_ )
+    {
+        KeyHash hashf;
+        KeyEqual eq;
+        const auto h = hashf( key_ );
+        auto & which = m_table[ h % m_size ];
+
+        auto prev = which.before_begin();
+        for ( auto it = std::begin( which ); it != std::end( which ); prev = it++ )
+        {
+            if ( eq( it->m_key, key_ ) )
+            {
+                if ( fn_( it->m_data, true ) )
+                    return true;
+
+                which.erase_after( prev );
+                if ( m_filter )
+                    m_filter->remove( h );
+                --m_count;
+                shrink_if_sparse( );
+                return false;
+            }
+        }
+
+        DataType data{ };
+        if ( not fn_( data, false ) )
+            return false;
+
+        which.emplace_front( key_, std::move( data ) );
+        if ( m_filter )
+            m_filter->add( h );
+        if ( m_observer or AC_PROBE_ENABLED( long__chain ) )
+            observe_chain( h % m_size );
+
+        if ( ++m_count > max_load_factor( ) * m_size )
+            rehash( );
+
+        return true;
+    }
+
     // Clears the data table.
     /*!
      * Erases all memory associated with table collision lists.
+     * The bucket array itself is kept, unless it is asked to be released, in which
+     * case it is replaced by a new array of the default size.
      *
      * @tparam KeyType The key type.
      * @tparam DataType The data type.
      * @tparam KeyHash A function that reads a key and returns an unsigned integer.
      * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param release_ Whether the bucket array should be given back to the allocator.
      */
     template <typename KeyType, typename DataType, typename KeyHash, typename KeyEqual>
-    void HashTbl<KeyType, DataType, KeyHash, KeyEqual>::clear()
+    void HashTbl<KeyType, DataType, KeyHash, KeyEqual>::clear( bool release_ )
     {
         m_count = 0;
+        if ( release_ )
+        {
+            m_table.reset( nullptr );
+            m_size = find_next_prime( DEFAULT_SIZE - 1 );
+            m_min_size = 0;
+            m_table = allocate( m_size );
+            if ( m_filter )
+                rebuild_filter( );
+            return;
+        }
+
         for ( size_type i = 0; i < m_size; i++ )
             if ( not m_table[i].empty( ) )
                 m_table[i].clear( );
+        if ( m_filter )
+            m_filter->clear( );
+    }
+
+    // Prepares the table to hold a number of elements.
+    /*!
+     * Grows the bucket array so that n_ elements fit without exceeding the maximum load factor.
+     * The table never shrinks here, nor, after erasures, below that size.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param n_ Number of elements expected in the table.
+     */
+    template <typename KeyType, typename DataType, typename KeyHash, typename KeyEqual>
+    void HashTbl<KeyType, DataType, KeyHash, KeyEqual>::reserve( size_type n_ )
+    {
+        auto target = size_for( n_, max_load_factor( ) );
+        if ( target > m_size )
+            rehash( target );
+        m_min_size = std::max( m_min_size, target ); // Not if the allocation failed.
+    }
+
+    // Shrinks the bucket array to the size required by the current elements.
+    /*!
+     * Reallocates the bucket array with the smallest size that keeps the load factor
+     * within the maximum, releasing the old array. The size asked for by the
+     * constructor or reserve() is forgotten.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+    template <typename KeyType, typename DataType, typename KeyHash, typename KeyEqual>
+    void HashTbl<KeyType, DataType, KeyHash, KeyEqual>::shrink_to_fit()
+    {
+        auto target = size_for( m_count, max_load_factor( ) );
+        m_min_size = 0;
+        if ( target < m_size )
+            rehash( target );
+    }
+
+    // Changes how the bucket array is allocated.
+    /*!
+     * The bucket array is reallocated at once with the new policy (the elements are
+     * relinked, not copied), and so is every array allocated when the table grows or shrinks.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param policy_ Pages requested and whether to prefault them.
+     */
+    template <typename KeyType, typename DataType, typename KeyHash, typename KeyEqual>
+    void HashTbl<KeyType, DataType, KeyHash, KeyEqual>::allocation_policy( const AllocationPolicy & policy_ )
+    {
+        m_policy = policy_;
+        rehash( m_size );
+    }
+
+    // Enables or disables the membership filter.
+    /*!
+     * The filter is a counting Bloom filter kept in sync with the table, which lets
+     * find() and erase() reject most absent keys after reading a single cache line,
+     * instead of walking a chain. It costs about 4 bytes per bucket.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param enable_ Whether the table should keep a filter.
+     */
+    template <typename KeyType, typename DataType, typename KeyHash, typename KeyEqual>
+    void HashTbl<KeyType, DataType, KeyHash, KeyEqual>::membership_filter( bool enable_ )
+    {
+        if ( not enable_ )
+            m_filter.reset( nullptr );
+        else if ( not m_filter )
+        {
+            m_filter = std::make_unique< CountingFilter >( );
+            rebuild_filter( );
+        }
     }
 
     // Checks if the table has elements.
@@ -247,20 +500,168 @@ namespace ac {
      */
 	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
     bool HashTbl<KeyType, DataType, KeyHash, KeyEqual>::retrieve( const KeyType & key_, DataType & data_item_ ) const
+    {
+        auto data = find( key_ );
+        if ( data != nullptr )
+        {
+            data_item_ = *data;
+            return true;   
+        }
+
+        return false;
+    }
+
+    // Locates the data associated with a key.
+    /*!
+     * Gives direct access to the stored data, without copying it.
+     * The pointer remains valid until the element is erased (rehashing does not move elements).
+     * If the membership filter is enabled, absent keys are usually rejected without touching the buckets.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Data key to search for in the table.
+     *
+     * @return Pointer to the data associated with the key, or nullptr if the key is not in the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    const DataType* HashTbl<KeyType, DataType, KeyHash, KeyEqual>::find( const KeyType & key_ ) const
     {
         KeyHash hashf;
         KeyEqual eq;
-        auto which = m_table[ hashf( key_ ) % m_size ];
-        
-        auto item = std::find_if( std::begin( which ), std::end( which ), [ & ]( entry_type en ){ return eq( en.m_key, key_ ); } );  
-        
-        if ( item != std::end( which ) ) 
+        const auto h = hashf( key_ );
+        if ( m_filter and not m_filter->may_contain( h ) )
+            return nullptr;
+
+        const auto & which = m_table[ h % m_size ];
+
+        auto item = std::find_if( std::begin( which ), std::end( which ), [ & ]( const entry_type & en ){ return eq( en.m_key, key_ ); } );
+        return item == std::end( which ) ? nullptr : &item->m_data;
+    }
+
+    // Locates the data associated with a key.
+    /*!
+     * Non-const version of find().
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Data key to search for in the table.
+     *
+     * @return Pointer to the data associated with the key, or nullptr if the key is not in the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    DataType* HashTbl<KeyType, DataType, KeyHash, KeyEqual>::find( const KeyType & key_ )
+    {
+        return const_cast< DataType* >( static_cast< const HashTbl & >( *this ).find( key_ ) );
+    }
+
+    // Inserts arrays of keys and data.
+    /*!
+     * Equivalent to insert( keys_[ i ], data_[ i ] ) for each i in order, but the
+     * bucket array is grown once, up front, all keys are hashed in one batch (see
+     * hash_batch()), and the buckets are prefetched ahead of the insertions.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param keys_ The keys.
+     * @param data_ The data associated with each key.
+     * @param n_ Number of keys.
+     *
+     * @return The number of keys that were not in the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename HashTbl<KeyType, DataType, KeyHash, KeyEqual>::size_type
+    HashTbl<KeyType, DataType, KeyHash, KeyEqual>::insert_batch( const KeyType * keys_, const DataType * data_, size_type n_ )
+    {
+        KeyEqual eq;
+        std::vector< std::size_t > hashes( n_ );
+        hash_keys( keys_, n_, hashes.data( ) );
+        const auto target = size_for( m_count + n_, max_load_factor( ) );
+        if ( target > m_size )
+            rehash( target );
+
+        const size_type AHEAD = 8; // Buckets prefetched ahead of the one written.
+        size_type inserted = 0;
+        for ( size_type i = 0; i < n_; ++i )
         {
-            data_item_ = item->m_data;
-            return true;   
+            if ( i + AHEAD < n_ )
+                detail::prefetch( &m_table[ hashes[ i + AHEAD ] % m_size ] );
+
+            const auto h = hashes[ i ];
+            auto & which = m_table[ h % m_size ];
+            auto item = std::find_if( std::begin( which ), std::end( which ), [ & ]( const entry_type & en ){ return eq( en.m_key, keys_[ i ] ); } );
+            if ( item != std::end( which ) )
+            {
+                item->m_data = data_[ i ];
+                continue;
+            }
+
+            which.emplace_front( keys_[ i ], data_[ i ] );
+            if ( m_filter )
+                m_filter->add( h );
+            if ( m_observer or AC_PROBE_ENABLED( long__chain ) )
+                observe_chain( h % m_size );
+            ++m_count;
+            ++inserted;
         }
 
-        return false; // This is just a stub. Reaplace it accordinly.
+        return inserted;
+    }
+
+    // Looks up an array of keys.
+    /*!
+     * Equivalent to out_[ i ] = find( keys_[ i ] ) for each i, but all keys are
+     * hashed in one batch (see hash_batch()) and the buckets are prefetched ahead
+     * of the searches.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param keys_ The keys.
+     * @param n_ Number of keys.
+     * @param out_ Array of n_ pointers to be filled in with the data of each key, or nullptr.
+     *
+     * @return The number of keys found.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename HashTbl<KeyType, DataType, KeyHash, KeyEqual>::size_type
+    HashTbl<KeyType, DataType, KeyHash, KeyEqual>::find_batch( const KeyType * keys_, size_type n_, const DataType ** out_ ) const
+    {
+        KeyEqual eq;
+        std::vector< std::size_t > hashes( n_ );
+        hash_keys( keys_, n_, hashes.data( ) );
+
+        const size_type AHEAD = 8; // Buckets prefetched ahead of the one searched.
+        size_type found = 0;
+        for ( size_type i = 0; i < n_; ++i )
+        {
+            if ( i + AHEAD < n_ )
+                detail::prefetch( &m_table[ hashes[ i + AHEAD ] % m_size ] );
+
+            out_[ i ] = nullptr;
+            if ( m_filter and not m_filter->may_contain( hashes[ i ] ) )
+                continue;
+
+            const auto & which = m_table[ hashes[ i ] % m_size ];
+            auto item = std::find_if( std::begin( which ), std::end( which ), [ & ]( const entry_type & en ){ return eq( en.m_key, keys_[ i ] ); } );
+            if ( item != std::end( which ) )
+            {
+                out_[ i ] = &item->m_data;
+                ++found;
+            }
+        }
+
+        return found;
     }
 
     // Rearranges the hash table to match the load factor.
@@ -276,19 +677,231 @@ namespace ac {
     template <typename KeyType, typename DataType, typename KeyHash, typename KeyEqual>
     void HashTbl<KeyType, DataType, KeyHash, KeyEqual>::rehash( void )
     {
-        std::vector< std::forward_list< entry_type > > copy;
+        rehash( find_next_prime( 2 * m_size ) );
+    }
+
+    // Redistributes the elements into a bucket array of the given size.
+    /*!
+     * The list nodes are relinked into the new buckets, so no element is copied
+     * and references to the stored data remain valid. Elements that end up in the
+     * same bucket keep their relative order. The membership filter, if any, is
+     * rebuilt for the new capacity along the way.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param new_size_ The new number of buckets.
+     */
+    template <typename KeyType, typename DataType, typename KeyHash, typename KeyEqual>
+    void HashTbl<KeyType, DataType, KeyHash, KeyEqual>::rehash( size_type new_size_ )
+    {
+        using clock = std::chrono::steady_clock;
+        const auto old_size = m_size;
+        const auto start = m_observer ? clock::now( ) : clock::time_point{ };
+        AC_PROBE3( rehash__start, old_size, new_size_, m_count );
+        if ( m_observer )
+            m_observer->on_rehash_start( { old_size, new_size_, m_count, { } } );
+
+        auto table = allocate( new_size_ );
+        if ( m_filter )
+            m_filter->reset( static_cast< size_type >( max_load_factor( ) * new_size_ ) );
+
+        if constexpr ( has_batch_kernel_v< KeyHash, KeyType > )
+        {
+            // A batch at a time: copy the keys of the next nodes, hash them together,
+            // then move those same nodes while they are still in cache.
+            const size_type BATCH = 256;
+            std::vector< KeyType > keys;
+            std::vector< std::size_t > hashes( BATCH );
+            keys.reserve( BATCH );
+            size_type i = 0;
+            while ( true )
+            {
+                keys.clear( );
+                for ( size_type b = i; b < m_size and keys.size( ) < BATCH; ++b )
+                    for ( auto it = m_table[ b ].begin( ); it != m_table[ b ].end( ) and keys.size( ) < BATCH; ++it )
+                        keys.push_back( it->m_key );
+                if ( keys.empty( ) )
+                    break;
+
+                hash_keys( keys.data( ), keys.size( ), hashes.data( ) );
+                for ( size_type k = 0; k < keys.size( ); ++k )
+                {
+                    while ( m_table[ i ].empty( ) )
+                        ++i;
+                    const auto h = hashes[ k ];
+                    if ( m_filter )
+                        m_filter->add( h );
+                    auto & to = table[ h % new_size_ ];
+                    to.splice_after( to.before_begin( ), m_table[ i ], m_table[ i ].before_begin( ) );
+                }
+            }
+        }
+        else
+        {
+            KeyHash hashf;
+            for ( size_type i = 0; i < m_size; ++i )
+            {
+                auto & from = m_table[ i ];
+                while ( not from.empty( ) )
+                {
+                    const auto h = hashf( from.front( ).m_key );
+                    if ( m_filter )
+                        m_filter->add( h );
+                    auto & to = table[ h % new_size_ ];
+                    to.splice_after( to.before_begin( ), from, from.before_begin( ) );
+                }
+            }
+        }
+
+        // Splicing at the front reversed the lists; restore the original relative order.
+        for ( size_type i = 0; i < new_size_; ++i )
+            table[ i ].reverse( );
+
+        m_table = std::move( table );
+        m_size = new_size_;
+
+        AC_PROBE3( rehash__end, old_size, new_size_, m_count );
+        if ( m_observer )
+            m_observer->on_rehash_end( { old_size, new_size_, m_count, clock::now( ) - start } );
+    }
+
+    // Shrinks the table after erasures.
+    /*!
+     * Shrinks back to a half-full table once the load factor drops below the minimum,
+     * but not below the size asked for by the constructor or reserve().
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+    template <typename KeyType, typename DataType, typename KeyHash, typename KeyEqual>
+    void HashTbl<KeyType, DataType, KeyHash, KeyEqual>::shrink_if_sparse( void )
+    {
+        if ( m_count < min_load_factor( ) * m_size )
+        {
+            auto target = std::max( size_for( m_count, max_load_factor( ) / 2 ), m_min_size );
+            if ( target < m_size )
+                rehash( target );
+        }
+    }
+
+    // Refills the membership filter from the elements in the table.
+    /*!
+     * The filter is sized for a full table, i.e. m_size * max_load_factor() elements.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+    template <typename KeyType, typename DataType, typename KeyHash, typename KeyEqual>
+    void HashTbl<KeyType, DataType, KeyHash, KeyEqual>::rebuild_filter( void )
+    {
+        KeyHash hashf;
+        m_filter->reset( static_cast< size_type >( max_load_factor( ) * m_size ) );
 
         for ( size_type i = 0; i < m_size; ++i )
-            if ( not m_table[i].empty( ) )
-                copy.push_back( m_table[i] );
+            for ( const auto & en : m_table[ i ] )
+                m_filter->add( hashf( en.m_key ) );
+    }
 
-        m_size = find_next_prime( 2 * m_size ), m_count = 0;
-        m_table.reset( nullptr );
-        m_table = std::make_unique< std::forward_list< entry_type > [] >( m_size );
+    // Allocates a bucket array.
+    /*!
+     * The array is aligned to a cache line and, if the allocation policy asks for it,
+     * placed on huge pages (see allocate_array()).
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param n_ Number of buckets.
+     *
+     * @return The array of empty buckets.
+     */
+    template <typename KeyType, typename DataType, typename KeyHash, typename KeyEqual>
+    array_ptr< typename HashTbl<KeyType, DataType, KeyHash, KeyEqual>::list_type >
+    HashTbl<KeyType, DataType, KeyHash, KeyEqual>::allocate( size_type n_ ) const
+    {
+        try
+        {
+            return allocate_array< list_type >( n_, m_policy );
+        }
+        catch ( const std::bad_alloc & )
+        {
+            AC_PROBE1( alloc__fail, n_ * sizeof( list_type ) );
+            if ( m_observer )
+                m_observer->on_allocation_failure( n_ * sizeof( list_type ) );
+            throw;
+        }
+    }
 
-        for ( auto fl : copy )
-            for ( auto en : fl )
-                insert( en.m_key, en.m_data );
+    // Reports the length of a chain that just grew, if above the threshold.
+    /*!
+     * Only called when an observer is attached or the tracepoints are compiled in
+     * (the long__chain probe fires with or without an observer).
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param bucket_ The bucket of the chain.
+     */
+    template <typename KeyType, typename DataType, typename KeyHash, typename KeyEqual>
+    void HashTbl<KeyType, DataType, KeyHash, KeyEqual>::observe_chain( size_type bucket_ ) const
+    {
+        const auto & which = m_table[ bucket_ ];
+        const auto length = static_cast< size_type >( std::distance( std::begin( which ), std::end( which ) ) );
+        if ( length > m_long_chain )
+        {
+            AC_PROBE2( long__chain, bucket_, length );
+            if ( m_observer )
+                m_observer->on_long_chain( bucket_, length );
+        }
+    }
+
+    // Hashes an array of keys.
+    /*!
+     * With hash_batch(), which uses the vector kernels when KeyHash has them.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param keys_ The keys.
+     * @param n_ Number of keys.
+     * @param out_ Array of n_ hashes to be filled in.
+     */
+    template <typename KeyType, typename DataType, typename KeyHash, typename KeyEqual>
+    void HashTbl<KeyType, DataType, KeyHash, KeyEqual>::hash_keys( const KeyType * keys_, size_type n_, std::size_t * out_ )
+    {
+        hash_batch( KeyHash{ }, keys_, n_, out_ );
+    }
+
+    // Computes the number of buckets for a number of elements.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param n_ Number of elements.
+     * @param load_ Desired load factor.
+     *
+     * @return The smallest prime, not less than the default size, that holds n_ elements within the load.
+     */
+    template <typename KeyType, typename DataType, typename KeyHash, typename KeyEqual>
+    typename HashTbl<KeyType, DataType, KeyHash, KeyEqual>::size_type
+    HashTbl<KeyType, DataType, KeyHash, KeyEqual>::size_for( size_type n_, float load_ ) const
+    {
+        auto needed = static_cast< size_type >( std::ceil( n_ / load_ ) );
+        return find_next_prime( std::max< size_type >( needed, DEFAULT_SIZE ) - 1 );
     }
 
     // Erase element from the hash table.
@@ -309,18 +922,180 @@ namespace ac {
     {
         KeyHash hashf;
         KeyEqual eq;
-        auto & which = m_table[ hashf( key_ ) % m_size ];
-        
-        if ( std::find_if( std::begin( which ), std::end( which ), [ & ]( entry_type en ){ return eq( en.m_key, key_ ); } ) != std::end( which ) )
+        const auto h = hashf( key_ );
+        if ( m_filter and not m_filter->may_contain( h ) )
+            return false;
+
+        auto & which = m_table[ h % m_size ];
+
+        // Single walk, remembering the predecessor needed to unlink the element.
+        auto prev = which.before_begin();
+        for ( auto it = std::begin( which ); it != std::end( which ); prev = it++ )
         {
-            which.remove_if( [ & ]( entry_type en ){ return eq( en.m_key, key_ ); } );
-            --m_count;
-            return true;
+            if ( eq( it->m_key, key_ ) )
+            {
+                which.erase_after( prev );
+                if ( m_filter )
+                    m_filter->remove( h );
+                --m_count;
+                shrink_if_sparse( );
+                return true;
+            }
         }
 
         return false;
     }
 
+    // Takes an element out of the hash table.
+    /*!
+     * The element's node is unlinked and handed over as it is: nothing is copied,
+     * moved or freed.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key of element to be taken.
+     *
+     * @return A handle owning the element; an empty handle if the key was not found.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename HashTbl< KeyType, DataType, KeyHash, KeyEqual >::node_type
+    HashTbl< KeyType, DataType, KeyHash, KeyEqual >::extract( const KeyType & key_ )
+    {
+        KeyHash hashf;
+        KeyEqual eq;
+        const auto h = hashf( key_ );
+        node_type node;
+        if ( m_filter and not m_filter->may_contain( h ) )
+            return node;
+
+        auto & which = m_table[ h % m_size ];
+
+        auto prev = which.before_begin();
+        for ( auto it = std::begin( which ); it != std::end( which ); prev = it++ )
+        {
+            if ( eq( it->m_key, key_ ) )
+            {
+                node.m_node.splice_after( node.m_node.before_begin( ), which, prev );
+                if ( m_filter )
+                    m_filter->remove( h );
+                --m_count;
+                shrink_if_sparse( );
+                break;
+            }
+        }
+
+        return node;
+    }
+
+    // Inserts the element owned by a node handle.
+    /*!
+     * The node is linked into its bucket; the key and data are not copied. If the
+     * key already exists, the table is unchanged and the handle keeps the element.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param node_ Handle owning the element (an empty handle inserts nothing).
+     *
+     * @return True if the element was inserted (the handle is left empty); False otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool HashTbl< KeyType, DataType, KeyHash, KeyEqual >::insert( node_type && node_ )
+    {
+        return not node_.empty( ) and adopt( node_.m_node, node_.m_node.before_begin( ) );
+    }
+
+    // Moves into this table the elements of another one whose keys are not here.
+    /*!
+     * The nodes are relinked from one table into the other, without allocating or
+     * copying. Elements whose keys are already in this table stay in the other.
+     * The other table may hash and compare keys differently.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam OtherHash The other table's KeyHash.
+     * @tparam OtherEqual The other table's KeyEqual.
+     *
+     * @param other_ The table to take the elements from.
+     *
+     * @return The number of elements moved.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename OtherHash, typename OtherEqual >
+    typename HashTbl< KeyType, DataType, KeyHash, KeyEqual >::size_type
+    HashTbl< KeyType, DataType, KeyHash, KeyEqual >::merge( HashTbl< KeyType, DataType, OtherHash, OtherEqual > & other_ )
+    {
+        if ( static_cast< const void * >( &other_ ) == this )
+            return 0;
+
+        size_type moved = 0;
+        for ( size_type i = 0; i < other_.m_size; ++i )
+        {
+            auto & from = other_.m_table[ i ];
+            auto prev = from.cbefore_begin( );
+            while ( std::next( prev ) != from.cend( ) )
+            {
+                if ( adopt( from, prev ) )
+                    ++moved;
+                else
+                    ++prev;
+            }
+        }
+
+        if ( moved != 0 )
+        {
+            other_.m_count -= moved;
+            if ( other_.m_filter )
+                other_.rebuild_filter( );
+            other_.shrink_if_sparse( );
+        }
+
+        return moved;
+    }
+
+    // Links into this table a node taken from a list, unless its key is already here.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param from_ The list holding the node.
+     * @param before_ Position before the node in from_.
+     *
+     * @return True if the node was moved; False if it stayed in from_.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool HashTbl< KeyType, DataType, KeyHash, KeyEqual >::adopt( list_type & from_, typename list_type::const_iterator before_ )
+    {
+        KeyHash hashf;
+        KeyEqual eq;
+        const auto & key = std::next( before_ )->m_key;
+        const auto h = hashf( key );
+        auto & which = m_table[ h % m_size ];
+
+        if ( std::any_of( std::begin( which ), std::end( which ), [ & ]( const entry_type & en ){ return eq( en.m_key, key ); } ) )
+            return false;
+
+        which.splice_after( which.before_begin( ), from_, before_ );
+        if ( m_filter )
+            m_filter->add( h );
+        if ( m_observer or AC_PROBE_ENABLED( long__chain ) )
+            observe_chain( h % m_size );
+
+        if ( ++m_count > max_load_factor( ) * m_size )
+            rehash( );
+
+        return true;
+    }
+
     // Check if number is prime.
     /*!
      * This function tests if given number is prime.
@@ -414,15 +1189,11 @@ namespace ac {
 	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
     DataType& HashTbl<KeyType, DataType, KeyHash, KeyEqual>::at( const KeyType & key_ )
     {
-        KeyHash hashf;
-        KeyEqual eq;
-        auto & which = m_table[ hashf( key_ ) % m_size ];
-
-        auto item = std::find_if( std::begin( which ), std::end( which ), [ & ]( entry_type en ){ return eq( en.m_key, key_ ); } );
-        if ( item != which.end() )
-            return item->m_data;
+        auto data = find( key_ );
+        if ( data != nullptr )
+            return *data;
 
-        throw std::out_of_range( "Not present" ); // Stub
+        throw std::out_of_range( "Not present" );
     }
 
     // Accesses the element associated with the key or inserts a new element.
@@ -444,16 +1215,270 @@ namespace ac {
     {
         KeyHash hashf;
         KeyEqual eq;
-        auto & which = m_table[ hashf( key_ ) % m_size ];
+        const auto h = hashf( key_ );
+        auto & which = m_table[ h % m_size ];
  
-        auto item = std::find_if( std::begin( which ), std::end( which ), [ & ]( entry_type en ){ return eq( en.m_key, key_ ); } );
+        auto item = std::find_if( std::begin( which ), std::end( which ), [ & ]( const entry_type & en ){ return eq( en.m_key, key_ ); } );
         if ( item != which.end() )
             return item->m_data;
 
-        ++m_count;
-        max_load_factor( ( float ) m_count / m_size );
-        entry_type entry( key_, DataType{ } ); // a default constructor 
-        which.push_front( entry );
-        return which.front( ).m_data;
+        which.emplace_front( key_, DataType{ } ); // a default constructor
+        if ( m_filter )
+            m_filter->add( h );
+        if ( m_observer or AC_PROBE_ENABLED( long__chain ) )
+            observe_chain( h % m_size );
+        auto & data = which.front( ).m_data;
+
+        // Rehashing relinks the nodes, so the reference stays valid.
+        if ( ++m_count > max_load_factor( ) * m_size )
+            rehash( );
+
+        return data;
+    }
+
+    // Creates a read-only copy of the table with single-probe lookups.
+    /*!
+     * The entries are copied into a PerfectHashTbl, which packs them densely and
+     * replaces the buckets and chains by a minimal perfect hash function.
+     * Later changes to this table are not reflected in the frozen copy.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param n_threads_ Number of threads used to build the perfect hash.
+     *
+     * @return The frozen table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    PerfectHashTbl< KeyType, DataType, KeyHash, KeyEqual >
+    HashTbl<KeyType, DataType, KeyHash, KeyEqual>::freeze( size_type n_threads_ ) const
+    {
+        std::vector< entry_type > entries;
+        entries.reserve( m_count );
+
+        for ( size_type i = 0; i < m_size; ++i )
+            for ( const auto & en : m_table[ i ] )
+                entries.push_back( en );
+
+        return PerfectHashTbl< KeyType, DataType, KeyHash, KeyEqual >( std::move( entries ), n_threads_ );
+    }
+
+    // Visits every element of the table.
+    /*!
+     * Calls fn_( key, data ) for each element, bucket by bucket.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Function A function accepting a key and a data item.
+     *
+     * @param fn_ The function to be called.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Function >
+    void HashTbl<KeyType, DataType, KeyHash, KeyEqual>::for_each( Function fn_ ) const
+    {
+        for ( size_type i = 0; i < m_size; ++i )
+            for ( const auto & en : m_table[ i ] )
+                fn_( en.m_key, en.m_data );
+    }
+
+    // Applies a sequence of mutations to the table.
+    /*!
+     * The result is the same as applying the mutations one at a time, in order, but
+     * the work is organized for throughput:
+     * - every key is hashed up front;
+     * - the bucket array is resized at most once, before anything else (and then
+     *   never shrunk), or shrunk at the end if the batch mostly erased;
+     * - the mutations are partitioned by bucket range, keeping their order, so that
+     *   the slice of the bucket array they touch stays in cache while they are
+     *   applied; partitions are spread over the threads.
+     *
+     * The range must hold mutation_type objects (not temporaries); it is only read.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Iterator A forward iterator over mutation_type.
+     *
+     * @param first_ Start of the mutations.
+     * @param last_ End of the mutations.
+     * @param n_threads_ Number of threads.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Iterator >
+    void HashTbl<KeyType, DataType, KeyHash, KeyEqual>::apply_batch( Iterator first_, Iterator last_, size_type n_threads_ )
+    {
+        static_assert( std::is_lvalue_reference< decltype( *first_ ) >::value, "apply_batch() keeps pointers to the mutations" );
+
+        struct Op {
+            const mutation_type * m_mutation;
+            std::size_t m_hash;
+        };
+
+        std::vector< Op > ops;
+        ops.reserve( std::distance( first_, last_ ) );
+        size_type n_inserts = 0;
+        for ( ; first_ != last_; ++first_ )
+        {
+            ops.push_back( { &*first_, 0 } );
+            n_inserts += first_->m_kind == MutationKind::INSERT;
+        }
+        if ( ops.empty() )
+            return;
+
+        // Room for every insertion, allocated once.
+        const auto target = size_for( m_count + n_inserts, max_load_factor( ) );
+        const bool grown = target > m_size;
+        if ( grown )
+            rehash( target );
+
+        // Hash everything up front, and find the slice of the bucket array
+        // (small enough to stay in cache) each key falls into.
+        const size_type PARTITION_BYTES = 256 * 1024; // About a L2 cache.
+        n_threads_ = std::max< size_type >( 1, std::min( n_threads_, ops.size() ) );
+        const size_type n_parts = std::max( n_threads_, std::min( m_size, m_size * sizeof( list_type ) / PARTITION_BYTES ) );
+        std::vector< std::uint32_t > part_of( ops.size() );
+        detail::run_parallel( n_threads_, [ & ]( size_type t_ ){
+            const size_type first = ops.size() * t_ / n_threads_, last = ops.size() * ( t_ + 1 ) / n_threads_;
+            if constexpr ( has_batch_kernel_v< KeyHash, KeyType > )
+            {
+                // The keys are scattered over the mutations: gather them, a batch at a time.
+                const size_type BATCH = 256;
+                std::vector< KeyType > keys;
+                std::vector< std::size_t > hashes( BATCH );
+                keys.reserve( BATCH );
+                for ( size_type i = first; i < last; i += keys.size() )
+                {
+                    keys.clear();
+                    for ( size_type j = i; j < last and keys.size() < BATCH; ++j )
+                        keys.push_back( ops[ j ].m_mutation->m_key );
+                    hash_keys( keys.data(), keys.size(), hashes.data() );
+                    for ( size_type j = 0; j < keys.size(); ++j )
+                        ops[ i + j ].m_hash = hashes[ j ];
+                }
+            }
+            else
+            {
+                KeyHash hashf;
+                for ( size_type i = first; i < last; ++i )
+                    ops[ i ].m_hash = hashf( ops[ i ].m_mutation->m_key );
+            }
+            for ( size_type i = first; i < last; ++i )
+                part_of[ i ] = ( ops[ i ].m_hash % m_size ) * n_parts / m_size;
+        } );
+
+        // Group the mutations by slice, keeping their order (counting sort).
+        std::vector< size_type > offset( n_parts + 1, 0 );
+        for ( auto p : part_of )
+            ++offset[ p + 1 ];
+        std::partial_sum( std::begin( offset ), std::end( offset ), std::begin( offset ) );
+        std::vector< Op > sorted;
+        if ( n_parts == 1 )
+            sorted = std::move( ops );
+        else
+        {
+            sorted.resize( ops.size() );
+            auto next = offset;
+            for ( size_type i = 0; i < ops.size(); ++i )
+                sorted[ next[ part_of[ i ] ]++ ] = ops[ i ];
+        }
+
+        // Each thread applies a contiguous range of partitions, i.e. of buckets.
+        n_threads_ = std::min( n_threads_, n_parts );
+        std::vector< long > delta( n_threads_, 0 );
+        std::vector< std::vector< std::size_t > > added( n_threads_ ), removed( n_threads_ );
+        detail::run_parallel( n_threads_, [ & ]( size_type t_ ){
+            KeyEqual eq;
+            const size_type first = offset[ n_parts * t_ / n_threads_ ];
+            const size_type last = offset[ n_parts * ( t_ + 1 ) / n_threads_ ];
+            const size_type AHEAD = 8; // Mutations prefetched ahead of the one applied.
+
+            for ( size_type i = first; i < last; ++i )
+            {
+                if ( i + AHEAD < last )
+                    detail::prefetch( sorted[ i + AHEAD ].m_mutation );
+
+                const auto & op = sorted[ i ];
+                const auto & mutation = *op.m_mutation;
+                auto & which = m_table[ op.m_hash % m_size ];
+
+                auto prev = which.before_begin();
+                auto it = std::begin( which );
+                while ( it != std::end( which ) and not eq( it->m_key, mutation.m_key ) )
+                    prev = it++;
+
+                if ( it != std::end( which ) )
+                {
+                    if ( mutation.m_kind != MutationKind::ERASE )
+                        it->m_data = mutation.m_data;
+                    else
+                    {
+                        which.erase_after( prev );
+                        removed[ t_ ].push_back( op.m_hash );
+                        --delta[ t_ ];
+                    }
+                }
+                else if ( mutation.m_kind == MutationKind::INSERT )
+                {
+                    which.emplace_front( mutation.m_key, mutation.m_data );
+                    added[ t_ ].push_back( op.m_hash );
+                    ++delta[ t_ ];
+                }
+            }
+        } );
+
+        for ( size_type t = 0; t < n_threads_; ++t )
+        {
+            m_count += delta[ t ];
+            if ( m_filter )
+            {
+                for ( auto h : added[ t ] )
+                    m_filter->add( h );
+                for ( auto h : removed[ t ] )
+                    m_filter->remove( h );
+            }
+        }
+
+        // Chains are measured once the batch is in, once per bucket it grew.
+        if ( m_observer or AC_PROBE_ENABLED( long__chain ) )
+        {
+            std::vector< size_type > grew;
+            for ( const auto & hashes : added )
+                for ( auto h : hashes )
+                    grew.push_back( h % m_size );
+            std::sort( std::begin( grew ), std::end( grew ) );
+            grew.erase( std::unique( std::begin( grew ), std::end( grew ) ), std::end( grew ) );
+            for ( auto bucket : grew )
+                observe_chain( bucket );
+        }
+
+        if ( not grown )
+            shrink_if_sparse( );
+    }
+
+    // Bucket of a key.
+    /*!
+     * The elements of a bucket may be visited with begin( n ) and end( n ).
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ The key.
+     *
+     * @return Index of the bucket where the key is (or would be) stored.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename HashTbl< KeyType, DataType, KeyHash, KeyEqual >::size_type
+    HashTbl< KeyType, DataType, KeyHash, KeyEqual >::bucket( const KeyType & key_ ) const
+    {
+        KeyHash hashf;
+        return hashf( key_ ) % m_size;
     }
 } // Namespace ac.
@@ -0,0 +1,119 @@
+/*!
+ * @file indexed_hashtbl.h
+ * @brief Hash table with secondary (non-unique) hash indexes.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _INDEXED_HASHTBL_H_
+#define _INDEXED_HASHTBL_H_
+
+#include <functional>       // function, hash, equal_to
+#include <memory>           // unique_ptr
+#include <vector>           // vector
+
+#include "hashtbl.h"        // HashTbl
+
+namespace ac // Associative container
+{
+    /*!
+     * This class implements a hash table whose data can also be searched by
+     * secondary keys extracted from the data itself (e.g. the branch of an account).
+     *
+     * Each secondary index is a HashTbl from the secondary key to the list of
+     * data items having that key. The lists hold pointers to the data stored in
+     * the primary table, which never moves (rehashing relinks nodes), so nothing
+     * is copied. All indexes are updated by insert() and erase(); an update that
+     * keeps the secondary key of the data does not touch that index, and removing
+     * an item from a list takes O(1), as each index knows where its items are.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< class KeyType,
+		      class DataType,
+		      class KeyHash = std::hash< KeyType >,
+		      class KeyEqual = std::equal_to< KeyType > >
+	class IndexedHashTbl {
+        private:
+            /// What the table needs from an index.
+            struct IndexBase {
+                virtual ~IndexBase( ) = default;
+                virtual void add( const DataType & ) = 0;
+                virtual void replace( const DataType &, const DataType & ) = 0;
+                virtual void remove( const DataType & ) = 0;
+                virtual void clear( ) = 0;
+            };
+
+        public:
+            // Aliases
+            using size_type = std::size_t;
+            using result_type = std::vector< const DataType * >;
+
+            /*!
+             * A secondary index.
+             *
+             * @tparam IndexKey The secondary key type.
+             * @tparam IndexHash A function that reads a secondary key and returns an unsigned integer.
+             * @tparam IndexEqual  A function that compares two secondary keys.
+             */
+            template< class IndexKey,
+                      class IndexHash = std::hash< IndexKey >,
+                      class IndexEqual = std::equal_to< IndexKey > >
+            class Index : public IndexBase {
+                public:
+                    using extractor_type = std::function< IndexKey( const DataType & ) >;
+
+                    explicit Index( extractor_type extract_ ) : m_extract( extract_ ) {/*Empty*/}
+
+                    /// Data items having the given secondary key.
+                    const result_type & lookup( const IndexKey & key_ ) const
+                    {
+                        static const result_type none;
+                        auto items = m_postings.find( key_ );
+                        return items == nullptr ? none : *items;
+                    }
+                    /// Number of data items having the given secondary key.
+                    size_type count( const IndexKey & key_ ) const { return lookup( key_ ).size(); }
+
+                private:
+                    void add( const DataType & data_ ) override;
+                    void replace( const DataType & data_, const DataType & new_data_ ) override;
+                    void remove( const DataType & data_ ) override;
+                    void clear( ) override { m_postings.clear( ); m_positions.clear( ); }
+                    void unlink( const IndexKey & key_, const DataType & data_ );
+
+                    extractor_type m_extract;                                          //!< Computes the secondary key.
+                    HashTbl< IndexKey, result_type, IndexHash, IndexEqual > m_postings; //!< Secondary key to data items.
+                    HashTbl< const DataType *, size_type > m_positions;                 //!< Position of each data item in its list.
+            };
+
+            /// Constructors
+            explicit IndexedHashTbl( size_type table_sz_ = 11 ) : m_primary( table_sz_ ) {/*Empty*/}
+            IndexedHashTbl( const IndexedHashTbl & ) = delete;
+            IndexedHashTbl & operator=( const IndexedHashTbl & ) = delete;
+
+            /// Class methods
+            template< class IndexKey,
+                      class IndexHash = std::hash< IndexKey >,
+                      class IndexEqual = std::equal_to< IndexKey > >
+            const Index< IndexKey, IndexHash, IndexEqual > & add_index( typename Index< IndexKey, IndexHash, IndexEqual >::extractor_type );
+
+            bool insert( const KeyType &, const DataType & );
+            bool retrieve( const KeyType & key_, DataType & data_item_ ) const { return m_primary.retrieve( key_, data_item_ ); };
+            const DataType* find( const KeyType & key_ ) const { return m_primary.find( key_ ); };
+            bool erase( const KeyType & );
+            void clear();
+            bool empty() const { return m_primary.empty(); };
+            size_type size() const { return m_primary.size(); };
+
+        private:
+            HashTbl< KeyType, DataType, KeyHash, KeyEqual > m_primary; //!< The data.
+            std::vector< std::unique_ptr< IndexBase > > m_indexes;      //!< Secondary indexes.
+    };
+
+} // Namespace ac.
+#include "indexed_hashtbl.inl"
+#endif
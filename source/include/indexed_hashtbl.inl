@@ -0,0 +1,200 @@
+/*!
+ * @file indexed_hashtbl.inl
+ * @brief Implementation of the IndexedHashTbl class methods.
+ *
+ * @author Lucas Bazante
+ */
+
+#include "indexed_hashtbl.h"
+
+namespace ac {
+
+    /// CLASS METHODS
+
+    // Creates a secondary index.
+    /*!
+     * The index is built over the data already in the table and kept up to date afterwards.
+     *
+     * @code
+     * auto & by_branch = accounts.add_index< Account::BranchKey, BranchHash >( &Account::getBranch );
+     * for ( auto acct : by_branch.lookup( { 1, 1668 } ) ) ...
+     * @endcode
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam IndexKey The secondary key type.
+     * @tparam IndexHash A function that reads a secondary key and returns an unsigned integer.
+     * @tparam IndexEqual  A function that compares two secondary keys.
+     *
+     * @param extract_ Function computing the secondary key of a data item.
+     *
+     * @return The index, which lives as long as the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename IndexKey, typename IndexHash, typename IndexEqual >
+    const typename IndexedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::template Index< IndexKey, IndexHash, IndexEqual > &
+    IndexedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::add_index( typename Index< IndexKey, IndexHash, IndexEqual >::extractor_type extract_ )
+    {
+        auto index = std::make_unique< Index< IndexKey, IndexHash, IndexEqual > >( extract_ );
+        auto & ref = *index;
+        IndexBase & base = ref;
+
+        m_primary.for_each( [ & ]( const KeyType &, const DataType & data_ ){ base.add( data_ ); } );
+
+        m_indexes.push_back( std::move( index ) );
+        return ref;
+    }
+
+    // Inserts data into the table according to the associated key.
+    /*!
+     * Inserts the new entry if the key does not exist and updates the data otherwise,
+     * moving it between index lists when its secondary keys change.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key associated with data.
+     * @param new_data_ New data to be inserted/updated.
+     *
+     * @return True if the insertion was successful; False if the key already existed.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool IndexedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::insert( const KeyType & key_, const DataType & new_data_ )
+    {
+        auto before = m_primary.size();
+        auto & data = m_primary[ key_ ];
+        bool fresh = m_primary.size() != before;
+
+        if ( not fresh )
+            for ( auto & index : m_indexes )
+                index->replace( data, new_data_ );
+
+        data = new_data_;
+        if ( fresh )
+            for ( auto & index : m_indexes )
+                index->add( data );
+
+        return fresh;
+    }
+
+    // Erase element from the table.
+    /*!
+     * The element is removed from every index as well.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key of element to be removed.
+     *
+     * @return True if the key was found; False otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool IndexedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::erase( const KeyType & key_ )
+    {
+        auto data = m_primary.find( key_ );
+        if ( data == nullptr )
+            return false;
+
+        for ( auto & index : m_indexes )
+            index->remove( *data );
+
+        return m_primary.erase( key_ );
+    }
+
+    // Clears the table.
+    /*!
+     * The indexes are kept, empty.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void IndexedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::clear()
+    {
+        for ( auto & index : m_indexes )
+            index->clear( );
+        m_primary.clear( );
+    }
+
+    /// INDEX METHODS
+
+    // Adds a data item to an index.
+    /*!
+     * @param data_ The data item, as stored in the primary table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename IndexKey, typename IndexHash, typename IndexEqual >
+    void IndexedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::Index<IndexKey,IndexHash,IndexEqual>::add( const DataType & data_ )
+    {
+        auto & items = m_postings[ m_extract( data_ ) ];
+        m_positions.insert( &data_, items.size( ) );
+        items.push_back( &data_ );
+    }
+
+    // Moves a data item to the list of its new secondary key, if that changes.
+    /*!
+     * Called before the stored data is overwritten.
+     *
+     * @param data_ The data item, as stored in the primary table.
+     * @param new_data_ The data about to be stored in its place.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename IndexKey, typename IndexHash, typename IndexEqual >
+    void IndexedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::Index<IndexKey,IndexHash,IndexEqual>::replace( const DataType & data_, const DataType & new_data_ )
+    {
+        auto key = m_extract( data_ );
+        auto new_key = m_extract( new_data_ );
+        if ( IndexEqual{ }( key, new_key ) )
+            return;
+
+        unlink( key, data_ );
+        auto & items = m_postings[ new_key ];
+        m_positions.insert( &data_, items.size( ) );
+        items.push_back( &data_ );
+    }
+
+    // Removes a data item from an index.
+    /*!
+     * @param data_ The data item, as stored in the primary table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename IndexKey, typename IndexHash, typename IndexEqual >
+    void IndexedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::Index<IndexKey,IndexHash,IndexEqual>::remove( const DataType & data_ )
+    {
+        unlink( m_extract( data_ ), data_ );
+    }
+
+    // Takes a data item out of the list of a secondary key.
+    /*!
+     * The item is swapped with the last one of its list, so the order of a list is not preserved.
+     *
+     * @param key_ The secondary key of the data item.
+     * @param data_ The data item, as stored in the primary table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename IndexKey, typename IndexHash, typename IndexEqual >
+    void IndexedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::Index<IndexKey,IndexHash,IndexEqual>::unlink( const IndexKey & key_, const DataType & data_ )
+    {
+        auto items = m_postings.find( key_ );
+        auto pos = m_positions.find( &data_ );
+        if ( items == nullptr or pos == nullptr )
+            return;
+
+        const DataType * last = items->back( );
+        ( *items )[ *pos ] = last;
+        m_positions[ last ] = *pos;
+        items->pop_back( );
+        m_positions.erase( &data_ );
+        if ( items->empty() )
+            m_postings.erase( key_ );
+    }
+
+} // Namespace ac.
@@ -0,0 +1,91 @@
+/*!
+ * @file lru_cache.h
+ * @brief Bounded cache with least-recently-used eviction, indexed by a HashTbl.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _LRU_CACHE_H_
+#define _LRU_CACHE_H_
+
+#include <functional>       // function, hash, equal_to
+#include <iostream>         // ostream
+#include <list>             // list
+
+#include "hashtbl.h"        // HashTbl
+
+namespace ac // Associative container
+{
+    /*!
+     * This class implements a cache that holds at most a given number of entries
+     * and, optionally, at most a given number of bytes.
+     *
+     * Entries are kept in a list ordered by recency (most recent first) and a
+     * HashTbl maps each key to its position in that list. A hit is a single hash
+     * lookup followed by relinking the list node to the front; when a budget is
+     * exceeded the entries at the back of the list are evicted. An entry that
+     * alone exceeds the byte budget is refused rather than cached and evicted.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< class KeyType,
+		      class DataType,
+		      class KeyHash = std::hash< KeyType >,
+		      class KeyEqual = std::equal_to< KeyType > >
+	class LruCache {
+        public:
+            // Aliases
+            using entry_type = HashEntry<KeyType,DataType>;
+            using list_type = std::list< entry_type >;
+            using size_type = std::size_t;
+            using sizer_type = std::function< size_type( const entry_type & ) >;
+
+            /// Cache activity counters.
+            struct Stats {
+                size_type m_hits = 0;      //!< Lookups that found the key.
+                size_type m_misses = 0;    //!< Lookups that did not find the key.
+                size_type m_evictions = 0; //!< Entries removed to respect the budgets.
+            };
+
+            /// Constructors
+            explicit LruCache( size_type max_entries_, size_type max_bytes_ = 0, sizer_type sizer_ = nullptr );
+
+            /// Class methods
+            bool insert( const KeyType &, const DataType & );
+            bool retrieve( const KeyType &, DataType & );
+            bool erase( const KeyType & );
+            void clear();
+            bool empty() const { return m_items.empty(); };
+            size_type size() const { return m_items.size(); };
+            size_type bytes() const { return m_bytes; };
+            size_type max_entries() const { return m_max_entries; };
+            size_type max_bytes() const { return m_max_bytes; };
+            const Stats & stats() const { return m_stats; };
+
+            /// Friend functions
+            friend std::ostream & operator<<( std::ostream & os_, const LruCache & c_ ) {
+                for ( const auto & en : c_.m_items )
+                    os_ << en << "\n";
+                return os_;
+            }
+
+        private:
+            /// Private methods
+            void evict( void );
+
+        private:
+            HashTbl< KeyType, typename list_type::iterator, KeyHash, KeyEqual > m_index; //!< Key to list position.
+            list_type m_items;         //!< Entries, most recently used first.
+            size_type m_max_entries;   //!< Entry budget.
+            size_type m_max_bytes;     //!< Byte budget (0 means unlimited).
+            size_type m_bytes;         //!< Bytes currently accounted for.
+            sizer_type m_sizer;        //!< Number of bytes charged for an entry.
+            Stats m_stats;             //!< Activity counters.
+    };
+
+} // Namespace ac.
+#include "lru_cache.inl"
+#endif
@@ -0,0 +1,206 @@
+/*!
+ * @file lru_cache.inl
+ * @brief Implementation of the LruCache class methods.
+ *
+ * @author Lucas Bazante
+ */
+
+#include "lru_cache.h"
+
+namespace ac {
+
+    /// CONSTRUCTORS
+
+    // Budget constructor.
+    /*!
+     * This constructor creates an empty cache with the given budgets.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param max_entries_ Maximum number of entries.
+     * @param max_bytes_ Maximum number of bytes, as measured by the sizer (0 means unlimited).
+     * @param sizer_ Bytes charged for an entry; sizeof( entry_type ) if not provided.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+	LruCache<KeyType,DataType,KeyHash,KeyEqual>::LruCache( size_type max_entries_, size_type max_bytes_, sizer_type sizer_ )
+        : m_index( max_entries_ )
+        , m_max_entries( max_entries_ )
+        , m_max_bytes( max_bytes_ )
+        , m_bytes( 0 )
+        , m_sizer( sizer_ )
+	{
+        if ( not m_sizer )
+            m_sizer = []( const entry_type & ){ return sizeof( entry_type ); };
+	}
+
+    /// CLASS METHODS
+
+    // Inserts data into the cache according to the associated key.
+    /*!
+     * Inserts the new entry if the key does not exist and updates the data otherwise.
+     * Either way the entry becomes the most recently used, and older entries are
+     * evicted until the cache is within its budgets.
+     *
+     * An item charged more bytes than the whole byte budget is not cached: insert
+     * returns false, and an older entry with the same key is erased, so that it is
+     * not served in place of the new data. If copying the data, the sizer or the
+     * index throws, the cache is left unchanged.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key associated with data.
+     * @param new_data_ New data to be inserted/updated.
+     *
+     * @return True if the insertion was successful; False if the key already existed or the item was too large.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool LruCache<KeyType,DataType,KeyHash,KeyEqual>::insert( const KeyType & key_, const DataType & new_data_ )
+    {
+        // The new entry is built first, so that nothing refers to it if that throws.
+        m_items.emplace_front( key_, new_data_ );
+        const auto item = m_items.begin();
+        size_type bytes = 0, old_bytes = 0;
+        typename list_type::iterator old;
+        bool fresh;
+        try
+        {
+            bytes = m_sizer( *item );
+            if ( m_max_bytes != 0 and bytes > m_max_bytes )
+            {
+                m_items.pop_front();
+                erase( key_ );
+                return false;
+            }
+
+            // A single lookup: the key is added, or its position replaced.
+            fresh = m_index.upsert( key_, [ & ]{ return item; },
+                                    [ & ]( typename list_type::iterator & pos_ ){
+                                        old_bytes = m_sizer( *pos_ );
+                                        old = pos_;
+                                        pos_ = item;
+                                    } );
+        }
+        catch ( ... )
+        {
+            // A rehash after the key was added may throw too: drop its position.
+            typename list_type::iterator pos;
+            if ( m_index.retrieve( key_, pos ) and pos == item )
+                m_index.erase( key_ );
+            m_items.erase( item );
+            throw;
+        }
+
+        if ( not fresh )
+        {
+            m_bytes -= old_bytes;
+            m_items.erase( old );
+        }
+        m_bytes += bytes;
+
+        evict( );
+        return fresh;
+    }
+
+    // Retrieves data from the cache.
+    /*!
+     * Retrieves a data item from the cache and marks it as the most recently used.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Data key to search for in the cache.
+     * @param data_item_ Data record to be filled in when data item is found.
+     *
+     * @return True if the data item is found; False, otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool LruCache<KeyType,DataType,KeyHash,KeyEqual>::retrieve( const KeyType & key_, DataType & data_item_ )
+    {
+        typename list_type::iterator pos;
+        if ( not m_index.retrieve( key_, pos ) )
+        {
+            ++m_stats.m_misses;
+            return false;
+        }
+
+        ++m_stats.m_hits;
+        m_items.splice( m_items.begin(), m_items, pos );
+        data_item_ = pos->m_data;
+        return true;
+    }
+
+    // Erase element from the cache.
+    /*!
+     * Explicit removals are not counted as evictions.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key of element to be removed.
+     *
+     * @return True if the key was found; False otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool LruCache<KeyType,DataType,KeyHash,KeyEqual>::erase( const KeyType & key_ )
+    {
+        typename list_type::iterator pos;
+        if ( not m_index.retrieve( key_, pos ) )
+            return false;
+
+        m_bytes -= m_sizer( *pos );
+        m_items.erase( pos );
+        m_index.erase( key_ );
+        return true;
+    }
+
+    // Clears the cache.
+    /*!
+     * Removes every entry; the counters are kept.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void LruCache<KeyType,DataType,KeyHash,KeyEqual>::clear()
+    {
+        m_index.clear( );
+        m_items.clear( );
+        m_bytes = 0;
+    }
+
+    // Evicts the least recently used entries.
+    /*!
+     * Removes entries from the back of the recency list until both budgets are met.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void LruCache<KeyType,DataType,KeyHash,KeyEqual>::evict( void )
+    {
+        while ( not m_items.empty() and
+                ( m_items.size() > m_max_entries or ( m_max_bytes != 0 and m_bytes > m_max_bytes ) ) )
+        {
+            auto & victim = m_items.back();
+            m_bytes -= m_sizer( victim );
+            m_index.erase( victim.m_key );
+            m_items.pop_back();
+            ++m_stats.m_evictions;
+        }
+    }
+
+} // Namespace ac.
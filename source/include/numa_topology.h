@@ -0,0 +1,206 @@
+/*!
+ * @file numa_topology.h
+ * @brief NUMA nodes of the host (or an emulation of them) and memory placement.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _NUMA_TOPOLOGY_H_
+#define _NUMA_TOPOLOGY_H_
+
+#include <algorithm>        // max
+#include <cstdint>          // uintptr_t
+#include <fstream>          // ifstream
+#include <functional>       // function
+#include <sstream>          // istringstream
+#include <string>           // string, to_string
+#include <thread>           // thread
+#include <vector>           // vector
+
+#if defined( __linux__ )
+#include <pthread.h>        // pthread_setaffinity_np
+#include <sched.h>          // sched_getcpu, cpu_set_t
+#include <sys/syscall.h>    // SYS_mbind
+#include <unistd.h>         // syscall, sysconf
+#endif
+
+namespace ac // Associative container
+{
+    /// How memory is spread over the nodes.
+    enum class NumaPolicy {
+        LOCAL,      //!< The node of the thread that first touches a page (the kernel default).
+        INTERLEAVE, //!< Pages round-robin over all the nodes.
+        BIND        //!< Pages on a given node.
+    };
+
+    /*!
+     * This class describes the NUMA nodes and the CPUs of each one.
+     *
+     * detect() reads the layout of the host from sysfs; emulated() spreads the
+     * online CPUs over a given number of nodes, so that code placing data per node
+     * can be exercised on a single-node machine (CPUs are shared by several nodes
+     * if there are fewer CPUs than nodes). Memory placement requests are ignored
+     * for emulated topologies.
+     */
+    class NumaTopology {
+        public:
+            // Aliases
+            using size_type = std::size_t;
+
+            /// Constructors
+
+            /// The nodes of this host (a single node if they cannot be read).
+            static NumaTopology detect( )
+            {
+                NumaTopology topo;
+                for ( size_type node = 0; ; ++node )
+                {
+                    std::ifstream list( "/sys/devices/system/node/node" + std::to_string( node ) + "/cpulist" );
+                    if ( not list )
+                        break;
+                    std::string text;
+                    std::getline( list, text );
+                    topo.m_cpus.push_back( parse_cpulist( text ) );
+                }
+
+                if ( topo.m_cpus.empty() )
+                    topo = emulated( 1 );
+                topo.m_emulated = false;
+                topo.index_cpus( );
+                return topo;
+            }
+
+            /// n_nodes_ nodes sharing the online CPUs round-robin.
+            static NumaTopology emulated( size_type n_nodes_ )
+            {
+                NumaTopology topo;
+                topo.m_emulated = true;
+                topo.m_cpus.resize( std::max< size_type >( 1, n_nodes_ ) );
+
+                const size_type n_cpus = online_cpus( );
+                for ( size_type i = 0; i < std::max( n_cpus, topo.m_cpus.size() ); ++i )
+                    topo.m_cpus[ i % topo.m_cpus.size() ].push_back( int( i % n_cpus ) );
+                topo.index_cpus( );
+                return topo;
+            }
+
+            /// Class methods
+            size_type nodes( ) const { return m_cpus.size(); };
+            bool emulated( ) const { return m_emulated; };
+            const std::vector< int > & cpus( size_type node_ ) const { return m_cpus[ node_ ]; };
+
+            /// Node of a CPU (the first one listing it), or 0 if unknown.
+            size_type node_of_cpu( int cpu_ ) const
+            {
+                return cpu_ >= 0 and size_type( cpu_ ) < m_node_of.size() ? m_node_of[ cpu_ ] : 0;
+            }
+
+            /// Node of the CPU running the calling thread.
+            size_type current_node( ) const
+            {
+#if defined( __linux__ )
+                if ( m_cpus.size() > 1 )
+                    return node_of_cpu( sched_getcpu( ) ); // Cheap (vDSO).
+#endif
+                return 0;
+            }
+
+            /// Starts a thread pinned to the CPUs of a node, running fn_.
+            std::thread start_on_node( size_type node_, std::function< void( ) > fn_ ) const
+            {
+                return std::thread( [ this, node_, fn = std::move( fn_ ) ]{
+#if defined( __linux__ )
+                    cpu_set_t set;
+                    CPU_ZERO( &set );
+                    for ( int cpu : m_cpus[ node_ ] )
+                        CPU_SET( cpu, &set );
+                    pthread_setaffinity_np( pthread_self(), sizeof set, &set ); // Best effort.
+#endif
+                    fn( );
+                } );
+            }
+
+            /// Runs fn_ in a thread pinned to the CPUs of a node, and waits for it.
+            void run_on_node( size_type node_, std::function< void( ) > fn_ ) const
+            {
+                start_on_node( node_, std::move( fn_ ) ).join( );
+            }
+
+            /// Applies a placement policy to the whole pages of [addr_, addr_ + bytes_).
+            /// Pages already touched are migrated. Returns false if nothing was done.
+            bool place( const void * addr_, size_type bytes_, NumaPolicy policy_, size_type node_ = 0 ) const
+            {
+#if defined( __linux__ ) and defined( SYS_mbind )
+                if ( m_emulated or m_cpus.size() < 2 or policy_ == NumaPolicy::LOCAL )
+                    return false;
+
+                const std::uintptr_t page = sysconf( _SC_PAGESIZE );
+                std::uintptr_t first = ( reinterpret_cast< std::uintptr_t >( addr_ ) + page - 1 ) / page * page;
+                std::uintptr_t last = ( reinterpret_cast< std::uintptr_t >( addr_ ) + bytes_ ) / page * page;
+                if ( first >= last )
+                    return false;
+
+                const int MPOL_BIND_ = 2, MPOL_INTERLEAVE_ = 3, MPOL_MF_MOVE_ = 1 << 1;
+                unsigned long mask = 0;
+                if ( policy_ == NumaPolicy::INTERLEAVE )
+                    mask = m_cpus.size() >= 64 ? ~0ul : ( 1ul << m_cpus.size() ) - 1;
+                else
+                    mask = 1ul << node_;
+                return syscall( SYS_mbind, first, last - first, policy_ == NumaPolicy::INTERLEAVE ? MPOL_INTERLEAVE_ : MPOL_BIND_,
+                                &mask, sizeof mask * 8, MPOL_MF_MOVE_ ) == 0;
+#else
+                ( void ) addr_, ( void ) bytes_, ( void ) policy_, ( void ) node_;
+                return false;
+#endif
+            }
+
+        private:
+            /// Parses a sysfs CPU list such as "0-3,8-11".
+            static std::vector< int > parse_cpulist( const std::string & text_ )
+            {
+                std::vector< int > cpus;
+                std::istringstream in( text_ );
+                std::string range;
+                while ( std::getline( in, range, ',' ) )
+                {
+                    if ( range.empty() or range == "\n" )
+                        continue;
+                    auto dash = range.find( '-' );
+                    int lo = std::stoi( range.substr( 0, dash ) );
+                    int hi = dash == std::string::npos ? lo : std::stoi( range.substr( dash + 1 ) );
+                    for ( int cpu = lo; cpu <= hi; ++cpu )
+                        cpus.push_back( cpu );
+                }
+                return cpus;
+            }
+
+            static size_type online_cpus( )
+            {
+#if defined( __linux__ )
+                long n = sysconf( _SC_NPROCESSORS_ONLN );
+                if ( n > 0 )
+                    return n;
+#endif
+                return std::max( 1u, std::thread::hardware_concurrency() );
+            }
+
+            /// Fills the CPU to node map.
+            void index_cpus( )
+            {
+                for ( size_type node = m_cpus.size(); node-- > 0; )
+                    for ( int cpu : m_cpus[ node ] )
+                    {
+                        if ( size_type( cpu ) >= m_node_of.size() )
+                            m_node_of.resize( cpu + 1, 0 );
+                        m_node_of[ cpu ] = node;
+                    }
+            }
+
+        private:
+            std::vector< std::vector< int > > m_cpus; //!< CPUs of each node.
+            std::vector< size_type > m_node_of;       //!< Node of each CPU.
+            bool m_emulated = false;                  //!< Whether the nodes are not the host's.
+    };
+
+} // Namespace ac.
+#endif
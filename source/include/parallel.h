@@ -0,0 +1,62 @@
+/*!
+ * @file parallel.h
+ * @brief Helpers shared by the batch operations.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _PARALLEL_H_
+#define _PARALLEL_H_
+
+#include <cstddef>          // size_t
+#include <exception>        // exception_ptr, current_exception, rethrow_exception
+#include <thread>           // thread
+#include <vector>           // vector
+
+namespace ac // Associative container
+{
+    namespace detail
+    {
+        /// Joins the threads it watches when it goes out of scope, even during unwinding.
+        struct ThreadJoiner {
+            std::vector< std::thread > & m_threads;
+            ~ThreadJoiner( ) { for ( auto & th : m_threads ) if ( th.joinable( ) ) th.join( ); }
+        };
+
+        /// Runs fn_( t ) for t in [0, n_threads_), each call in its own thread (the first one in the caller's).
+        /// Every thread is joined before the first exception thrown by a call, if any, is rethrown.
+        template< class Function >
+        void run_parallel( std::size_t n_threads_, Function fn_ )
+        {
+            std::vector< std::exception_ptr > errors( n_threads_ > 0 ? n_threads_ : 1 );
+            auto guarded = [ &errors ]( Function fn, std::size_t t_ ) {
+                try { fn( t_ ); }
+                catch ( ... ) { errors[ t_ ] = std::current_exception( ); }
+            };
+
+            {
+                std::vector< std::thread > workers;
+                ThreadJoiner joiner{ workers };
+                for ( std::size_t t = 1; t < n_threads_; ++t )
+                    workers.emplace_back( guarded, fn_, t );
+                guarded( fn_, 0 );
+            }
+
+            for ( auto & err : errors )
+                if ( err )
+                    std::rethrow_exception( err );
+        }
+
+        /// Asks the processor to start loading the cache line at addr_ (no effect where unsupported).
+        inline void prefetch( const void * addr_ )
+        {
+#if defined( __GNUC__ )
+            __builtin_prefetch( addr_ );
+#else
+            ( void ) addr_;
+#endif
+        }
+    }
+
+} // Namespace ac.
+#endif
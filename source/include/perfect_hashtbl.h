@@ -0,0 +1,107 @@
+/*!
+ * @file perfect_hashtbl.h
+ * @brief Read-only hash table based on a minimal perfect hash function.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _PERFECT_HASHTBL_H_
+#define _PERFECT_HASHTBL_H_
+
+#include <algorithm>        // sort, find_if
+#include <cstdint>          // uint64_t, int32_t
+#include <functional>       // hash, equal_to
+#include <iostream>         // ostream
+#include <numeric>          // iota
+#include <stdexcept>        // out_of_range, runtime_error
+#include <thread>           // thread
+#include <vector>           // vector
+
+#include "hash_entry.h"     // HashEntry
+#include "hash_mix.h"       // mix64
+
+namespace ac // Associative container
+{
+    /*!
+     * This class implements an immutable hash table with single-probe lookups.
+     *
+     * Entries are stored densely in one array, with no empty slot and no pointer
+     * per entry, and a minimal perfect hash (hash-and-displace, as in CHD) maps
+     * each key to its position. Besides the entries, the table keeps roughly one
+     * 32-bit seed per two keys.
+     *
+     * The keys may be split into shards that are built concurrently, one thread
+     * each. Keys whose KeyHash values are identical cannot be separated by any
+     * seed; all but one of them are kept after the shards, in a small overflow
+     * range that is only searched after a miss (and iterated like the others).
+     *
+     * Tables are normally obtained from HashTbl::freeze().
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< class KeyType,
+		      class DataType,
+		      class KeyHash = std::hash< KeyType >,
+		      class KeyEqual = std::equal_to< KeyType > >
+	class PerfectHashTbl {
+        public:
+            // Aliases
+            using entry_type = HashEntry<KeyType,DataType>;
+            using size_type = std::size_t;
+            using const_iterator = typename std::vector< entry_type >::const_iterator;
+
+            /// Constructors
+            explicit PerfectHashTbl( std::vector< entry_type > entries_, size_type n_threads_ = 1 );
+
+            /// Class methods
+            bool retrieve( const KeyType &, DataType & ) const;
+            const DataType& at( const KeyType& ) const;
+            size_type count( const KeyType& ) const;
+            bool empty() const { return size() == 0; };
+            size_type size() const { return m_entries.size(); };
+            const_iterator begin() const { return m_entries.begin(); };
+            const_iterator end() const { return m_entries.end(); };
+
+            /// Friend functions
+            friend std::ostream & operator<<( std::ostream & os_, const PerfectHashTbl & ht_ ) {
+                for ( const auto & en : ht_.m_entries )
+                    os_ << en << "\n";
+                return os_;
+            }
+
+        private:
+            /// Range of the entries and seeds arrays owned by a shard.
+            struct Shard {
+                size_type m_first;        //!< Position of the shard's first entry.
+                size_type m_size;         //!< Number of entries of the shard.
+                size_type m_first_seed;   //!< Position of the shard's first seed.
+                size_type m_bucket_count; //!< Number of seeds of the shard.
+            };
+
+            /// Result of the construction of one shard.
+            struct ShardLayout {
+                std::vector< size_type > m_slots;      //!< Source entry placed at each slot.
+                std::vector< std::int32_t > m_seeds;   //!< Per bucket: seed if non-negative, -(slot+1) otherwise.
+                std::vector< size_type > m_overflow;   //!< Source entries that could not be placed.
+            };
+
+            /// Private methods
+            static ShardLayout build_shard( const std::vector< std::uint64_t > &, std::vector< size_type > );
+            const entry_type * find( const KeyType & ) const;
+
+        private:
+            static constexpr size_type KEYS_PER_BUCKET = 2; //!< Average bucket load used by the construction.
+            static constexpr size_type MAX_SEED = 1 << 24;  //!< Give up on a bucket after this many seeds.
+
+            std::vector< entry_type > m_entries;   //!< Entries, densely packed shard after shard, then the overflow.
+            std::vector< std::int32_t > m_seeds;   //!< Displacement seeds of all shards.
+            std::vector< Shard > m_shards;         //!< Shard directory.
+            size_type m_overflow = 0;              //!< Position of the first entry whose hash collides with another entry's.
+    };
+
+} // Namespace ac.
+#include "perfect_hashtbl.inl"
+#endif
@@ -0,0 +1,292 @@
+/*!
+ * @file perfect_hashtbl.inl
+ * @brief Implementation of the PerfectHashTbl class methods.
+ *
+ * @author Lucas Bazante
+ */
+
+#include "perfect_hashtbl.h"
+
+namespace ac {
+
+    /// CONSTRUCTORS
+
+    // Entries constructor.
+    /*!
+     * This constructor takes the entries over and builds the perfect hash layout.
+     * Keys are assumed to be unique, as they are in a HashTbl.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param entries_ The entries of the table.
+     * @param n_threads_ Number of shards, each one built by its own thread.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+	PerfectHashTbl<KeyType,DataType,KeyHash,KeyEqual>::PerfectHashTbl( std::vector< entry_type > entries_, size_type n_threads_ )
+	{
+        KeyHash hashf;
+        const size_type n_shards = std::max< size_type >( 1, n_threads_ );
+
+        std::vector< std::uint64_t > hashes( entries_.size() );
+        std::vector< std::vector< size_type > > members( n_shards );
+        for ( size_type i = 0; i < entries_.size(); ++i )
+        {
+            hashes[ i ] = hashf( entries_[ i ].m_key );
+            members[ mix64( hashes[ i ], 0 ) % n_shards ].push_back( i );
+        }
+
+        std::vector< ShardLayout > layouts( n_shards );
+        if ( n_shards == 1 )
+            layouts[ 0 ] = build_shard( hashes, std::move( members[ 0 ] ) );
+        else
+        {
+            std::vector< std::thread > workers;
+            for ( size_type s = 0; s < n_shards; ++s )
+                workers.emplace_back( [ &, s ]( ){ layouts[ s ] = build_shard( hashes, std::move( members[ s ] ) ); } );
+            for ( auto & w : workers )
+                w.join( );
+        }
+
+        m_entries.reserve( entries_.size() );
+        for ( auto & layout : layouts )
+        {
+            m_shards.push_back( { m_entries.size(), layout.m_slots.size(), m_seeds.size(), layout.m_seeds.size() } );
+            for ( auto i : layout.m_slots )
+                m_entries.push_back( std::move( entries_[ i ] ) );
+            m_seeds.insert( std::end( m_seeds ), std::begin( layout.m_seeds ), std::end( layout.m_seeds ) );
+        }
+
+        m_overflow = m_entries.size();
+        for ( auto & layout : layouts )
+            for ( auto i : layout.m_overflow )
+                m_entries.push_back( std::move( entries_[ i ] ) );
+	}
+
+    /// CLASS METHODS
+
+    // Retrieves data from the table.
+    /*!
+     * Retrieves a data item from the table, based on the key associated with the data.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Data key to search for in the table.
+     * @param data_item_ Data record to be filled in when data item is found.
+     *
+     * @return True if the data item is found; False, otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool PerfectHashTbl<KeyType,DataType,KeyHash,KeyEqual>::retrieve( const KeyType & key_, DataType & data_item_ ) const
+    {
+        auto entry = find( key_ );
+        if ( entry == nullptr )
+            return false;
+
+        data_item_ = entry->m_data;
+        return true;
+    }
+
+    // Reference to the element associated with a key.
+    /*!
+     * This function finds the data associated with a certain key, if it doesn't exist, an exception is thrown.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key to wanted element.
+     *
+     * @return Data associated with the key.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    const DataType& PerfectHashTbl<KeyType,DataType,KeyHash,KeyEqual>::at( const KeyType & key_ ) const
+    {
+        auto entry = find( key_ );
+        if ( entry == nullptr )
+            throw std::out_of_range( "Not present" );
+
+        return entry->m_data;
+    }
+
+    // Counts the elements associated with a key.
+    /*!
+     * Keys are unique, so this is either zero or one.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key to search for.
+     *
+     * @return 1 if the key is in the table; 0 otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename PerfectHashTbl<KeyType,DataType,KeyHash,KeyEqual>::size_type
+    PerfectHashTbl<KeyType,DataType,KeyHash,KeyEqual>::count( const KeyType & key_ ) const
+    {
+        return find( key_ ) == nullptr ? 0 : 1;
+    }
+
+    // Finds the entry associated with a key.
+    /*!
+     * The key is hashed once; the shard, the bucket and the slot are all derived
+     * from that value, so exactly one entry is compared in the common case.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key to search for.
+     *
+     * @return Pointer to the entry, or nullptr if the key is not in the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    const typename PerfectHashTbl<KeyType,DataType,KeyHash,KeyEqual>::entry_type *
+    PerfectHashTbl<KeyType,DataType,KeyHash,KeyEqual>::find( const KeyType & key_ ) const
+    {
+        KeyHash hashf;
+        KeyEqual eq;
+        const std::uint64_t h = hashf( key_ );
+        const Shard & shard = m_shards[ mix64( h, 0 ) % m_shards.size() ];
+
+        if ( shard.m_size != 0 )
+        {
+            const std::int32_t seed = m_seeds[ shard.m_first_seed + mix64( h, 1 ) % shard.m_bucket_count ];
+            const size_type slot = seed < 0 ? static_cast< size_type >( -seed - 1 )
+                                            : static_cast< size_type >( mix64( h, seed + 2 ) % shard.m_size );
+            const entry_type & entry = m_entries[ shard.m_first + slot ];
+            if ( eq( entry.m_key, key_ ) )
+                return &entry;
+        }
+
+        auto first = std::begin( m_entries ) + m_overflow;
+        if ( first == std::end( m_entries ) )
+            return nullptr;
+
+        auto item = std::find_if( first, std::end( m_entries ), [ & ]( const entry_type & en ){ return eq( en.m_key, key_ ); } );
+        return item == std::end( m_entries ) ? nullptr : &*item;
+    }
+
+    // Builds the perfect hash layout of one shard.
+    /*!
+     * Keys are distributed into buckets, which are then processed from the most
+     * to the least loaded. For each bucket with more than one key we try seeds
+     * until all keys land on distinct free slots; single-key buckets then get the
+     * remaining free slots directly, which is what makes the hash minimal.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param hashes_ KeyHash value of every source entry.
+     * @param members_ Source entries belonging to this shard.
+     *
+     * @return The layout of the shard.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename PerfectHashTbl<KeyType,DataType,KeyHash,KeyEqual>::ShardLayout
+    PerfectHashTbl<KeyType,DataType,KeyHash,KeyEqual>::build_shard( const std::vector< std::uint64_t > & hashes_,
+                                                                     std::vector< size_type > members_ )
+    {
+        ShardLayout layout;
+
+        // Keys sharing a hash value can never be separated: spill all but the first.
+        std::sort( std::begin( members_ ), std::end( members_ ),
+                   [ & ]( size_type a, size_type b ){ return hashes_[ a ] < hashes_[ b ]; } );
+        std::vector< size_type > keys;
+        keys.reserve( members_.size() );
+        for ( auto i : members_ )
+        {
+            if ( not keys.empty() and hashes_[ keys.back() ] == hashes_[ i ] )
+                layout.m_overflow.push_back( i );
+            else
+                keys.push_back( i );
+        }
+
+        const size_type n_keys = keys.size();
+        const size_type n_buckets = n_keys / KEYS_PER_BUCKET + 1;
+        layout.m_slots.assign( n_keys, 0 );
+        layout.m_seeds.assign( n_buckets, 0 );
+
+        // Group the keys by bucket (counting sort).
+        std::vector< size_type > bucket_of( n_keys );
+        std::vector< size_type > start( n_buckets + 1, 0 );
+        for ( size_type k = 0; k < n_keys; ++k )
+        {
+            bucket_of[ k ] = mix64( hashes_[ keys[ k ] ], 1 ) % n_buckets;
+            ++start[ bucket_of[ k ] + 1 ];
+        }
+        std::partial_sum( std::begin( start ), std::end( start ), std::begin( start ) );
+        std::vector< size_type > grouped( n_keys );
+        {
+            std::vector< size_type > next( std::begin( start ), std::end( start ) - 1 );
+            for ( size_type k = 0; k < n_keys; ++k )
+                grouped[ next[ bucket_of[ k ] ]++ ] = keys[ k ];
+        }
+
+        std::vector< size_type > order( n_buckets );
+        std::iota( std::begin( order ), std::end( order ), 0 );
+        std::stable_sort( std::begin( order ), std::end( order ),
+                          [ & ]( size_type a, size_type b ){ return start[ a + 1 ] - start[ a ] > start[ b + 1 ] - start[ b ]; } );
+
+        std::vector< bool > taken( n_keys, false );
+        std::vector< size_type > slots;
+        size_type next_free = 0;
+
+        for ( auto b : order )
+        {
+            const size_type load = start[ b + 1 ] - start[ b ];
+            if ( load == 0 )
+                break; // The remaining buckets are empty as well.
+
+            if ( load == 1 )
+            {
+                while ( taken[ next_free ] )
+                    ++next_free;
+                layout.m_seeds[ b ] = -static_cast< std::int32_t >( next_free + 1 );
+                layout.m_slots[ next_free ] = grouped[ start[ b ] ];
+                taken[ next_free ] = true;
+                continue;
+            }
+
+            for ( std::int32_t seed = 0; ; ++seed )
+            {
+                if ( static_cast< size_type >( seed ) == MAX_SEED )
+                    throw std::runtime_error( "PerfectHashTbl: no seed found for a bucket" );
+
+                slots.clear();
+                bool fits = true;
+                for ( size_type k = start[ b ]; k < start[ b + 1 ] and fits; ++k )
+                {
+                    const size_type slot = mix64( hashes_[ grouped[ k ] ], seed + 2 ) % n_keys;
+                    fits = not taken[ slot ] and std::find( std::begin( slots ), std::end( slots ), slot ) == std::end( slots );
+                    slots.push_back( slot );
+                }
+
+                if ( not fits )
+                    continue;
+
+                layout.m_seeds[ b ] = seed;
+                for ( size_type k = 0; k < slots.size(); ++k )
+                {
+                    layout.m_slots[ slots[ k ] ] = grouped[ start[ b ] + k ];
+                    taken[ slots[ k ] ] = true;
+                }
+                break;
+            }
+        }
+
+        return layout;
+    }
+
+} // Namespace ac.
@@ -0,0 +1,126 @@
+/*!
+ * @file replicated_hashtbl.h
+ * @brief Read-mostly hash table with NUMA-aware placement and per-node replicas.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _REPLICATED_HASHTBL_H_
+#define _REPLICATED_HASHTBL_H_
+
+#include <functional>       // hash, equal_to
+#include <memory>           // unique_ptr
+#include <mutex>            // mutex, lock_guard, unique_lock
+#include <shared_mutex>     // shared_mutex, shared_lock
+#include <vector>           // vector
+
+#include "hashtbl.h"        // HashTbl
+#include "numa_topology.h"  // NumaTopology
+
+namespace ac // Associative container
+{
+    /// Where a ReplicatedHashTbl keeps its data.
+    enum class ReplicaPolicy {
+        PER_NODE,   //!< One full copy per node, built and read on that node.
+        INTERLEAVED //!< A single copy whose bucket array is interleaved over the nodes.
+    };
+
+    /*!
+     * This class implements a thread-safe, read-mostly hash table for hosts with
+     * several NUMA nodes.
+     *
+     * With ReplicaPolicy::PER_NODE every node holds its own HashTbl. Replicas are
+     * built (and batches applied) by a thread pinned to their node, so that, with
+     * the kernel's first-touch policy, their buckets and nodes live in that node's
+     * memory; readers use the replica of the node they run on. Single writes
+     * (insert(), erase(), ...) run on the caller's thread: the bucket array of each
+     * replica is bound to its node again whenever they replace it, but the elements
+     * they add are allocated on the caller's node, so large loads should go through
+     * apply_batch(). Each write is applied
+     * to every replica, one after the other: until it returns, readers on different
+     * nodes may see the table before and after the write. Writers are serialized,
+     * and update(), upsert() and compute() run their callback once, on the first
+     * replica, and copy the result to the others, so they are atomic per key.
+     *
+     * With ReplicaPolicy::INTERLEAVED there is one table, whose bucket array is
+     * spread page by page over all nodes, so no node is favoured.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< class KeyType,
+		      class DataType,
+		      class KeyHash = std::hash< KeyType >,
+		      class KeyEqual = std::equal_to< KeyType > >
+	class ReplicatedHashTbl {
+        public:
+            // Aliases
+            using table_type = HashTbl< KeyType, DataType, KeyHash, KeyEqual >;
+            using mutation_type = typename table_type::mutation_type;
+            using size_type = std::size_t;
+
+            /// Constructors
+            explicit ReplicatedHashTbl( const NumaTopology & topology_ = NumaTopology::detect( ),
+                                        ReplicaPolicy policy_ = ReplicaPolicy::PER_NODE,
+                                        size_type table_sz_ = DEFAULT_SIZE );
+
+            /// Class methods
+            bool insert( const KeyType &, const DataType & );
+            template< class Function >
+            bool update( const KeyType &, Function );
+            template< class Make, class Update >
+            bool upsert( const KeyType &, Make, Update );
+            template< class Function >
+            bool compute( const KeyType &, Function );
+            bool erase( const KeyType & );
+            void clear( );
+            bool retrieve( const KeyType &, DataType & ) const;
+            bool retrieve( const KeyType &, DataType &, size_type node_ ) const;
+            template< class Iterator >
+            void apply_batch( Iterator, Iterator );
+            size_type size( ) const;
+            bool empty( ) const { return size( ) == 0; };
+            size_type replicas( ) const { return m_replicas.size(); };
+            const NumaTopology & topology( ) const { return m_topology; };
+            ReplicaPolicy policy( ) const { return m_policy; };
+
+        private:
+            /// A HashTbl that exposes its bucket array, for placement.
+            class Table : public table_type {
+                public:
+                    using table_type::table_type;
+                    const void * buckets( ) const { return this->m_table.get(); };
+                    size_type bucket_bytes( ) const { return this->m_size * sizeof( typename table_type::list_type ); };
+            };
+
+            /// A copy of the table, aligned so that locks of different nodes do not share a cache line.
+            struct alignas( 64 ) Replica {
+                mutable std::shared_mutex m_lock; //!< Readers share, writers exclude.
+                Table m_table;                    //!< The data.
+                const void * m_placed = nullptr;  //!< Bucket array the placement was applied to.
+                size_type m_node;                 //!< Node the replica belongs to.
+
+                Replica( size_type table_sz_, size_type node_ ) : m_table( table_sz_ ), m_placed( m_table.buckets() ), m_node( node_ ) {}
+            };
+
+            /// Private methods
+            const Replica & local( size_type node_ ) const;
+            template< class Write >
+            void write_all( Write );
+            template< class Write >
+            void write_through( const KeyType &, Write );
+            void place( Replica & );
+
+        private:
+            NumaTopology m_topology;                          //!< Nodes of the host (or emulated).
+            ReplicaPolicy m_policy;                           //!< Where the data lives.
+            std::vector< std::unique_ptr< Replica > > m_replicas; //!< One per node, or one if interleaved.
+            std::mutex m_writer;                              //!< Writes reach the replicas in the same order.
+            static const short DEFAULT_SIZE = 11;
+    };
+
+} // Namespace ac.
+#include "replicated_hashtbl.inl"
+#endif
@@ -0,0 +1,376 @@
+/*!
+ * @file replicated_hashtbl.inl
+ * @brief Implementation of the ReplicatedHashTbl class methods.
+ *
+ * @author Lucas Bazante
+ */
+
+#include "replicated_hashtbl.h"
+
+namespace ac {
+
+    /// CONSTRUCTORS
+
+    // Topology constructor.
+    /*!
+     * Each replica is allocated by a thread running on its node.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param topology_ The nodes (NumaTopology::emulated() to test on a single-node host).
+     * @param policy_ Where the data lives.
+     * @param table_sz_ The minimun size of each table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+	ReplicatedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::ReplicatedHashTbl( const NumaTopology & topology_,
+                                                                            ReplicaPolicy policy_, size_type table_sz_ )
+        : m_topology{ topology_ }, m_policy{ policy_ }
+	{
+        if ( m_policy == ReplicaPolicy::INTERLEAVED )
+        {
+            m_replicas.push_back( std::make_unique< Replica >( table_sz_, 0 ) );
+            m_topology.place( m_replicas.front()->m_table.buckets(), m_replicas.front()->m_table.bucket_bytes(), NumaPolicy::INTERLEAVE );
+            return;
+        }
+
+        m_replicas.resize( m_topology.nodes() );
+        for ( size_type node = 0; node < m_replicas.size(); ++node )
+            m_topology.run_on_node( node, [ & ]{ m_replicas[ node ] = std::make_unique< Replica >( table_sz_, node ); } );
+	}
+
+    /// CLASS METHODS
+
+    // Inserts data into every replica.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key associated with data.
+     * @param new_data_ New data to be inserted/updated.
+     *
+     * @return True if the insertion was successful; False if the key already existed.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool ReplicatedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::insert( const KeyType & key_, const DataType & new_data_ )
+    {
+        bool inserted = false;
+        write_all( [ & ]( Table & t_ ){ inserted = t_.insert( key_, new_data_ ); } );
+        return inserted;
+    }
+
+    // Modifies the data associated with a key in place.
+    /*!
+     * fn_ runs once, while no other writer runs; the other replicas receive a copy of the result.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Function A function accepting a DataType &.
+     *
+     * @param key_ Key of the element to modify.
+     * @param fn_ The modification.
+     *
+     * @return True if the key was found (and fn_ called); False otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Function >
+    bool ReplicatedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::update( const KeyType & key_, Function fn_ )
+    {
+        bool found = false;
+        write_through( key_, [ & ]( Table & t_ ){ found = t_.update( key_, fn_ ); } );
+        return found;
+    }
+
+    // Modifies the data associated with a key in place, inserting it if absent.
+    /*!
+     * The callback used runs once, while no other writer runs; the other replicas
+     * receive a copy of the result.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Make A function returning a DataType.
+     * @tparam Update A function accepting a DataType &.
+     *
+     * @param key_ Key of the element.
+     * @param make_fn_ Creates the data of a new element.
+     * @param update_fn_ Modifies the data of an existing element.
+     *
+     * @return True if the element was inserted; False if it was updated.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Make, typename Update >
+    bool ReplicatedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::upsert( const KeyType & key_, Make make_fn_, Update update_fn_ )
+    {
+        bool inserted = false;
+        write_through( key_, [ & ]( Table & t_ ){ inserted = t_.upsert( key_, make_fn_, update_fn_ ); } );
+        return inserted;
+    }
+
+    // Computes the new state of a key in place.
+    /*!
+     * See HashTbl::compute(). fn_ runs once, while no other writer runs; the other
+     * replicas receive a copy of the result.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Function A function accepting a DataType & and a bool, and returning a bool.
+     *
+     * @param key_ Key of the element.
+     * @param fn_ The computation.
+     *
+     * @return True if the key is in the table afterwards; False otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Function >
+    bool ReplicatedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::compute( const KeyType & key_, Function fn_ )
+    {
+        bool present = false;
+        write_through( key_, [ & ]( Table & t_ ){ present = t_.compute( key_, fn_ ); } );
+        return present;
+    }
+
+    // Removes a key from every replica.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key of element to be removed.
+     *
+     * @return True if the key was found; False otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool ReplicatedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::erase( const KeyType & key_ )
+    {
+        bool erased = false;
+        write_all( [ & ]( Table & t_ ){ erased = t_.erase( key_ ); } );
+        return erased;
+    }
+
+    // Empties every replica.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void ReplicatedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::clear( )
+    {
+        write_all( []( Table & t_ ){ t_.clear( ); } );
+    }
+
+    // Retrieves data from the replica of the calling thread's node.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Data key to search for in the table.
+     * @param data_item_ Data record to be filled in when data item is found.
+     *
+     * @return True if the data item is found; False, otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool ReplicatedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::retrieve( const KeyType & key_, DataType & data_item_ ) const
+    {
+        return retrieve( key_, data_item_, m_topology.current_node( ) );
+    }
+
+    // Retrieves data from the replica of a given node.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Data key to search for in the table.
+     * @param data_item_ Data record to be filled in when data item is found.
+     * @param node_ The node whose replica is read.
+     *
+     * @return True if the data item is found; False, otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool ReplicatedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::retrieve( const KeyType & key_, DataType & data_item_, size_type node_ ) const
+    {
+        const Replica & replica = local( node_ );
+        std::shared_lock< std::shared_mutex > lock( replica.m_lock );
+        return replica.m_table.retrieve( key_, data_item_ );
+    }
+
+    // Applies a sequence of mutations to every replica.
+    /*!
+     * With one replica per node, the replicas are updated in parallel, each one by
+     * a thread running on its node (so new elements are allocated there).
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Iterator A forward iterator over mutation_type.
+     *
+     * @param first_ Start of the mutations.
+     * @param last_ End of the mutations.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Iterator >
+    void ReplicatedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::apply_batch( Iterator first_, Iterator last_ )
+    {
+        if ( m_policy == ReplicaPolicy::INTERLEAVED )
+        {
+            write_all( [ & ]( Table & t_ ){ t_.apply_batch( first_, last_ ); } );
+            return;
+        }
+
+        std::lock_guard< std::mutex > writer( m_writer );
+        std::vector< std::thread > workers;
+        for ( size_type node = 0; node < m_replicas.size(); ++node )
+            workers.push_back( m_topology.start_on_node( node, [ this, node, first_, last_ ]{
+                Replica & replica = *m_replicas[ node ];
+                std::unique_lock< std::shared_mutex > lock( replica.m_lock );
+                replica.m_table.apply_batch( first_, last_ );
+                replica.m_placed = replica.m_table.buckets(); // Allocated on the node.
+            } ) );
+        for ( auto & w : workers )
+            w.join( );
+    }
+
+    // Number of elements.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @return The number of elements in the replica of the calling thread's node.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename ReplicatedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::size_type
+    ReplicatedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::size( ) const
+    {
+        const Replica & replica = local( m_topology.current_node( ) );
+        std::shared_lock< std::shared_mutex > lock( replica.m_lock );
+        return replica.m_table.size();
+    }
+
+    // Replica read on a node.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param node_ The node.
+     *
+     * @return The node's replica, or the only one if the table is interleaved.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    const typename ReplicatedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::Replica &
+    ReplicatedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::local( size_type node_ ) const
+    {
+        return *m_replicas[ node_ < m_replicas.size() ? node_ : 0 ];
+    }
+
+    // Applies a change to every replica.
+    /*!
+     * Replicas are locked and changed one at a time, in the calling thread.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Write A function accepting a Table &.
+     *
+     * @param write_ The change.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Write >
+    void ReplicatedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::write_all( Write write_ )
+    {
+        std::lock_guard< std::mutex > writer( m_writer );
+        for ( auto & replica : m_replicas )
+        {
+            std::unique_lock< std::shared_mutex > lock( replica->m_lock );
+            write_( replica->m_table );
+            place( *replica );
+        }
+    }
+
+    // Applies a change to one key of the first replica and copies the result to the others.
+    /*!
+     * The change runs once, so callbacks in it need not be repeatable. Other writers
+     * are excluded throughout, which lets the first replica be read without its lock.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Write A function accepting a Table &, changing at most key_.
+     *
+     * @param key_ The key changed.
+     * @param write_ The change.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Write >
+    void ReplicatedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::write_through( const KeyType & key_, Write write_ )
+    {
+        std::lock_guard< std::mutex > writer( m_writer );
+        Replica & first = *m_replicas.front( );
+        {
+            std::unique_lock< std::shared_mutex > lock( first.m_lock );
+            write_( first.m_table );
+            place( first );
+        }
+
+        const DataType * data = static_cast< const Table & >( first.m_table ).find( key_ );
+        for ( size_type i = 1; i < m_replicas.size(); ++i )
+        {
+            Replica & replica = *m_replicas[ i ];
+            std::unique_lock< std::shared_mutex > lock( replica.m_lock );
+            if ( data != nullptr )
+                replica.m_table.insert( key_, *data );
+            else
+                replica.m_table.erase( key_ );
+            place( replica );
+        }
+    }
+
+    // Places the bucket array of a replica after a write from the caller's thread.
+    /*!
+     * Done again whenever the table gets a new bucket array: an interleaved table's
+     * is spread over the nodes, and a replica's is bound to its node (a rehash on
+     * the caller's thread would have allocated it on the caller's node).
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param replica_ The replica.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void ReplicatedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::place( Replica & replica_ )
+    {
+        if ( replica_.m_table.buckets() == replica_.m_placed )
+            return;
+
+        if ( m_policy == ReplicaPolicy::INTERLEAVED )
+            m_topology.place( replica_.m_table.buckets(), replica_.m_table.bucket_bytes(), NumaPolicy::INTERLEAVE );
+        else
+            m_topology.place( replica_.m_table.buckets(), replica_.m_table.bucket_bytes(), NumaPolicy::BIND, replica_.m_node );
+        replica_.m_placed = replica_.m_table.buckets();
+    }
+
+} // Namespace ac.
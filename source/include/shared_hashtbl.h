@@ -0,0 +1,175 @@
+/*!
+ * @file shared_hashtbl.h
+ * @brief Hash table stored in a memory-mapped file, shared by several processes.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _SHARED_HASHTBL_H_
+#define _SHARED_HASHTBL_H_
+
+#include <atomic>           // atomic, atomic_thread_fence
+#include <cstdint>          // uint32_t, uint64_t
+#include <cstdio>           // rename
+#include <cstdlib>          // mkstemp
+#include <cstring>          // memcpy, memcmp
+#include <stdexcept>        // invalid_argument, length_error, logic_error, runtime_error
+#include <string>           // string
+#include <system_error>     // system_error
+#include <type_traits>      // is_trivially_copyable
+#include <utility>          // exchange
+#include <vector>           // vector
+
+#include <fcntl.h>          // open
+#include <pthread.h>        // pthread_mutex_t
+#include <signal.h>         // kill
+#include <sys/mman.h>       // mmap, munmap, msync
+#include <sys/stat.h>       // fstat, fchmod
+#include <unistd.h>         // close, ftruncate, getpid, unlink
+
+#include "hash_entry.h"     // HashEntry
+#include "hash_mix.h"       // fast_hash_t, fast_equal_t
+#include "hash_primes.h"    // next_prime
+
+namespace ac // Associative container
+{
+    /*!
+     * This class implements a hash table whose buckets and entries live in a file
+     * mapped with MAP_SHARED (a regular file, or one under /dev/shm for POSIX shared
+     * memory), so that processes opening the same file share one copy in the page
+     * cache, and reopening it after a restart is just a mapping.
+     *
+     * The file holds no pointers: buckets and chain links are indices of entry slots,
+     * all allocated when the file is created (its capacity); erased slots are reused.
+     * Keys and data are stored by their bytes, so both must be trivially copyable,
+     * and KeyHash must give the same value in every process (the default does).
+     *
+     * One process at a time writes, holding a robust process-shared mutex kept in the
+     * file. Readers need only a read-only mapping: every write bumps a sequence
+     * number (odd while it is in progress), and a lookup that overlapped a write is
+     * retried, so readers never block the writer nor see a half-written entry.
+     *
+     * A writer that dies in the middle of a write leaves the table inconsistent: the
+     * next process to take the lock (or a reader that waited too long for the write
+     * to end) marks it so, and from then on every operation but clear() throws
+     * std::runtime_error. clear() empties the table and makes it usable again.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< class KeyType,
+		      class DataType,
+		      class KeyHash = fast_hash_t< KeyType >,
+		      class KeyEqual = fast_equal_t< KeyType > >
+	class SharedHashTbl {
+        static_assert( std::is_trivially_copyable_v< KeyType > and std::is_trivially_copyable_v< DataType >,
+                       "entries are stored by their bytes" );
+        static_assert( std::atomic< std::uint64_t >::is_always_lock_free, "atomics must work across processes" );
+
+        public:
+            // Aliases
+            using entry_type = HashEntry<KeyType,DataType>;
+            using size_type = std::size_t;
+
+            /// How a file is mapped.
+            enum class Access {
+                READ_ONLY,  //!< Lookups only; the mapping is read-only.
+                READ_WRITE  //!< Lookups and writes.
+            };
+
+            /// First bytes of a table file.
+            static constexpr char MAGIC[ 8 ] = { 'A', 'C', 'S', 'H', 'T', 'B', 'L', '2' };
+
+            /// Constructors
+            static SharedHashTbl create( const std::string & path_, size_type capacity_, float max_load_factor_ = 1.0f );
+            static SharedHashTbl open( const std::string & path_, Access access_ = Access::READ_ONLY );
+            SharedHashTbl( SharedHashTbl && ) noexcept;
+            SharedHashTbl( const SharedHashTbl & ) = delete;
+
+            /// Overloaded operators
+            SharedHashTbl & operator=( SharedHashTbl && ) noexcept;
+            SharedHashTbl & operator=( const SharedHashTbl & ) = delete;
+
+            /// Destructor
+            ~SharedHashTbl();
+
+            /// Class methods
+            bool insert( const KeyType &, const DataType & );
+            template< class Function >
+            bool update( const KeyType &, Function );
+            bool erase( const KeyType & );
+            void clear( );
+            bool retrieve( const KeyType &, DataType & ) const;
+            size_type count( const KeyType & key_ ) const { DataType d; return retrieve( key_, d ); };
+            size_type size( ) const { return header( ).m_count.load( std::memory_order_acquire ); };
+            bool empty( ) const { return size( ) == 0; };
+            size_type capacity( ) const { return header( ).m_capacity; };
+            size_type bucket_count( ) const { return header( ).m_buckets; };
+            bool writable( ) const { return m_access == Access::READ_WRITE; };
+            bool consistent( ) const { return header( ).m_damaged.load( std::memory_order_acquire ) == 0; };
+            std::vector< entry_type > entries( ) const;
+            void sync( );
+
+        private:
+            /// Start of the file.
+            struct Header {
+                char m_magic[ 8 ];                     //!< MAGIC.
+                std::uint32_t m_key_size;              //!< sizeof( KeyType ), to reject other layouts.
+                std::uint32_t m_data_size;             //!< sizeof( DataType ).
+                std::uint64_t m_buckets;               //!< Number of buckets.
+                std::uint64_t m_capacity;              //!< Number of entry slots.
+                std::atomic< std::uint64_t > m_seq;    //!< Write sequence: odd while a write is in progress.
+                std::atomic< std::uint64_t > m_count;  //!< Number of elements.
+                std::atomic< std::uint64_t > m_used;   //!< Slots ever handed out.
+                std::atomic< std::uint64_t > m_free;   //!< First free slot (0 if none).
+                std::atomic< std::uint64_t > m_writer_pid; //!< Process writing, or 0.
+                std::atomic< std::uint64_t > m_damaged; //!< Not 0 once a writer died mid-write.
+                pthread_mutex_t m_writer;              //!< Held by the writing process.
+            };
+
+            /// An entry slot. Links and bucket heads are slot numbers, 1-based (0 ends a chain).
+            struct Node {
+                std::atomic< std::uint64_t > m_next; //!< Next slot of the chain, or of the free list.
+                KeyType m_key;
+                DataType m_data;
+            };
+
+            /// Holds the writer lock and marks a write in progress.
+            class WriteGuard {
+                public:
+                    explicit WriteGuard( SharedHashTbl &, bool repair_ = false );
+                    ~WriteGuard( );
+                private:
+                    Header & m_header;
+            };
+
+            SharedHashTbl( const std::string & path_, Access access_, size_type bytes_ );
+
+            /// Yields (waiting for a write to end) before a reader checks on the writer.
+            static constexpr size_type STALL_SPINS = 1 << 14;
+
+            /// Private methods
+            static size_type buckets_offset( ) { return ( sizeof( Header ) + 63 ) / 64 * 64; };
+            static size_type nodes_offset( size_type buckets_ ) { return ( buckets_offset( ) + buckets_ * 8 + 63 ) / 64 * 64; };
+            Header & header( ) const { return *reinterpret_cast< Header * >( m_base ); };
+            std::atomic< std::uint64_t > & bucket( size_type i_ ) const;
+            Node & node( std::uint64_t slot_ ) const;
+            std::atomic< std::uint64_t > & head_of( const KeyType & ) const;
+            Node * locate( const KeyType & ) const;
+            void init( size_type buckets_, size_type capacity_ );
+            void check_writable( ) const;
+            void check_consistent( ) const;
+            void stalled( ) const;
+            static void recover( Header & );
+
+        private:
+            char * m_base = nullptr;          //!< Start of the mapping.
+            size_type m_bytes = 0;            //!< Length of the mapping.
+            Access m_access = Access::READ_ONLY;
+    };
+
+} // Namespace ac.
+#include "shared_hashtbl.inl"
+#endif
@@ -0,0 +1,620 @@
+/*!
+ * @file shared_hashtbl.inl
+ * @brief Implementation of the SharedHashTbl class methods.
+ *
+ * @author Lucas Bazante
+ */
+
+#include <cerrno>           // errno, EOWNERDEAD, ESRCH
+#include <thread>           // this_thread::yield
+
+#include "shared_hashtbl.h"
+
+namespace ac {
+
+    /// CONSTRUCTORS
+
+    // Creates a table file.
+    /*!
+     * Any existing file at the path is replaced: the table is built in a temporary
+     * file that is then renamed over it, so processes that mapped the old file keep
+     * it intact. The file is sized for capacity_ elements, and the table cannot hold more.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param path_ The file (e.g. under /dev/shm to keep it in memory only).
+     * @param capacity_ Maximum number of elements.
+     * @param max_load_factor_ Load factor of the full table, which sets the number of buckets.
+     *
+     * @return The table, open for writing.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+	SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>
+    SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::create( const std::string & path_, size_type capacity_, float max_load_factor_ )
+	{
+        if ( capacity_ == 0 or not ( max_load_factor_ > 0 ) )
+            throw std::invalid_argument( "SharedHashTbl needs a capacity and a positive load factor" );
+
+        const size_type buckets = detail::next_prime( static_cast< size_type >( capacity_ / max_load_factor_ ) );
+        std::string temp = path_ + ".XXXXXX";
+        int fd = mkstemp( temp.data( ) );
+        if ( fd < 0 )
+            throw std::system_error( errno, std::generic_category( ), "cannot create " + path_ );
+        fchmod( fd, 0644 );
+        ::close( fd );
+
+        try
+        {
+            SharedHashTbl table( temp, Access::READ_WRITE, nodes_offset( buckets ) + capacity_ * sizeof( Node ) );
+            table.init( buckets, capacity_ );
+            if ( std::rename( temp.c_str( ), path_.c_str( ) ) != 0 )
+                throw std::system_error( errno, std::generic_category( ), "cannot create " + path_ );
+            return table;
+        }
+        catch ( ... )
+        {
+            ::unlink( temp.c_str( ) );
+            throw;
+        }
+	}
+
+    // Lays out a new table in a zero-filled mapping.
+    /*!
+     * Every bucket and link starts empty.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param buckets_ Number of buckets.
+     * @param capacity_ Number of entry slots.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::init( size_type buckets_, size_type capacity_ )
+	{
+        Header & h = *new ( m_base ) Header;
+        h.m_key_size = sizeof( KeyType );
+        h.m_data_size = sizeof( DataType );
+        h.m_buckets = buckets_;
+        h.m_capacity = capacity_;
+        h.m_seq.store( 0 );
+        h.m_count.store( 0 );
+        h.m_used.store( 0 );
+        h.m_free.store( 0 );
+        h.m_writer_pid.store( 0 );
+        h.m_damaged.store( 0 );
+
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init( &attr );
+        pthread_mutexattr_setpshared( &attr, PTHREAD_PROCESS_SHARED );
+        pthread_mutexattr_setrobust( &attr, PTHREAD_MUTEX_ROBUST );
+        pthread_mutex_init( &h.m_writer, &attr );
+        pthread_mutexattr_destroy( &attr );
+
+        std::atomic_thread_fence( std::memory_order_release );
+        std::memcpy( h.m_magic, MAGIC, sizeof MAGIC ); // Last: the file is now valid.
+	}
+
+    // Opens a table file.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param path_ A file made by create().
+     * @param access_ Whether the table will be written.
+     *
+     * @return The table. Throws std::system_error if the file cannot be mapped and
+     *         std::invalid_argument if it is not a table with these key and data types.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+	SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>
+    SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::open( const std::string & path_, Access access_ )
+	{
+        SharedHashTbl table( path_, access_, 0 );
+
+        const Header & h = table.header( );
+        if ( table.m_bytes < sizeof( Header ) or std::memcmp( h.m_magic, MAGIC, sizeof MAGIC ) != 0
+             or h.m_key_size != sizeof( KeyType ) or h.m_data_size != sizeof( DataType )
+             or table.m_bytes < nodes_offset( h.m_buckets ) + h.m_capacity * sizeof( Node ) )
+            throw std::invalid_argument( path_ + " is not a table file of this layout" );
+
+        return table;
+	}
+
+    // Maps a file.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param path_ The file.
+     * @param access_ How it is mapped.
+     * @param bytes_ If not 0, the (empty) file is extended to this size.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+	SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::SharedHashTbl( const std::string & path_, Access access_, size_type bytes_ )
+        : m_access{ access_ }
+	{
+        const bool write = access_ == Access::READ_WRITE;
+        int fd = ::open( path_.c_str( ), write ? O_RDWR : O_RDONLY );
+        if ( fd < 0 )
+            throw std::system_error( errno, std::generic_category( ), "cannot open " + path_ );
+
+        struct stat st;
+        if ( bytes_ != 0 ? ftruncate( fd, bytes_ ) != 0 : fstat( fd, &st ) != 0 )
+        {
+            int err = errno;
+            ::close( fd );
+            throw std::system_error( err, std::generic_category( ), "cannot size " + path_ );
+        }
+        m_bytes = bytes_ != 0 ? bytes_ : static_cast< size_type >( st.st_size );
+
+        void * base = m_bytes == 0 ? MAP_FAILED : mmap( nullptr, m_bytes, PROT_READ | ( write ? PROT_WRITE : 0 ), MAP_SHARED, fd, 0 );
+        int err = errno;
+        ::close( fd ); // The mapping keeps the file.
+        if ( base == MAP_FAILED )
+            throw std::system_error( m_bytes == 0 ? EINVAL : err, std::generic_category( ), "cannot map " + path_ );
+        m_base = static_cast< char * >( base );
+	}
+
+    // Move constructor.
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+	SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::SharedHashTbl( SharedHashTbl && source_ ) noexcept
+        : m_base{ std::exchange( source_.m_base, nullptr ) }, m_bytes{ std::exchange( source_.m_bytes, 0 ) },
+          m_access{ source_.m_access }
+	{/*Empty*/}
+
+    /// OVERLOADED OPERATORS
+
+    // Move assignment.
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+	SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual> &
+    SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::operator=( SharedHashTbl && source_ ) noexcept
+    {
+        std::swap( m_base, source_.m_base );
+        std::swap( m_bytes, source_.m_bytes );
+        std::swap( m_access, source_.m_access );
+        return *this;
+    }
+
+    /// DESTRUCTOR
+
+    // Class destructor: unmaps the file, which keeps the table.
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+	SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::~SharedHashTbl( )
+	{
+        if ( m_base != nullptr )
+            munmap( m_base, m_bytes );
+	}
+
+    /// CLASS METHODS
+
+    // Inserts data into the hash table according to the associated key.
+    /*!
+     * Inserts the new entry if the key does not exist and updates the data otherwise.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key associated with data.
+     * @param new_data_ New data to be inserted/updated.
+     *
+     * @return True if the insertion was successful; False if the key already existed.
+     *         Throws std::length_error if the table is full.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::insert( const KeyType & key_, const DataType & new_data_ )
+    {
+        check_writable( );
+        WriteGuard guard( *this );
+        if ( Node * found = locate( key_ ) )
+        {
+            found->m_data = new_data_;
+            return false;
+        }
+
+        Header & h = header( );
+        std::uint64_t slot = h.m_free.load( std::memory_order_relaxed );
+        if ( slot != 0 )
+            h.m_free.store( node( slot ).m_next.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+        else if ( h.m_used.load( std::memory_order_relaxed ) < h.m_capacity )
+            slot = h.m_used.fetch_add( 1, std::memory_order_relaxed ) + 1;
+        else
+            throw std::length_error( "SharedHashTbl is full" );
+
+        // Filled first, then published by the head of the chain.
+        Node & n = node( slot );
+        n.m_key = key_;
+        n.m_data = new_data_;
+        auto & head = head_of( key_ );
+        n.m_next.store( head.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+        head.store( slot, std::memory_order_release );
+        h.m_count.fetch_add( 1, std::memory_order_release );
+        return true;
+    }
+
+    // Modifies the data associated with a key in place.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Function A function accepting a DataType &.
+     *
+     * @param key_ Key of the element to modify.
+     * @param fn_ The modification, run while holding the writer lock.
+     *
+     * @return True if the key was found (and fn_ called); False otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Function >
+    bool SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::update( const KeyType & key_, Function fn_ )
+    {
+        check_writable( );
+        WriteGuard guard( *this );
+        Node * found = locate( key_ );
+        if ( found != nullptr )
+            fn_( found->m_data );
+        return found != nullptr;
+    }
+
+    // Erase element from the hash table.
+    /*!
+     * The slot goes to a free list, to be reused by the next insertion.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key of element to be removed.
+     *
+     * @return True if the key was found; False otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::erase( const KeyType & key_ )
+    {
+        check_writable( );
+        WriteGuard guard( *this );
+        KeyEqual eq;
+        Header & h = header( );
+
+        std::atomic< std::uint64_t > * link = &head_of( key_ );
+        for ( std::uint64_t slot = link->load( std::memory_order_relaxed ); slot != 0; slot = link->load( std::memory_order_relaxed ) )
+        {
+            Node & n = node( slot );
+            if ( eq( n.m_key, key_ ) )
+            {
+                link->store( n.m_next.load( std::memory_order_relaxed ), std::memory_order_release );
+                n.m_next.store( h.m_free.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+                h.m_free.store( slot, std::memory_order_relaxed );
+                h.m_count.fetch_sub( 1, std::memory_order_release );
+                return true;
+            }
+            link = &n.m_next;
+        }
+
+        return false;
+    }
+
+    // Clears the data table.
+    /*!
+     * Also makes a table left inconsistent by a dead writer usable again.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::clear( )
+    {
+        check_writable( );
+        WriteGuard guard( *this, true );
+        Header & h = header( );
+        for ( size_type i = 0; i < h.m_buckets; ++i )
+            bucket( i ).store( 0, std::memory_order_relaxed );
+        h.m_used.store( 0, std::memory_order_relaxed );
+        h.m_free.store( 0, std::memory_order_relaxed );
+        h.m_count.store( 0, std::memory_order_release );
+        h.m_damaged.store( 0, std::memory_order_release );
+    }
+
+    // Retrieves data from the table.
+    /*!
+     * Lock-free: the lookup is repeated if a write ran meanwhile. Throws
+     * std::runtime_error if the table was left inconsistent by a dead writer.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Data key to search for in the table.
+     * @param data_item_ Data record to be filled in when data item is found.
+     *
+     * @return True if the data item is found; False, otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::retrieve( const KeyType & key_, DataType & data_item_ ) const
+    {
+        KeyEqual eq;
+        const Header & h = header( );
+        const auto & head = head_of( key_ );
+        alignas( KeyType ) unsigned char key[ sizeof( KeyType ) ];
+        alignas( DataType ) unsigned char data[ sizeof( DataType ) ];
+
+        for ( size_type spins = 0; ; )
+        {
+            check_consistent( );
+            const auto seq = h.m_seq.load( std::memory_order_acquire );
+            if ( seq & 1 )
+            {
+                std::this_thread::yield( ); // A write is in progress.
+                if ( ++spins % STALL_SPINS == 0 )
+                    stalled( );
+                continue;
+            }
+
+            // Entries are copied before use: they may change under the reader.
+            bool found = false;
+            std::uint64_t slot = head.load( std::memory_order_acquire );
+            for ( size_type steps = 0; slot != 0 and slot <= h.m_capacity and steps < h.m_capacity; ++steps )
+            {
+                const Node & n = node( slot );
+                std::memcpy( key, &n.m_key, sizeof key );
+                if ( eq( *reinterpret_cast< const KeyType * >( key ), key_ ) )
+                {
+                    std::memcpy( data, &n.m_data, sizeof data );
+                    found = true;
+                    break;
+                }
+                slot = n.m_next.load( std::memory_order_acquire );
+            }
+
+            std::atomic_thread_fence( std::memory_order_acquire );
+            if ( h.m_seq.load( std::memory_order_relaxed ) == seq )
+            {
+                if ( found )
+                    std::memcpy( &data_item_, data, sizeof data );
+                return found;
+            }
+        }
+    }
+
+    // Copies every element.
+    /*!
+     * The copy is consistent: it is taken again if a write ran meanwhile. Throws
+     * std::runtime_error if the table was left inconsistent by a dead writer.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @return The elements, bucket by bucket.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    std::vector< typename SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::entry_type >
+    SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::entries( ) const
+    {
+        const Header & h = header( );
+        alignas( KeyType ) unsigned char key[ sizeof( KeyType ) ];
+        alignas( DataType ) unsigned char data[ sizeof( DataType ) ];
+        std::vector< entry_type > result;
+
+        for ( size_type spins = 0; ; )
+        {
+            check_consistent( );
+            const auto seq = h.m_seq.load( std::memory_order_acquire );
+            if ( seq & 1 )
+            {
+                std::this_thread::yield( );
+                if ( ++spins % STALL_SPINS == 0 )
+                    stalled( );
+                continue;
+            }
+
+            result.clear( );
+            size_type steps = 0;
+            for ( size_type i = 0; i < h.m_buckets; ++i )
+            {
+                std::uint64_t slot = bucket( i ).load( std::memory_order_acquire );
+                for ( ; slot != 0 and slot <= h.m_capacity and steps < h.m_capacity; ++steps )
+                {
+                    const Node & n = node( slot );
+                    std::memcpy( key, &n.m_key, sizeof key );
+                    std::memcpy( data, &n.m_data, sizeof data );
+                    result.emplace_back( *reinterpret_cast< const KeyType * >( key ), *reinterpret_cast< const DataType * >( data ) );
+                    slot = n.m_next.load( std::memory_order_acquire );
+                }
+            }
+
+            std::atomic_thread_fence( std::memory_order_acquire );
+            if ( h.m_seq.load( std::memory_order_relaxed ) == seq )
+                return result;
+        }
+    }
+
+    // Writes the changes back to the file.
+    /*!
+     * Only needed for durability: other processes see the changes at once.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::sync( )
+    {
+        if ( writable( ) and msync( m_base, m_bytes, MS_SYNC ) != 0 )
+            throw std::system_error( errno, std::generic_category( ), "cannot sync the table" );
+    }
+
+    // Takes the writer lock and starts a write.
+    /*!
+     * If the previous writer died holding the lock, the lock is recovered, and the
+     * table is marked inconsistent if the write it was doing was cut short.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param table_ The table written.
+     * @param repair_ Whether the write may start on an inconsistent table (clear() rewrites all of it).
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+	SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::WriteGuard::WriteGuard( SharedHashTbl & table_, bool repair_ )
+        : m_header{ table_.header( ) }
+	{
+        int rc = pthread_mutex_lock( &m_header.m_writer );
+        if ( rc == EOWNERDEAD )
+            recover( m_header );
+        else if ( rc != 0 )
+            throw std::system_error( rc, std::generic_category( ), "cannot lock the table" );
+
+        if ( not repair_ and m_header.m_damaged.load( std::memory_order_relaxed ) != 0 )
+        {
+            pthread_mutex_unlock( &m_header.m_writer );
+            throw std::runtime_error( "SharedHashTbl was left inconsistent by a dead writer" );
+        }
+
+        m_header.m_writer_pid.store( static_cast< std::uint64_t >( getpid( ) ), std::memory_order_relaxed );
+        m_header.m_seq.fetch_add( 1, std::memory_order_relaxed ); // Odd.
+        std::atomic_thread_fence( std::memory_order_release );
+	}
+
+    // Ends the write and releases the writer lock.
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+	SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::WriteGuard::~WriteGuard( )
+	{
+        m_header.m_seq.fetch_add( 1, std::memory_order_release );
+        m_header.m_writer_pid.store( 0, std::memory_order_relaxed );
+        pthread_mutex_unlock( &m_header.m_writer );
+	}
+
+    // Cleans up after a writer that died holding the lock, which the caller now holds.
+    /*!
+     * An odd sequence number means the write was cut short: the table is marked
+     * inconsistent and the sequence made even again, so that readers stop waiting.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param header_ The header of the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::recover( Header & header_ )
+    {
+        if ( header_.m_seq.load( std::memory_order_relaxed ) & 1 )
+        {
+            header_.m_damaged.store( 1, std::memory_order_relaxed );
+            header_.m_seq.fetch_add( 1, std::memory_order_release );
+        }
+        header_.m_writer_pid.store( 0, std::memory_order_relaxed );
+        pthread_mutex_consistent( &header_.m_writer );
+    }
+
+    // Checks on the writer, for a reader that has waited long for a write to end.
+    /*!
+     * Through a writable mapping the lock is tried, which recovers it if its owner
+     * died; through a read-only one, the writing process is looked up. Either way,
+     * a dead writer makes the reader throw std::runtime_error instead of waiting
+     * forever; a live one is waited for.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::stalled( ) const
+    {
+        Header & h = header( );
+        if ( writable( ) )
+        {
+            int rc = pthread_mutex_trylock( &h.m_writer );
+            if ( rc == EOWNERDEAD )
+                recover( h );
+            else if ( rc != 0 )
+                return; // Still writing (EBUSY).
+            pthread_mutex_unlock( &h.m_writer );
+            check_consistent( );
+        }
+        else
+        {
+            const auto pid = static_cast< pid_t >( h.m_writer_pid.load( std::memory_order_relaxed ) );
+            if ( pid != 0 and ::kill( pid, 0 ) != 0 and errno == ESRCH )
+                throw std::runtime_error( "SharedHashTbl writer died in the middle of a write" );
+        }
+    }
+
+    // A bucket head.
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    std::atomic< std::uint64_t > & SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::bucket( size_type i_ ) const
+    {
+        return reinterpret_cast< std::atomic< std::uint64_t > * >( m_base + buckets_offset( ) )[ i_ ];
+    }
+
+    // An entry slot, numbered from 1.
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::Node &
+    SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::node( std::uint64_t slot_ ) const
+    {
+        return reinterpret_cast< Node * >( m_base + nodes_offset( header( ).m_buckets ) )[ slot_ - 1 ];
+    }
+
+    // The bucket head of a key.
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    std::atomic< std::uint64_t > & SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::head_of( const KeyType & key_ ) const
+    {
+        KeyHash hashf;
+        return bucket( hashf( key_ ) % header( ).m_buckets );
+    }
+
+    // Finds the entry of a key; only called by the writer, which sees a consistent table.
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::Node *
+    SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::locate( const KeyType & key_ ) const
+    {
+        KeyEqual eq;
+        for ( auto slot = head_of( key_ ).load( std::memory_order_relaxed ); slot != 0; )
+        {
+            Node & n = node( slot );
+            if ( eq( n.m_key, key_ ) )
+                return &n;
+            slot = n.m_next.load( std::memory_order_relaxed );
+        }
+        return nullptr;
+    }
+
+    // Rejects operations on a table left inconsistent by a dead writer.
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::check_consistent( ) const
+    {
+        if ( not consistent( ) )
+            throw std::runtime_error( "SharedHashTbl was left inconsistent by a dead writer" );
+    }
+
+    // Rejects writes through a read-only mapping.
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void SharedHashTbl<KeyType,DataType,KeyHash,KeyEqual>::check_writable( ) const
+    {
+        if ( not writable( ) )
+            throw std::logic_error( "SharedHashTbl opened read-only" );
+    }
+
+} // Namespace ac.
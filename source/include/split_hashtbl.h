@@ -0,0 +1,89 @@
+/*!
+ * @file split_hashtbl.h
+ * @brief Hash table that keeps the data apart from the keys.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _SPLIT_HASHTBL_H_
+#define _SPLIT_HASHTBL_H_
+
+#include <deque>            // deque
+#include <functional>       // hash, equal_to
+#include <iostream>         // ostream
+#include <optional>         // optional
+#include <stdexcept>        // out_of_range
+#include <vector>           // vector
+
+#include "hashtbl.h"        // HashTbl
+
+namespace ac // Associative container
+{
+    /*!
+     * This class implements a hash table for large data items, whose chains hold
+     * only the keys and the slot of each data item in a separate value store.
+     *
+     * Scanning a chain (every lookup, and every miss in full) and rehashing thus
+     * move keys and slot numbers through the cache, never the data; the data item
+     * is read once, after the key matched. Data items never move: pointers from
+     * find() stay valid until the element is erased. Erased slots are reused.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< class KeyType,
+		      class DataType,
+		      class KeyHash = std::hash< KeyType >,
+		      class KeyEqual = std::equal_to< KeyType > >
+	class SplitHashTbl {
+        public:
+            // Aliases
+            using size_type = std::size_t;
+            using index_type = HashTbl< KeyType, size_type, KeyHash, KeyEqual >;
+
+            /// Constructors
+            explicit SplitHashTbl( size_type table_sz_ = DEFAULT_SIZE ) : m_index( table_sz_ ) {/*Empty*/}
+
+            /// Class methods
+            bool insert( const KeyType &, const DataType & );
+            bool retrieve( const KeyType &, DataType & ) const;
+            DataType* find( const KeyType & );
+            const DataType* find( const KeyType & ) const;
+            template< class Function >
+            bool update( const KeyType &, Function );
+            bool erase( const KeyType & );
+            void clear( );
+            bool empty( ) const { return m_index.empty(); };
+            size_type size( ) const { return m_index.size(); };
+            DataType& at( const KeyType & );
+            DataType& operator[]( const KeyType & );
+            size_type count( const KeyType & key_ ) const { return m_index.find( key_ ) != nullptr; };
+            size_type bucket_count( ) const { return m_index.bucket_count(); };
+            float load_factor( ) const { return m_index.load_factor(); };
+            void reserve( size_type );
+            const index_type & index( ) const { return m_index; };
+            template< class Function >
+            void for_each( Function ) const;
+
+            /// Friend functions
+            friend std::ostream & operator<<( std::ostream & os_, const SplitHashTbl & ht_ ) {
+                ht_.for_each( [ & ]( const KeyType &, const DataType & data_ ){ os_ << data_ << "\n"; } );
+                return os_;
+            }
+
+        private:
+            /// Private methods
+            size_type store( const DataType & );
+
+        private:
+            index_type m_index;                               //!< Key to slot of the data.
+            std::deque< std::optional< DataType > > m_values; //!< The data; a deque never moves its elements.
+            std::vector< size_type > m_free;                  //!< Empty slots of m_values.
+            static const short DEFAULT_SIZE = 11;
+    };
+
+} // Namespace ac.
+#include "split_hashtbl.inl"
+#endif
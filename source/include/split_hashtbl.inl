@@ -0,0 +1,264 @@
+/*!
+ * @file split_hashtbl.inl
+ * @brief Implementation of the SplitHashTbl class methods.
+ *
+ * @author Lucas Bazante
+ */
+
+#include "split_hashtbl.h"
+
+namespace ac {
+
+    /// CLASS METHODS
+
+    // Inserts data into the hash table according to the associated key.
+    /*!
+     * Inserts the new entry if the key does not exist and updates the data otherwise.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key associated with data.
+     * @param new_data_ New data to be inserted/updated.
+     *
+     * @return True if the insertion was successful; False if the key already existed.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool SplitHashTbl<KeyType,DataType,KeyHash,KeyEqual>::insert( const KeyType & key_, const DataType & new_data_ )
+    {
+        return m_index.upsert( key_, [ & ]{ return store( new_data_ ); },
+                                     [ & ]( size_type slot_ ){ *m_values[ slot_ ] = new_data_; } );
+    }
+
+    // Retrieves data from the table.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Data key to search for in the table.
+     * @param data_item_ Data record to be filled in when data item is found.
+     *
+     * @return True if the data item is found; False, otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool SplitHashTbl<KeyType,DataType,KeyHash,KeyEqual>::retrieve( const KeyType & key_, DataType & data_item_ ) const
+    {
+        auto data = find( key_ );
+        if ( data != nullptr )
+            data_item_ = *data;
+        return data != nullptr;
+    }
+
+    // Locates the data associated with a key.
+    /*!
+     * The pointer remains valid until the element is erased.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Data key to search for in the table.
+     *
+     * @return Pointer to the data associated with the key, or nullptr if the key is not in the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    const DataType* SplitHashTbl<KeyType,DataType,KeyHash,KeyEqual>::find( const KeyType & key_ ) const
+    {
+        auto slot = m_index.find( key_ );
+        return slot == nullptr ? nullptr : &*m_values[ *slot ];
+    }
+
+    // Locates the data associated with a key.
+    /*!
+     * Non-const version of find().
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Data key to search for in the table.
+     *
+     * @return Pointer to the data associated with the key, or nullptr if the key is not in the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    DataType* SplitHashTbl<KeyType,DataType,KeyHash,KeyEqual>::find( const KeyType & key_ )
+    {
+        auto slot = m_index.find( key_ );
+        return slot == nullptr ? nullptr : &*m_values[ *slot ];
+    }
+
+    // Modifies the data associated with a key in place.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Function A function accepting a DataType &.
+     *
+     * @param key_ Key of the element to modify.
+     * @param fn_ The modification.
+     *
+     * @return True if the key was found (and fn_ called); False otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Function >
+    bool SplitHashTbl<KeyType,DataType,KeyHash,KeyEqual>::update( const KeyType & key_, Function fn_ )
+    {
+        auto data = find( key_ );
+        if ( data != nullptr )
+            fn_( *data );
+        return data != nullptr;
+    }
+
+    // Erase element from the hash table.
+    /*!
+     * The data item is destroyed and its slot reused by a later insertion.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key of element to be removed.
+     *
+     * @return True if the key was found; False otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    bool SplitHashTbl<KeyType,DataType,KeyHash,KeyEqual>::erase( const KeyType & key_ )
+    {
+        // One walk of the chain: compute() hands over the slot and drops the key.
+        bool found = false;
+        m_index.compute( key_, [ & ]( size_type slot_, bool present_ ){
+            if ( present_ )
+            {
+                m_values[ slot_ ].reset( );
+                m_free.push_back( slot_ );
+                found = true;
+            }
+            return false;
+        } );
+        return found;
+    }
+
+    // Clears the data table.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void SplitHashTbl<KeyType,DataType,KeyHash,KeyEqual>::clear( )
+    {
+        m_index.clear( );
+        m_values.clear( );
+        m_free.clear( );
+    }
+
+    // Reference to the element at given position.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key to wanted element.
+     *
+     * @return Data associated with the key.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    DataType& SplitHashTbl<KeyType,DataType,KeyHash,KeyEqual>::at( const KeyType & key_ )
+    {
+        auto data = find( key_ );
+        if ( data != nullptr )
+            return *data;
+
+        throw std::out_of_range( "Not present" );
+    }
+
+    // Accesses the element associated with the key or inserts a new element.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param key_ Key possibly associated with an element in the table.
+     *
+     * @return A reference to the data associated with the key.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    DataType& SplitHashTbl<KeyType,DataType,KeyHash,KeyEqual>::operator[]( const KeyType & key_ )
+    {
+        size_type slot = 0;
+        m_index.upsert( key_, [ & ]{ return slot = store( DataType{ } ); },
+                              [ & ]( size_type slot_ ){ slot = slot_; } );
+        return *m_values[ slot ];
+    }
+
+    // Prepares the table to hold a number of elements.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param n_ Number of elements expected in the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    void SplitHashTbl<KeyType,DataType,KeyHash,KeyEqual>::reserve( size_type n_ )
+    {
+        m_index.reserve( n_ );
+    }
+
+    // Visits every element of the table.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam Function A function accepting a key and a data item.
+     *
+     * @param fn_ The function to be called.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    template< typename Function >
+    void SplitHashTbl<KeyType,DataType,KeyHash,KeyEqual>::for_each( Function fn_ ) const
+    {
+        m_index.for_each( [ & ]( const KeyType & key_, size_type slot_ ){ fn_( key_, *m_values[ slot_ ] ); } );
+    }
+
+    // Puts a data item in the value store.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     *
+     * @param data_ The data item.
+     *
+     * @return Its slot: a free one if any, a new one otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual >
+    typename SplitHashTbl<KeyType,DataType,KeyHash,KeyEqual>::size_type
+    SplitHashTbl<KeyType,DataType,KeyHash,KeyEqual>::store( const DataType & data_ )
+    {
+        if ( m_free.empty( ) )
+        {
+            m_values.emplace_back( data_ );
+            return m_values.size( ) - 1;
+        }
+
+        const size_type slot = m_free.back( );
+        m_free.pop_back( );
+        m_values[ slot ].emplace( data_ );
+        return slot;
+    }
+
+} // Namespace ac.
@@ -0,0 +1,92 @@
+/*!
+ * @file timer_wheel.h
+ * @brief Hierarchical timer wheel with intrusive timers.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _TIMER_WHEEL_H_
+#define _TIMER_WHEEL_H_
+
+#include <algorithm>        // min
+#include <cstdint>          // uint64_t
+
+namespace ac // Associative container
+{
+    /*!
+     * This class implements a hierarchical timer wheel (Varghese & Lauck).
+     *
+     * Time is measured in ticks. Level 0 has one slot per tick for the next 64
+     * ticks, level 1 one slot per 64 ticks for the next 64^2 ticks, and so on.
+     * When the wheel reaches the start of a slot of an upper level, the timers of
+     * that slot are cascaded into the lower levels. Timers whose expiry has been
+     * reached are moved to a due list, from which the client pops them at its own
+     * pace. Scheduling and cancelling are O(1), and advancing costs O(1) per timer
+     * moved plus O(1) per non-empty stretch of ticks (empty stretches are skipped).
+     *
+     * Timers are intrusive: the client embeds a Node in its own records, and a node
+     * unlinks itself from the wheel when it is destroyed. Nodes must not be moved
+     * while scheduled; copying a node yields an unscheduled node.
+     *
+     * @tparam KeyType Type of the key each timer carries back to the client.
+     */
+    template< class KeyType >
+    class TimerWheel {
+        public:
+            /// Links of a circular doubly linked list.
+            struct Link {
+                Link * m_prev = nullptr;
+                Link * m_next = nullptr;
+
+                Link( ) = default;
+                Link( const Link & ) { /* A copy is never linked. */ }
+                Link & operator=( const Link & ) { return *this; }
+                ~Link( ) { unlink( ); }
+
+                bool linked( ) const { return m_next != nullptr; }
+                void unlink( )
+                {
+                    if ( not linked( ) )
+                        return;
+                    m_prev->m_next = m_next;
+                    m_next->m_prev = m_prev;
+                    m_prev = m_next = nullptr;
+                }
+            };
+
+            /// A timer.
+            struct Node : Link {
+                std::uint64_t m_expiry = 0; //!< Tick at which the timer fires.
+                KeyType m_key{};            //!< Client key.
+            };
+
+            /// Constructors
+            explicit TimerWheel( std::uint64_t now_ = 0 );
+            TimerWheel( const TimerWheel & ) = delete;
+            TimerWheel & operator=( const TimerWheel & ) = delete;
+
+            /// Class methods
+            void schedule( Node & );
+            void advance( std::uint64_t );
+            Node * pop_due( );
+            std::uint64_t now( ) const { return m_now; };
+
+        private:
+            /// Private methods
+            static void append( Link &, Link & );
+            void cascade( unsigned, unsigned );
+            bool level_empty( unsigned ) const;
+
+        private:
+            static constexpr unsigned SLOT_BITS = 6;             //!< log2 of the number of slots per level.
+            static constexpr unsigned SLOTS = 1u << SLOT_BITS;   //!< Slots per level.
+            static constexpr unsigned LEVELS = 4;                //!< Number of levels.
+
+            Link m_slots[ LEVELS ][ SLOTS ]; //!< Sentinels of the slot lists.
+            Link m_due;                      //!< Sentinel of the list of expired timers.
+            std::uint64_t m_now;             //!< Current tick.
+    };
+
+} // Namespace ac.
+#include "timer_wheel.inl"
+#endif
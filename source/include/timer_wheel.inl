@@ -0,0 +1,193 @@
+/*!
+ * @file timer_wheel.inl
+ * @brief Implementation of the TimerWheel class methods.
+ *
+ * @author Lucas Bazante
+ */
+
+#include "timer_wheel.h"
+
+namespace ac {
+
+    /// CONSTRUCTORS
+
+    // Regular constructor.
+    /*!
+     * This constructor creates an empty wheel.
+     *
+     * @tparam KeyType Type of the key each timer carries back to the client.
+     *
+     * @param now_ The current tick.
+     */
+    template< typename KeyType >
+    TimerWheel<KeyType>::TimerWheel( std::uint64_t now_ ) : m_now{ now_ }
+    {
+        for ( auto & level : m_slots )
+            for ( auto & slot : level )
+                slot.m_prev = slot.m_next = &slot;
+        m_due.m_prev = m_due.m_next = &m_due;
+    }
+
+    /// CLASS METHODS
+
+    // Schedules a timer.
+    /*!
+     * The timer fires when the wheel reaches node_.m_expiry. A timer already
+     * scheduled is rescheduled; one whose expiry has been reached is due at once.
+     *
+     * @tparam KeyType Type of the key each timer carries back to the client.
+     *
+     * @param node_ The timer.
+     */
+    template< typename KeyType >
+    void TimerWheel<KeyType>::schedule( Node & node_ )
+    {
+        node_.unlink( );
+        if ( node_.m_expiry <= m_now )
+        {
+            append( m_due, node_ );
+            return;
+        }
+
+        const std::uint64_t delta = node_.m_expiry - m_now;
+        unsigned level = 0;
+        while ( level + 1 < LEVELS and delta >> ( SLOT_BITS * ( level + 1 ) ) != 0 )
+            ++level;
+
+        // Timers beyond the range of the wheel wait in the farthest slot and are cascaded again.
+        std::uint64_t when = node_.m_expiry;
+        if ( delta >> ( SLOT_BITS * LEVELS ) != 0 )
+            when = m_now + ( std::uint64_t{ 1 } << ( SLOT_BITS * LEVELS ) ) - 1;
+
+        append( m_slots[ level ][ ( when >> ( SLOT_BITS * level ) ) & ( SLOTS - 1 ) ], node_ );
+    }
+
+    // Advances the wheel.
+    /*!
+     * Moves the wheel, tick by tick, up to now_; timers that expire on the way
+     * are moved to the due list. Stretches in which the lower levels are empty
+     * are skipped in one step, since nothing can fire or cascade there.
+     *
+     * @tparam KeyType Type of the key each timer carries back to the client.
+     *
+     * @param now_ The new current tick.
+     */
+    template< typename KeyType >
+    void TimerWheel<KeyType>::advance( std::uint64_t now_ )
+    {
+        while ( m_now < now_ )
+        {
+            unsigned empty = 0;
+            while ( empty < LEVELS and level_empty( empty ) )
+                ++empty;
+
+            if ( empty == LEVELS )
+            {
+                m_now = now_;
+                break;
+            }
+            if ( empty > 0 )
+            {
+                // Jump to the tick just before the next cascade of the first non-empty level.
+                const std::uint64_t last = m_now | ( ( std::uint64_t{ 1 } << ( SLOT_BITS * empty ) ) - 1 );
+                if ( last > m_now )
+                {
+                    m_now = std::min( last, now_ );
+                    continue;
+                }
+            }
+
+            ++m_now;
+
+            // Upper levels first: a cascade may feed the slot of the level below.
+            for ( unsigned level = LEVELS - 1; level > 0; --level )
+                if ( ( m_now & ( ( std::uint64_t{ 1 } << ( SLOT_BITS * level ) ) - 1 ) ) == 0 )
+                    cascade( level, ( m_now >> ( SLOT_BITS * level ) ) & ( SLOTS - 1 ) );
+
+            // The whole level 0 slot is due: splice it onto the due list.
+            Link & slot = m_slots[ 0 ][ m_now & ( SLOTS - 1 ) ];
+            if ( slot.m_next != &slot )
+            {
+                slot.m_next->m_prev = m_due.m_prev;
+                m_due.m_prev->m_next = slot.m_next;
+                slot.m_prev->m_next = &m_due;
+                m_due.m_prev = slot.m_prev;
+                slot.m_prev = slot.m_next = &slot;
+            }
+        }
+    }
+
+    // Removes the next expired timer.
+    /*!
+     * @tparam KeyType Type of the key each timer carries back to the client.
+     *
+     * @return The timer, now unscheduled, or nullptr if no timer is due.
+     */
+    template< typename KeyType >
+    typename TimerWheel<KeyType>::Node * TimerWheel<KeyType>::pop_due( )
+    {
+        if ( m_due.m_next == &m_due )
+            return nullptr;
+
+        auto node = static_cast< Node * >( m_due.m_next );
+        node->unlink( );
+        return node;
+    }
+
+    // Checks whether a level has no timers.
+    /*!
+     * @tparam KeyType Type of the key each timer carries back to the client.
+     *
+     * @param level_ The level.
+     *
+     * @return True if all slots of the level are empty; False otherwise.
+     */
+    template< typename KeyType >
+    bool TimerWheel<KeyType>::level_empty( unsigned level_ ) const
+    {
+        for ( const auto & slot : m_slots[ level_ ] )
+            if ( slot.m_next != &slot )
+                return false;
+        return true;
+    }
+
+    // Appends a link to a list.
+    /*!
+     * @tparam KeyType Type of the key each timer carries back to the client.
+     *
+     * @param head_ Sentinel of the list.
+     * @param link_ The link, which must not be linked.
+     */
+    template< typename KeyType >
+    void TimerWheel<KeyType>::append( Link & head_, Link & link_ )
+    {
+        link_.m_prev = head_.m_prev;
+        link_.m_next = &head_;
+        head_.m_prev->m_next = &link_;
+        head_.m_prev = &link_;
+    }
+
+    // Redistributes the timers of a slot into the lower levels.
+    /*!
+     * @tparam KeyType Type of the key each timer carries back to the client.
+     *
+     * @param level_ Level of the slot.
+     * @param slot_ Index of the slot.
+     */
+    template< typename KeyType >
+    void TimerWheel<KeyType>::cascade( unsigned level_, unsigned slot_ )
+    {
+        Link & head = m_slots[ level_ ][ slot_ ];
+        Link * link = head.m_next;
+        head.m_prev = head.m_next = &head;
+
+        while ( link != &head )
+        {
+            Link * next = link->m_next;
+            link->m_prev = link->m_next = nullptr;
+            schedule( static_cast< Node & >( *link ) );
+            link = next;
+        }
+    }
+
+} // Namespace ac.
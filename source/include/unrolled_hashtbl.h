@@ -0,0 +1,141 @@
+/*!
+ * @file unrolled_hashtbl.h
+ * @brief Chained hash table whose chain nodes are cache-line blocks of entries.
+ *
+ * @author Lucas Bazante
+ */
+
+#ifndef _UNROLLED_HASHTBL_H_
+#define _UNROLLED_HASHTBL_H_
+
+#include <algorithm>        // max, min, swap
+#include <cstdint>          // uint8_t, uint64_t
+#include <cstring>          // memcpy
+#include <functional>       // hash, equal_to
+#include <iostream>         // ostream
+#include <memory>           // unique_ptr
+#include <new>              // launder
+#include <stdexcept>        // out_of_range
+#include <type_traits>      // conditional_t, aligned_storage_t
+#include <utility>          // pair, move
+
+#include "hash_entry.h"     // HashEntry
+#include "hash_mix.h"       // mix64
+#include "hash_primes.h"    // next_prime
+
+namespace ac // Associative container
+{
+    /*!
+     * This class implements a chained hash table where each chain node is a block
+     * holding several entries, instead of one list node per entry.
+     *
+     * A block starts with one fingerprint byte per entry (taken from the high bits
+     * of the mixed hash), all compared at once, so that the keys of the other
+     * entries are not read. Entries are stored in the block itself, which for small
+     * entries fits a cache line; with StablePointers the block holds pointers to
+     * separately allocated entries (six per cache line) and an entry never moves
+     * until it is erased, rehashing included.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam StablePointers Whether references to the data must survive insertions and rehashing.
+     */
+	template< class KeyType,
+		      class DataType,
+		      class KeyHash = std::hash< KeyType >,
+		      class KeyEqual = std::equal_to< KeyType >,
+              bool StablePointers = false >
+	class UnrolledHashTbl {
+        public:
+            // Aliases
+            using entry_type = HashEntry<KeyType,DataType>;
+            using size_type = std::size_t;
+
+            /// Entries per block: as many as fit a cache line after the header (2 to 7).
+            static constexpr size_type SLOTS = StablePointers ? 6
+                : std::max< size_type >( 2, std::min< size_type >( 7, 48 / sizeof( entry_type ) ) );
+
+        private:
+            using slot_type = std::conditional_t< StablePointers, entry_type *,
+                                                  std::aligned_storage_t< sizeof( entry_type ), alignof( entry_type ) > >;
+
+            /// A chain node.
+            struct alignas( 64 ) Block {
+                Block * m_next = nullptr;          //!< Next block of the bucket.
+                std::uint8_t m_tags[ 7 ] = { };    //!< Fingerprints of the entries.
+                std::uint8_t m_used = 0;           //!< Entries in use (the first ones).
+                slot_type m_slots[ SLOTS ];        //!< The entries, or pointers to them.
+
+                entry_type * entry( size_type i_ )
+                {
+                    if constexpr ( StablePointers )
+                        return m_slots[ i_ ];
+                    else
+                        return std::launder( reinterpret_cast< entry_type * >( &m_slots[ i_ ] ) );
+                }
+            };
+            static_assert( SLOTS <= 7, "one tag byte per slot, in the first 8 bytes after the link" );
+
+        public:
+            /// Constructors
+            explicit UnrolledHashTbl( size_type table_sz_ = DEFAULT_SIZE );
+            UnrolledHashTbl( const UnrolledHashTbl & );
+            UnrolledHashTbl( UnrolledHashTbl && ) noexcept;
+
+            /// Overloaded operators
+            UnrolledHashTbl & operator=( UnrolledHashTbl );
+
+            /// Destructor
+            ~UnrolledHashTbl();
+
+            /// Class methods
+            bool insert( const KeyType &, const DataType & );
+            bool retrieve( const KeyType &, DataType & ) const;
+            DataType* find( const KeyType & );
+            const DataType* find( const KeyType & ) const;
+            bool erase( const KeyType & );
+            void clear();
+            bool empty() const { return m_count == 0; };
+            size_type size() const { return m_count; };
+            DataType& at( const KeyType & );
+            DataType& operator[]( const KeyType & );
+            size_type count( const KeyType & key_ ) const { return find( key_ ) != nullptr; };
+            float load_factor() const { return ( float ) m_count / m_size; };
+            float max_load_factor() const { return m_max_load_factor; };
+            void max_load_factor( float mlf ) { m_max_load_factor = mlf; };
+            size_type bucket_count() const { return m_size; };
+            size_type block_count() const { return m_blocks; };
+            void reserve( size_type );
+            template< class Function >
+            void for_each( Function ) const;
+
+            /// Friend functions
+            friend std::ostream & operator<<( std::ostream & os_, const UnrolledHashTbl & ht_ ) {
+                ht_.for_each( [ & ]( const KeyType &, const DataType & data_ ){ os_ << data_ << "\n"; } );
+                return os_;
+            }
+
+        private:
+            /// Private methods
+            static std::uint8_t tag_of( std::size_t h_ ) { return static_cast< std::uint8_t >( mix64( h_ ) >> 56 ); };
+            std::pair< Block *, size_type > locate( const KeyType &, std::size_t, Block ** prev_ = nullptr ) const;
+            std::pair< Block *, size_type > reserve_slot( Block *&, std::uint8_t );
+            template< class... Args >
+            entry_type * emplace( std::size_t, Args &&... );
+            void release( Block * );
+            void rehash( size_type );
+
+        private:
+            std::unique_ptr< Block * [] > m_table; //!< Bucket array: first block of each chain.
+            size_type m_size;                      //!< Table size.
+            size_type m_count;                     //!< Number of elements in the table.
+            size_type m_blocks;                    //!< Number of blocks allocated.
+            float m_max_load_factor = 1.0f;        //!< Grow when the load factor exceeds this.
+            static const short DEFAULT_SIZE = 11;
+    };
+
+} // Namespace ac.
+#include "unrolled_hashtbl.inl"
+#endif
@@ -0,0 +1,570 @@
+/*!
+ * @file unrolled_hashtbl.inl
+ * @brief Implementation of the UnrolledHashTbl class methods.
+ *
+ * @author Lucas Bazante
+ */
+
+#include "unrolled_hashtbl.h"
+
+namespace ac {
+
+    /// CONSTRUCTORS
+
+    // Size constructor.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam StablePointers Whether entries are allocated separately.
+     *
+     * @param table_sz_ The minimun number of buckets.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, bool StablePointers >
+	UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::UnrolledHashTbl( size_type table_sz_ )
+	{
+        m_size = detail::next_prime( table_sz_ );
+        m_count = 0;
+        m_blocks = 0;
+        m_table = std::make_unique< Block * [] >( m_size ); // All null.
+	}
+
+    // Copy constructor.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam StablePointers Whether entries are allocated separately.
+     *
+     * @param source_ Hash table to be copied.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, bool StablePointers >
+	UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::UnrolledHashTbl( const UnrolledHashTbl & source_ )
+        : UnrolledHashTbl( source_.m_size - 1 )
+	{
+        KeyHash hashf;
+        m_max_load_factor = source_.m_max_load_factor;
+        source_.for_each( [ & ]( const KeyType & key_, const DataType & data_ ){ emplace( hashf( key_ ), key_, data_ ); } );
+        m_count = source_.m_count;
+	}
+
+    // Move constructor.
+    /*!
+     * The source is left empty, with no bucket array: it may only be destroyed or assigned to.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam StablePointers Whether entries are allocated separately.
+     *
+     * @param source_ Hash table to be moved.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, bool StablePointers >
+	UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::UnrolledHashTbl( UnrolledHashTbl && source_ ) noexcept
+        : m_table{ std::move( source_.m_table ) }, m_size{ source_.m_size }, m_count{ source_.m_count },
+          m_blocks{ source_.m_blocks }, m_max_load_factor{ source_.m_max_load_factor }
+	{
+        source_.m_size = source_.m_count = source_.m_blocks = 0;
+	}
+
+    /// OVERLOADED OPERATORS
+
+    // Assignment operator.
+    /*!
+     * Copy (or move) and swap.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam StablePointers Whether entries are allocated separately.
+     *
+     * @param clone_ The hash table to be cloned.
+     *
+     * @return A reference to the modified hash table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, bool StablePointers >
+	UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers> &
+    UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::operator=( UnrolledHashTbl clone_ )
+    {
+        std::swap( m_table, clone_.m_table );
+        std::swap( m_size, clone_.m_size );
+        std::swap( m_count, clone_.m_count );
+        std::swap( m_blocks, clone_.m_blocks );
+        std::swap( m_max_load_factor, clone_.m_max_load_factor );
+        return *this;
+    }
+
+    /// DESTRUCTOR
+
+    // Class destructor.
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, bool StablePointers >
+	UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::~UnrolledHashTbl( )
+	{
+        clear( );
+	}
+
+    /// CLASS METHODS
+
+    // Inserts data into the hash table according to the associated key.
+    /*!
+     * Inserts the new entry if the key does not exist and updates the data otherwise.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam StablePointers Whether entries are allocated separately.
+     *
+     * @param key_ Key associated with data.
+     * @param new_data_ New data to be inserted/updated.
+     *
+     * @return True if the insertion was successful; False if the key already existed.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, bool StablePointers >
+    bool UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::insert( const KeyType & key_, const DataType & new_data_ )
+    {
+        KeyHash hashf;
+        const auto h = hashf( key_ );
+        auto found = locate( key_, h );
+        if ( found.first != nullptr )
+        {
+            found.first->entry( found.second )->m_data = new_data_;
+            return false;
+        }
+
+        emplace( h, key_, new_data_ );
+        if ( ++m_count > m_max_load_factor * m_size )
+            rehash( detail::next_prime( 2 * m_size ) );
+
+        return true;
+    }
+
+    // Retrieves data from the table.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam StablePointers Whether entries are allocated separately.
+     *
+     * @param key_ Data key to search for in the table.
+     * @param data_item_ Data record to be filled in when data item is found.
+     *
+     * @return True if the data item is found; False, otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, bool StablePointers >
+    bool UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::retrieve( const KeyType & key_, DataType & data_item_ ) const
+    {
+        auto data = find( key_ );
+        if ( data != nullptr )
+            data_item_ = *data;
+        return data != nullptr;
+    }
+
+    // Locates the data associated with a key.
+    /*!
+     * Without StablePointers, the pointer is valid until the next insertion or erasure;
+     * with it, until the element is erased.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam StablePointers Whether entries are allocated separately.
+     *
+     * @param key_ Data key to search for in the table.
+     *
+     * @return Pointer to the data associated with the key, or nullptr if the key is not in the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, bool StablePointers >
+    const DataType* UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::find( const KeyType & key_ ) const
+    {
+        KeyHash hashf;
+        auto found = locate( key_, hashf( key_ ) );
+        return found.first == nullptr ? nullptr : &found.first->entry( found.second )->m_data;
+    }
+
+    // Locates the data associated with a key.
+    /*!
+     * Non-const version of find().
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam StablePointers Whether entries are allocated separately.
+     *
+     * @param key_ Data key to search for in the table.
+     *
+     * @return Pointer to the data associated with the key, or nullptr if the key is not in the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, bool StablePointers >
+    DataType* UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::find( const KeyType & key_ )
+    {
+        return const_cast< DataType* >( static_cast< const UnrolledHashTbl & >( *this ).find( key_ ) );
+    }
+
+    // Erase element from the hash table.
+    /*!
+     * The last entry of the block takes the place of the erased one; a block left
+     * empty is unlinked and freed.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam StablePointers Whether entries are allocated separately.
+     *
+     * @param key_ Key of element to be removed.
+     *
+     * @return True if the key was found; False otherwise.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, bool StablePointers >
+    bool UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::erase( const KeyType & key_ )
+    {
+        KeyHash hashf;
+        const auto h = hashf( key_ );
+        Block * prev = nullptr;
+        auto found = locate( key_, h, &prev );
+        if ( found.first == nullptr )
+            return false;
+
+        Block * block = found.first;
+        const size_type i = found.second, last = block->m_used - 1;
+        if constexpr ( StablePointers )
+        {
+            delete block->m_slots[ i ];
+            block->m_slots[ i ] = block->m_slots[ last ];
+        }
+        else
+        {
+            if ( i != last )
+                *block->entry( i ) = std::move( *block->entry( last ) );
+            block->entry( last )->~entry_type( );
+        }
+        block->m_tags[ i ] = block->m_tags[ last ];
+        --block->m_used;
+
+        if ( block->m_used == 0 )
+        {
+            ( prev == nullptr ? m_table[ h % m_size ] : prev->m_next ) = block->m_next;
+            delete block;
+            --m_blocks;
+        }
+
+        --m_count;
+        return true;
+    }
+
+    // Clears the data table.
+    /*!
+     * Frees every block; the bucket array is kept.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam StablePointers Whether entries are allocated separately.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, bool StablePointers >
+    void UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::clear()
+    {
+        for ( size_type i = 0; i < m_size; ++i )
+        {
+            for ( Block * block = m_table[ i ]; block != nullptr; )
+            {
+                Block * next = block->m_next;
+                release( block );
+                block = next;
+            }
+            m_table[ i ] = nullptr;
+        }
+        m_count = m_blocks = 0;
+    }
+
+    // Reference to the element at given position.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam StablePointers Whether entries are allocated separately.
+     *
+     * @param key_ Key to wanted element.
+     *
+     * @return Data associated with the key.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, bool StablePointers >
+    DataType& UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::at( const KeyType & key_ )
+    {
+        auto data = find( key_ );
+        if ( data != nullptr )
+            return *data;
+
+        throw std::out_of_range( "Not present" );
+    }
+
+    // Accesses the element associated with the key or inserts a new element.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam StablePointers Whether entries are allocated separately.
+     *
+     * @param key_ Key possibly associated with an element in the table.
+     *
+     * @return A reference to the data associated with the key.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, bool StablePointers >
+    DataType& UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::operator[]( const KeyType & key_ )
+    {
+        KeyHash hashf;
+        const auto h = hashf( key_ );
+        auto found = locate( key_, h );
+        if ( found.first != nullptr )
+            return found.first->entry( found.second )->m_data;
+
+        entry_type * en = emplace( h, key_, DataType{ } );
+        if ( ++m_count > m_max_load_factor * m_size )
+        {
+            rehash( detail::next_prime( 2 * m_size ) );
+            if constexpr ( not StablePointers )
+                return *find( key_ ); // The entry has moved.
+        }
+
+        return en->m_data;
+    }
+
+    // Prepares the table to hold a number of elements.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam StablePointers Whether entries are allocated separately.
+     *
+     * @param n_ Number of elements expected in the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, bool StablePointers >
+    void UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::reserve( size_type n_ )
+    {
+        auto needed = static_cast< size_type >( n_ / m_max_load_factor ) + 1;
+        if ( needed > m_size )
+            rehash( detail::next_prime( needed - 1 ) );
+    }
+
+    // Visits every element of the table.
+    /*!
+     * Calls fn_( key, data ) for each element, bucket by bucket.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam StablePointers Whether entries are allocated separately.
+     * @tparam Function A function accepting a key and a data item.
+     *
+     * @param fn_ The function to be called.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, bool StablePointers >
+    template< typename Function >
+    void UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::for_each( Function fn_ ) const
+    {
+        for ( size_type i = 0; i < m_size; ++i )
+            for ( Block * block = m_table[ i ]; block != nullptr; block = block->m_next )
+                for ( size_type s = 0; s < block->m_used; ++s )
+                    fn_( block->entry( s )->m_key, static_cast< const DataType & >( block->entry( s )->m_data ) );
+    }
+
+    // Finds the slot of a key.
+    /*!
+     * The fingerprints of a block are compared to the key's all at once; only the
+     * entries with a matching fingerprint are compared with the key.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam StablePointers Whether entries are allocated separately.
+     *
+     * @param key_ The key.
+     * @param h_ Hash of the key.
+     * @param prev_ If not null, receives the block before the one found (null for the first).
+     *
+     * @return The block and slot of the key, or a null block if it is not in the table.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, bool StablePointers >
+    std::pair< typename UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::Block *,
+               typename UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::size_type >
+    UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::locate( const KeyType & key_, std::size_t h_, Block ** prev_ ) const
+    {
+        KeyEqual eq;
+        const std::uint64_t ONES = 0x0101010101010101ull;
+        const std::uint64_t pattern = ONES * tag_of( h_ );
+
+        Block * prev = nullptr;
+        for ( Block * block = m_table[ h_ % m_size ]; block != nullptr; prev = block, block = block->m_next )
+        {
+            // Bytes equal to the tag get their high bit set (bytes above a match may too).
+            std::uint64_t tags;
+            std::memcpy( &tags, block->m_tags, sizeof tags );
+            const std::uint64_t x = tags ^ pattern;
+            std::uint64_t match = ( x - ONES ) & ~x & ( ONES << 7 );
+
+            for ( ; match != 0; match &= match - 1 )
+            {
+#if defined( __BYTE_ORDER__ ) and __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+                const size_type s = 7 - __builtin_ctzll( match ) / 8;
+#else
+                const size_type s = __builtin_ctzll( match ) / 8;
+#endif
+                if ( s < block->m_used and eq( block->entry( s )->m_key, key_ ) )
+                {
+                    if ( prev_ != nullptr )
+                        *prev_ = prev;
+                    return { block, s };
+                }
+            }
+        }
+
+        return { nullptr, 0 };
+    }
+
+    // Claims a free slot in a chain.
+    /*!
+     * The first block is used if it has room; otherwise a new first block is linked.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam StablePointers Whether entries are allocated separately.
+     *
+     * @param head_ The first block of the chain.
+     * @param tag_ Fingerprint of the entry that will use the slot.
+     *
+     * @return The block and the slot, still to be constructed.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, bool StablePointers >
+    std::pair< typename UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::Block *,
+               typename UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::size_type >
+    UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::reserve_slot( Block *& head_, std::uint8_t tag_ )
+    {
+        if ( head_ == nullptr or head_->m_used == SLOTS )
+        {
+            Block * block = new Block;
+            block->m_next = head_;
+            head_ = block;
+            ++m_blocks;
+        }
+
+        head_->m_tags[ head_->m_used ] = tag_;
+        return { head_, head_->m_used++ };
+    }
+
+    // Constructs a new entry in its bucket.
+    /*!
+     * The key must not be in the table. The element count is left to the caller.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam StablePointers Whether entries are allocated separately.
+     * @tparam Args Arguments of the entry constructor.
+     *
+     * @param h_ Hash of the key.
+     * @param args_ Key and data.
+     *
+     * @return The new entry.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, bool StablePointers >
+    template< typename... Args >
+    typename UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::entry_type *
+    UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::emplace( std::size_t h_, Args &&... args_ )
+    {
+        auto slot = reserve_slot( m_table[ h_ % m_size ], tag_of( h_ ) );
+        if constexpr ( StablePointers )
+            return slot.first->m_slots[ slot.second ] = new entry_type( std::forward< Args >( args_ )... );
+        else
+            return new ( &slot.first->m_slots[ slot.second ] ) entry_type( std::forward< Args >( args_ )... );
+    }
+
+    // Destroys the entries of a block and frees it.
+    /*!
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam StablePointers Whether entries are allocated separately.
+     *
+     * @param block_ The block.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, bool StablePointers >
+    void UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::release( Block * block_ )
+    {
+        for ( size_type s = 0; s < block_->m_used; ++s )
+        {
+            if constexpr ( StablePointers )
+                delete block_->m_slots[ s ];
+            else
+                block_->entry( s )->~entry_type( );
+        }
+        delete block_;
+    }
+
+    // Redistributes the elements into a bucket array of the given size.
+    /*!
+     * Entries are moved into new, densely filled blocks; with StablePointers only
+     * the pointers move.
+     *
+     * @tparam KeyType The key type.
+     * @tparam DataType The data type.
+     * @tparam KeyHash A function that reads a key and returns an unsigned integer.
+     * @tparam KeyEqual  A function that compares two keys.
+     * @tparam StablePointers Whether entries are allocated separately.
+     *
+     * @param new_size_ The new number of buckets.
+     */
+	template< typename KeyType, typename DataType, typename KeyHash, typename KeyEqual, bool StablePointers >
+    void UnrolledHashTbl<KeyType,DataType,KeyHash,KeyEqual,StablePointers>::rehash( size_type new_size_ )
+    {
+        KeyHash hashf;
+        auto old_table = std::move( m_table );
+        const auto old_size = m_size;
+        m_table = std::make_unique< Block * [] >( new_size_ );
+        m_size = new_size_;
+        m_blocks = 0;
+
+        for ( size_type i = 0; i < old_size; ++i )
+        {
+            for ( Block * block = old_table[ i ]; block != nullptr; )
+            {
+                for ( size_type s = 0; s < block->m_used; ++s )
+                {
+                    const auto h = hashf( block->entry( s )->m_key );
+                    if constexpr ( StablePointers )
+                    {
+                        auto slot = reserve_slot( m_table[ h % m_size ], block->m_tags[ s ] );
+                        slot.first->m_slots[ slot.second ] = block->m_slots[ s ];
+                    }
+                    else
+                    {
+                        emplace( h, std::move( *block->entry( s ) ) );
+                        block->entry( s )->~entry_type( );
+                    }
+                }
+
+                Block * next = block->m_next;
+                delete block;
+                block = next;
+            }
+        }
+    }
+
+} // Namespace ac.
@@ -3,10 +3,32 @@
 #include <algorithm>            // std::min_element
 #include <array>
 #include <map>
+#include <atomic>
+#include <thread>
+#include <forward_list>
+#include <sstream>              // std::ostringstream
+#include <type_traits>
+#include <stdexcept>            // std::runtime_error
+#include <sys/wait.h>           // waitpid
 
 #include "gtest/gtest.h"        // gtest lib
 #include "../include/hashtbl.h"   // header file for tested functions
+#include "../include/frozen_hashtbl.h" // compile-time tables
+#include "../include/lru_cache.h" // bounded cache
+#include "../include/expiring_hashtbl.h" // entries with TTL
+#include "../include/indexed_hashtbl.h" // secondary indexes
+#include "../include/hash_multitbl.h" // repeated keys
+#include "../include/hash_query.h" // join, group-by
+#include "../include/cow_hashtbl.h" // snapshots
+#include "../include/replicated_hashtbl.h" // NUMA replicas
+#include "../include/unrolled_hashtbl.h" // blocks of entries
+#include "../include/shared_hashtbl.h" // shared across processes
+#include "../include/split_hashtbl.h" // keys apart from data
+#include "../include/compact_hashtbl.h" // entries in insertion order
+#include "../include/combining_hashtbl.h" // flat combining
+#include "../include/hardened_hashtbl.h" // flooding resistant
 #include "../driver/account.h"  // To get the account class
+#include "../driver/account_loader.h" // bulk loading
 
 // ============================================================================
 // Test Fxture
@@ -547,6 +569,2054 @@ TEST_F(HTTest, Count)
     //std::cout << "The table: \n" << htable << std::endl;
 }
 
+// ============================================================================
+// TESTING FROZEN HASH TABLE
+// ============================================================================
+
+// Built entirely at compile time.
+constexpr auto frozen_codes = ac::make_frozen_hashtbl<char, int>( {{'a', 27}, {'b', 3}, {'c', 1}} );
+static_assert( frozen_codes.at('a') == 27, "Frozen lookup must work at compile time" );
+static_assert( frozen_codes.count('z') == 0, "Frozen lookup must work at compile time" );
+
+TEST_F(HTTest, FrozenRetrieve)
+{
+    std::map<char, int> expected {{'a', 27}, {'b', 3}, {'c', 1}};
+    std::map<char, int> unexpected {{'s', 27}, {'e', 3}, {'g', 1}, {'q', 21}, {'i', 6}, {'j', 11}};
+
+    ASSERT_EQ( frozen_codes.size(), expected.size() );
+    for( const auto &e : expected )
+    {
+        int data;
+        auto result = frozen_codes.retrieve( e.first, data );
+        ASSERT_TRUE( result );
+        ASSERT_EQ( e.second, data );
+        ASSERT_EQ( 1u, frozen_codes.count( e.first ) );
+    }
+    for( const auto &e : unexpected )
+    {
+        int data;
+        ASSERT_FALSE( frozen_codes.retrieve( e.first, data ) );
+        ASSERT_THROW( frozen_codes.at( e.first ), std::out_of_range );
+    }
+}
+
+TEST_F(HTTest, FrozenManyKeys)
+{
+    // Enough keys to force buckets with several entries and seed search.
+    constexpr auto branches = ac::make_frozen_hashtbl<int, int>( {
+        {1668, 1}, {557, 2}, {331, 3}, {666, 4}, {123, 5}, {506, 6}, {324, 7}, {1, 8},
+        {2, 9}, {3, 10}, {4, 11}, {5, 12}, {6, 13}, {7, 14}, {8, 15}, {9, 16},
+        {10, 17}, {11, 18}, {12, 19}, {13, 20}, {14, 21}, {15, 22}, {16, 23}, {17, 24},
+        {1000, 25}, {2000, 26}, {3000, 27}, {4000, 28}, {5000, 29}, {6000, 30}, {7000, 31}, {8000, 32},
+        {-1, 33}, {-2, 34}, {-3, 35}, {-4, 36}, {-5, 37}, {-6, 38}, {-7, 39}, {-8, 40} } );
+    static_assert( branches.at(-8) == 40, "Frozen lookup must work at compile time" );
+
+    for ( const auto &e : branches )
+        ASSERT_EQ( e.m_data, branches.at( e.m_key ) );
+    for ( int k = 10000; k < 10500; ++k )
+        ASSERT_EQ( 0u, branches.count( k ) );
+
+    constexpr auto names = ac::make_frozen_hashtbl<std::string_view, int>( {{"BB", 1}, {"CEF", 104}, {"ITAU", 341}} );
+    ASSERT_EQ( 104, names.at( "CEF" ) );
+    ASSERT_EQ( 0u, names.count( "NUBANK" ) );
+}
+
+// ============================================================================
+// TESTING PERFECT HASH TABLE (FREEZE)
+// ============================================================================
+
+TEST_F(HTTest, FreezeAccounts)
+{
+    insert_accounts();
+    auto frozen = ht_accounts.freeze();
+
+    ASSERT_EQ( ht_accounts.size(), frozen.size() );
+    for( auto & e : m_accounts )
+    {
+        Account temp;
+        ASSERT_TRUE( frozen.retrieve( e.getKey(), temp ) );
+        ASSERT_EQ( temp, e );
+        ASSERT_EQ( frozen.at( e.getKey() ), e );
+    }
+
+    Account unknown{"Nobody", 1, 1668, 1, 0.f};
+    ASSERT_EQ( 0u, frozen.count( unknown.getKey() ) );
+    ASSERT_THROW( frozen.at( unknown.getKey() ), std::out_of_range );
+}
+
+TEST_F(HTTest, FreezeParallel)
+{
+    ac::HashTbl<int, int> htable;
+    for ( int i = 0; i < 5000; ++i )
+        htable.insert( 3 * i, i );
+
+    auto frozen = htable.freeze( 4 );
+    ASSERT_EQ( 5000u, frozen.size() );
+    for ( int i = 0; i < 5000; ++i )
+    {
+        ASSERT_EQ( i, frozen.at( 3 * i ) );
+        ASSERT_EQ( 0u, frozen.count( 3 * i + 1 ) );
+    }
+
+    ac::HashTbl<int, int> empty_table;
+    auto frozen_empty = empty_table.freeze( 2 );
+    ASSERT_TRUE( frozen_empty.empty() );
+    ASSERT_EQ( 0u, frozen_empty.count( 0 ) );
+}
+
+/// A terrible hash function, to force collisions.
+struct ParityHash {
+    std::size_t operator()( int k ) const { return k % 2; }
+};
+
+TEST_F(HTTest, FreezeCollidingHashes)
+{
+    ac::HashTbl<int, int, ParityHash> htable;
+    for ( int i = 0; i < 20; ++i )
+        htable.insert( i, 10 * i );
+
+    auto frozen = htable.freeze();
+    ASSERT_EQ( 20u, frozen.size() );
+    for ( int i = 0; i < 20; ++i )
+        ASSERT_EQ( 10 * i, frozen.at( i ) );
+    ASSERT_EQ( 0u, frozen.count( 21 ) );
+
+    // Iteration visits the colliding entries too.
+    std::vector< bool > seen( 20, false );
+    for ( const auto & en : frozen )
+    {
+        ASSERT_EQ( 10 * en.m_key, en.m_data );
+        seen[ en.m_key ] = true;
+    }
+    ASSERT_EQ( 20, std::count( seen.begin(), seen.end(), true ) );
+    ASSERT_EQ( frozen.size(), std::size_t( std::distance( frozen.begin(), frozen.end() ) ) );
+}
+
+// ============================================================================
+// TESTING SHRINKING
+// ============================================================================
+
+TEST_F(HTTest, ShrinkOnErase)
+{
+    ac::HashTbl<int, int> htable;
+    for ( int i = 0; i < 1000; ++i )
+        htable.insert( i, i );
+    auto peak = htable.bucket_count();
+    ASSERT_LE( htable.load_factor(), htable.max_load_factor() );
+
+    // Purge almost everything: the bucket array must follow.
+    for ( int i = 0; i < 990; ++i )
+        ASSERT_TRUE( htable.erase( i ) );
+    ASSERT_LT( htable.bucket_count(), peak / 10 );
+    ASSERT_GE( htable.load_factor(), htable.min_load_factor() );
+
+    for ( int i = 990; i < 1000; ++i )
+        ASSERT_EQ( i, htable.at( i ) );
+    ASSERT_EQ( 10u, htable.size() );
+}
+
+TEST_F(HTTest, ShrinkDisabled)
+{
+    ac::HashTbl<int, int> htable;
+    htable.min_load_factor( 0.f );
+    for ( int i = 0; i < 1000; ++i )
+        htable.insert( i, i );
+    auto peak = htable.bucket_count();
+
+    for ( int i = 0; i < 990; ++i )
+        htable.erase( i );
+    ASSERT_EQ( peak, htable.bucket_count() );
+
+    // Explicit request.
+    htable.shrink_to_fit();
+    ASSERT_LT( htable.bucket_count(), peak / 10 );
+    ASSERT_LE( htable.load_factor(), htable.max_load_factor() );
+    for ( int i = 990; i < 1000; ++i )
+        ASSERT_EQ( i, htable.at( i ) );
+}
+
+TEST_F(HTTest, ShrinkKeepsReserve)
+{
+    // Erasures do not undo reserve() or a pre-sized table.
+    ac::HashTbl<int, int> reserved, presized( 5000 );
+    reserved.reserve( 100000 );
+    const auto capacity = reserved.bucket_count(), initial = presized.bucket_count();
+    for ( auto * htable : { &reserved, &presized } )
+    {
+        for ( int i = 0; i < 10; ++i )
+            htable->insert( i, i );
+        ASSERT_TRUE( htable->erase( 0 ) );
+    }
+    ASSERT_EQ( capacity, reserved.bucket_count() );
+    ASSERT_EQ( initial, presized.bucket_count() );
+
+    // Growth beyond it is given back, down to it.
+    for ( int i = 0; i < 20000; ++i )
+        presized.insert( i, i );
+    for ( int i = 0; i < 20000; ++i )
+        presized.erase( i );
+    ASSERT_EQ( initial, presized.bucket_count() );
+
+    // Asking to shrink forgets it.
+    reserved.shrink_to_fit();
+    ASSERT_LT( reserved.bucket_count(), 100u );
+
+    // A reserve() that could not allocate does not count.
+    ac::HashTbl<int, int> failed;
+    for ( int i = 0; i < 1000; ++i )
+        failed.insert( i, i );
+    const auto peak = failed.bucket_count();
+    ac::AllocationPolicy capped;
+    capped.m_max_bytes = 1 << 20;
+    failed.allocation_policy( capped );
+    ASSERT_THROW( failed.reserve( 1 << 20 ), std::bad_alloc );
+    for ( int i = 0; i < 990; ++i )
+        failed.erase( i );
+    ASSERT_LT( failed.bucket_count(), peak / 10 );
+}
+
+TEST_F(HTTest, ClearRelease)
+{
+    ac::HashTbl<int, int> htable;
+    htable.reserve( 5000 );
+    auto reserved = htable.bucket_count();
+    ASSERT_GE( reserved, 5000u );
+    for ( int i = 0; i < 5000; ++i )
+        htable.insert( i, i );
+    ASSERT_EQ( reserved, htable.bucket_count() ); // No rehash was needed.
+
+    htable.clear();
+    ASSERT_TRUE( htable.empty() );
+    ASSERT_EQ( reserved, htable.bucket_count() );
+
+    htable.insert( 1, 1 );
+    htable.clear( true );
+    ASSERT_TRUE( htable.empty() );
+    ASSERT_LT( htable.bucket_count(), reserved );
+    htable.insert( 7, 8 );
+    ASSERT_EQ( 8, htable.at( 7 ) );
+}
+
+// ============================================================================
+// TESTING LRU CACHE
+// ============================================================================
+
+TEST_F(HTTest, LruEvictsLeastRecentlyUsed)
+{
+    ac::LruCache< Account::AcctKey, Account, KeyHash, KeyEqual > cache( 3 );
+
+    for ( int i = 0; i < 3; ++i )
+        ASSERT_TRUE( cache.insert( m_accounts[i].getKey(), m_accounts[i] ) );
+
+    // Touch the oldest one, so that the second becomes the victim.
+    Account temp;
+    ASSERT_TRUE( cache.retrieve( m_accounts[0].getKey(), temp ) );
+    ASSERT_EQ( temp, m_accounts[0] );
+
+    ASSERT_TRUE( cache.insert( m_accounts[3].getKey(), m_accounts[3] ) );
+    ASSERT_EQ( 3u, cache.size() );
+    ASSERT_FALSE( cache.retrieve( m_accounts[1].getKey(), temp ) );
+    for ( int i : { 0, 2, 3 } )
+    {
+        ASSERT_TRUE( cache.retrieve( m_accounts[i].getKey(), temp ) );
+        ASSERT_EQ( temp, m_accounts[i] );
+    }
+
+    ASSERT_EQ( 4u, cache.stats().m_hits );
+    ASSERT_EQ( 1u, cache.stats().m_misses );
+    ASSERT_EQ( 1u, cache.stats().m_evictions );
+
+    // Updating an entry refreshes it without growing the cache.
+    ASSERT_FALSE( cache.insert( m_accounts[2].getKey(), m_accounts[4] ) );
+    ASSERT_EQ( 3u, cache.size() );
+    ASSERT_TRUE( cache.erase( m_accounts[2].getKey() ) );
+    ASSERT_FALSE( cache.erase( m_accounts[2].getKey() ) );
+    ASSERT_EQ( 2u, cache.size() );
+}
+
+TEST_F(HTTest, LruByteBudget)
+{
+    using cache_type = ac::LruCache< Account::AcctKey, Account, KeyHash, KeyEqual >;
+    // Charge each account by the length of the client name.
+    cache_type cache( 100, 30, []( const cache_type::entry_type & en ){ return en.m_data.m_name.size(); } );
+
+    for ( auto & e : m_accounts )
+    {
+        cache.insert( e.getKey(), e );
+        ASSERT_LE( cache.bytes(), 30u );
+    }
+
+    // "Carlito Pardo" (13) and "Januario Medeiros" (17) are the last two.
+    ASSERT_EQ( 2u, cache.size() );
+    ASSERT_EQ( 30u, cache.bytes() );
+    ASSERT_EQ( 6u, cache.stats().m_evictions );
+
+    cache.clear();
+    ASSERT_TRUE( cache.empty() );
+    ASSERT_EQ( 0u, cache.bytes() );
+}
+
+TEST_F(HTTest, LruRejectsOversized)
+{
+    using cache_type = ac::LruCache< Account::AcctKey, Account, KeyHash, KeyEqual >;
+    // Charge each account by its balance, which is not part of the key.
+    cache_type cache( 100, 15, []( const cache_type::entry_type & en ){ return std::size_t( en.m_data.m_balance ); } );
+
+    Account small = m_accounts[0], big = m_accounts[1];
+    small.m_balance = 13;
+    big.m_balance = 17;
+    ASSERT_TRUE( cache.insert( small.getKey(), small ) );
+    ASSERT_FALSE( cache.insert( big.getKey(), big ) );
+    ASSERT_EQ( 1u, cache.size() );
+    ASSERT_EQ( 13u, cache.bytes() );
+    ASSERT_EQ( 0u, cache.stats().m_evictions );
+
+    // An oversized update drops the old data instead of serving it.
+    small.m_balance = 16;
+    ASSERT_FALSE( cache.insert( small.getKey(), small ) );
+    Account temp;
+    ASSERT_FALSE( cache.retrieve( small.getKey(), temp ) );
+    ASSERT_TRUE( cache.empty() );
+    ASSERT_EQ( 0u, cache.bytes() );
+}
+
+namespace {
+    // Data whose copy throws while `fail` is set.
+    struct Fragile
+    {
+        static inline bool fail = false;
+        int m_value = 0;
+
+        Fragile( int v_ = 0 ) : m_value( v_ ) {}
+        Fragile( const Fragile & other_ ) : m_value( other_.m_value )
+        { if ( fail ) throw std::runtime_error( "copy" ); }
+        Fragile & operator=( const Fragile & ) = default;
+    };
+}
+
+TEST_F(HTTest, LruInsertThrows)
+{
+    ac::LruCache< int, Fragile > cache( 2 );
+    ASSERT_TRUE( cache.insert( 1, Fragile( 10 ) ) );
+
+    Fragile::fail = true;
+    ASSERT_THROW( cache.insert( 2, Fragile( 20 ) ), std::runtime_error );
+    ASSERT_THROW( cache.insert( 1, Fragile( 11 ) ), std::runtime_error );
+    Fragile::fail = false;
+
+    // Nothing was added or changed, and the index still matches the list.
+    ASSERT_EQ( 1u, cache.size() );
+    Fragile temp;
+    ASSERT_FALSE( cache.retrieve( 2, temp ) );
+    ASSERT_TRUE( cache.retrieve( 1, temp ) );
+    ASSERT_EQ( 10, temp.m_value );
+
+    for ( int i = 2; i < 6; ++i )
+        ASSERT_TRUE( cache.insert( i, Fragile( i * 10 ) ) );
+    ASSERT_EQ( 2u, cache.size() );
+    ASSERT_FALSE( cache.retrieve( 1, temp ) );
+    ASSERT_TRUE( cache.retrieve( 5, temp ) );
+    ASSERT_EQ( 50, temp.m_value );
+}
+
+// ============================================================================
+// TESTING EXPIRING HASH TABLE
+// ============================================================================
+
+TEST_F(HTTest, ExpiryLazy)
+{
+    std::uint64_t now = 1000;
+    ac::ExpiringHashTbl<char, int> htable( [&]( ){ return now; } );
+
+    ASSERT_TRUE( htable.insert( 'a', 1, 10 ) );
+    ASSERT_TRUE( htable.insert( 'b', 2 ) ); // Never expires.
+
+    int data;
+    now = 1009;
+    ASSERT_TRUE( htable.retrieve( 'a', data ) );
+    ASSERT_EQ( 1, data );
+
+    now = 1010;
+    ASSERT_FALSE( htable.retrieve( 'a', data ) );
+    ASSERT_EQ( 1u, htable.size() ); // Removed on access.
+
+    now = 1000000;
+    ASSERT_TRUE( htable.retrieve( 'b', data ) );
+    ASSERT_EQ( 2, data );
+
+    // Renewing the time to live.
+    ASSERT_TRUE( htable.insert( 'c', 3, 5 ) );
+    now += 4;
+    ASSERT_FALSE( htable.insert( 'c', 4, 5 ) );
+    now += 4;
+    ASSERT_TRUE( htable.retrieve( 'c', data ) );
+    ASSERT_EQ( 4, data );
+}
+
+TEST_F(HTTest, ExpiryActive)
+{
+    std::uint64_t now = 0;
+    ac::ExpiringHashTbl<int, int> htable( [&]( ){ return now; } );
+
+    // Spread expiries over several levels of the wheel.
+    const int n = 2000;
+    for ( int i = 0; i < n; ++i )
+        htable.insert( i, i, 1 + i * 37 );
+    htable.insert( -1, -1 ); // Never expires.
+
+    // Bounded work per call.
+    now = 100 * 37;
+    ASSERT_EQ( 10u, htable.expire( 10 ) );
+    ASSERT_EQ( 90u, htable.expire( ) );
+    ASSERT_EQ( 0u, htable.expire( ) );
+    ASSERT_EQ( n + 1u - 100u, htable.size() );
+
+    int data;
+    ASSERT_FALSE( htable.retrieve( 99, data ) );
+    ASSERT_TRUE( htable.retrieve( 100, data ) );
+
+    // Erased entries do not fire.
+    ASSERT_TRUE( htable.erase( 150 ) );
+
+    now = 1 + ( n - 1 ) * 37;
+    ASSERT_EQ( n - 100u - 1u, htable.expire( ) );
+    ASSERT_EQ( 1u, htable.size() );
+    ASSERT_TRUE( htable.retrieve( -1, data ) );
+
+    // Far away expiries (beyond the range of the wheel) still fire on time.
+    htable.insert( 7, 7, 20000000 );
+    now += 19999999;
+    ASSERT_EQ( 0u, htable.expire( ) );
+    now += 1;
+    ASSERT_EQ( 1u, htable.expire( ) );
+}
+
+// ============================================================================
+// TESTING SECONDARY INDEXES
+// ============================================================================
+
+TEST_F(HTTest, IndexByBranch)
+{
+    ac::IndexedHashTbl< Account::AcctKey, Account, KeyHash, KeyEqual > accounts;
+    // Index created before the data.
+    auto & by_branch = accounts.add_index< Account::BranchKey, BranchHash >( &Account::getBranch );
+
+    for ( auto & e : m_accounts )
+        accounts.insert( e.getKey(), e );
+
+    // Alex Bastos and Aline Souza share bank 1, branch 1668.
+    auto & found = by_branch.lookup( { 1, 1668 } );
+    ASSERT_EQ( 2u, found.size() );
+    for ( auto acct : found )
+    {
+        ASSERT_EQ( 1, acct->m_bank_code );
+        ASSERT_EQ( 1668, acct->m_branch_code );
+        // The index points to the data in the table.
+        ASSERT_EQ( accounts.find( acct->getKey() ), acct );
+    }
+    ASSERT_EQ( 1u, by_branch.count( { 13, 557 } ) );
+    ASSERT_EQ( 0u, by_branch.count( { 13, 558 } ) );
+
+    // Index created after the data.
+    auto & by_bank = accounts.add_index< int >( []( const Account & a ){ return a.m_bank_code; } );
+    ASSERT_EQ( 2u, by_bank.count( 1 ) );
+
+    // Erasing removes from every index.
+    ASSERT_TRUE( accounts.erase( m_accounts[0].getKey() ) );
+    ASSERT_EQ( 1u, by_branch.count( { 1, 1668 } ) );
+    ASSERT_EQ( m_accounts[1], *by_branch.lookup( { 1, 1668 } ).front() );
+    ASSERT_EQ( 1u, by_bank.count( 1 ) );
+}
+
+TEST_F(HTTest, IndexUpdate)
+{
+    ac::IndexedHashTbl< Account::AcctKey, Account, KeyHash, KeyEqual > accounts( 2 );
+    auto & by_balance = accounts.add_index< float >( []( const Account & a ){ return a.m_balance; } );
+
+    for ( auto & e : m_accounts ) // Forces some rehashes.
+        accounts.insert( e.getKey(), e );
+    ASSERT_EQ( 1u, by_balance.count( 150.f ) );
+
+    // Same key, new balance: the entry moves between index lists.
+    auto changed = m_accounts[2];
+    changed.m_balance = 150.f;
+    ASSERT_FALSE( accounts.insert( changed.getKey(), changed ) );
+    ASSERT_EQ( 2u, by_balance.count( 150.f ) );
+    ASSERT_EQ( 0u, by_balance.count( 150000.f ) );
+    ASSERT_EQ( m_accounts.size(), accounts.size() );
+
+    // New balance, same branch: the branch list keeps its order.
+    auto & by_branch = accounts.add_index< Account::BranchKey, BranchHash >( &Account::getBranch );
+    const auto before = by_branch.lookup( changed.getBranch() );
+    changed.m_balance = 1.f;
+    ASSERT_FALSE( accounts.insert( changed.getKey(), changed ) );
+    ASSERT_EQ( before, by_branch.lookup( changed.getBranch() ) );
+    ASSERT_EQ( 1u, by_balance.count( 1.f ) );
+
+    accounts.clear();
+    ASSERT_EQ( 0u, by_balance.count( 150.f ) );
+
+    // A crowded list: items erased from its middle leave the others in place.
+    for ( int i = 0; i < 1000; ++i )
+    {
+        Account a( "Crowd", 7, 7, i, float( i ) );
+        accounts.insert( a.getKey(), a );
+    }
+    for ( int i = 0; i < 1000; i += 2 )
+        ASSERT_TRUE( accounts.erase( Account( "Crowd", 7, 7, i ).getKey() ) );
+    ASSERT_EQ( 500u, by_branch.count( { 7, 7 } ) );
+    for ( auto acct : by_branch.lookup( { 7, 7 } ) )
+    {
+        ASSERT_EQ( 1, acct->m_number % 2 );
+        ASSERT_EQ( accounts.find( acct->getKey() ), acct );
+    }
+}
+
+// ============================================================================
+// TESTING MULTIMAP
+// ============================================================================
+
+TEST_F(HTTest, MultiCountAndRange)
+{
+    // Several transactions per account; a small table forces rehashes.
+    ac::HashMultiTbl<int, float> history( 2 );
+    std::multimap<int, float> expected;
+    for ( int t = 0; t < 60; ++t )
+    {
+        int acct = t % 7;
+        bool first = expected.count( acct ) == 0;
+        ASSERT_EQ( first, history.insert( acct, 10.f * t ) );
+        expected.emplace( acct, 10.f * t );
+    }
+    ASSERT_EQ( expected.size(), history.size() );
+
+    for ( int acct = 0; acct < 7; ++acct )
+    {
+        ASSERT_EQ( expected.count( acct ), history.count( acct ) );
+
+        // Elements with the same key keep the insertion order.
+        auto range = history.equal_range( acct );
+        auto exp = expected.equal_range( acct );
+        for ( ; range.first != range.second; ++range.first, ++exp.first )
+        {
+            ASSERT_EQ( acct, range.first->m_key );
+            ASSERT_EQ( exp.first->second, range.first->m_data );
+        }
+        ASSERT_TRUE( exp.first == exp.second );
+    }
+    ASSERT_EQ( 0u, history.count( 100 ) );
+    auto none = history.equal_range( 100 );
+    ASSERT_TRUE( none.first == none.second );
+}
+
+TEST_F(HTTest, MultiErase)
+{
+    ac::HashMultiTbl<char, int> htable {{'a', 1}, {'b', 2}, {'a', 3}, {'c', 4}, {'a', 5}};
+    ASSERT_EQ( 5u, htable.size() );
+    ASSERT_EQ( 3u, htable.count( 'a' ) );
+
+    ASSERT_EQ( 3u, htable.erase( 'a' ) );
+    ASSERT_EQ( 0u, htable.erase( 'a' ) );
+    ASSERT_EQ( 0u, htable.count( 'a' ) );
+    ASSERT_EQ( 2u, htable.size() );
+    int data = 0;
+    ASSERT_TRUE( htable.retrieve( 'b', data ) );
+    ASSERT_EQ( 2, data );
+
+    htable = {{'x', 1}, {'x', 2}};
+    ASSERT_EQ( 2u, htable.count( 'x' ) );
+    ASSERT_EQ( 0u, htable.count( 'b' ) );
+}
+
+/// Whether a table type has each unique-key mutation of HashTbl.
+template< class T, class = void > struct has_update : std::false_type {};
+template< class T > struct has_update< T, std::void_t< decltype( std::declval< T & >().update( 1, std::declval< void ( * )( int & ) >() ) ) > > : std::true_type {};
+template< class T, class = void > struct has_upsert : std::false_type {};
+template< class T > struct has_upsert< T, std::void_t< decltype( std::declval< T & >().upsert( 1, std::declval< int ( * )() >(), std::declval< void ( * )( int & ) >() ) ) > > : std::true_type {};
+template< class T, class = void > struct has_compute : std::false_type {};
+template< class T > struct has_compute< T, std::void_t< decltype( std::declval< T & >().compute( 1, std::declval< bool ( * )( int &, bool ) >() ) ) > > : std::true_type {};
+template< class T, class = void > struct has_subscript : std::false_type {};
+template< class T > struct has_subscript< T, std::void_t< decltype( std::declval< T & >()[ 1 ] ) > > : std::true_type {};
+template< class T, class = void > struct has_at : std::false_type {};
+template< class T > struct has_at< T, std::void_t< decltype( std::declval< T & >().at( 1 ) ) > > : std::true_type {};
+template< class T, class = void > struct has_insert_batch : std::false_type {};
+template< class T > struct has_insert_batch< T, std::void_t< decltype( std::declval< T & >().insert_batch( nullptr, nullptr, 0 ) ) > > : std::true_type {};
+template< class T, class = void > struct has_apply_batch : std::false_type {};
+template< class T > struct has_apply_batch< T, std::void_t< decltype( std::declval< T & >().apply_batch( std::declval< ac::HashMutation< int, int > * >(), std::declval< ac::HashMutation< int, int > * >() ) ) > > : std::true_type {};
+template< class T, class = void > struct has_extract : std::false_type {};
+template< class T > struct has_extract< T, std::void_t< decltype( std::declval< T & >().extract( 1 ) ) > > : std::true_type {};
+template< class T, class = void > struct has_node_insert : std::false_type {};
+template< class T > struct has_node_insert< T, std::void_t< decltype( std::declval< T & >().insert( ac::HashNode< int, int >() ) ) > > : std::true_type {};
+template< class T, class = void > struct has_merge : std::false_type {};
+template< class T > struct has_merge< T, std::void_t< decltype( std::declval< T & >().merge( std::declval< ac::HashTbl< int, int > & >() ) ) > > : std::true_type {};
+
+TEST_F(HTTest, MultiHidesUniqueKeyMutations)
+{
+    using multi_type = ac::HashMultiTbl< int, int >;
+    using table_type = ac::HashTbl< int, int >;
+
+    // The probes detect the operations on HashTbl...
+    static_assert( has_update< table_type >::value and has_upsert< table_type >::value and has_compute< table_type >::value );
+    static_assert( has_subscript< table_type >::value and has_at< table_type >::value and has_insert_batch< table_type >::value );
+    static_assert( has_apply_batch< table_type >::value and has_extract< table_type >::value );
+    static_assert( has_node_insert< table_type >::value and has_merge< table_type >::value );
+    // ... and none of them on HashMultiTbl, nor a conversion that would reach them.
+    static_assert( not has_update< multi_type >::value and not has_upsert< multi_type >::value and not has_compute< multi_type >::value );
+    static_assert( not has_subscript< multi_type >::value and not has_at< multi_type >::value and not has_insert_batch< multi_type >::value );
+    static_assert( not has_apply_batch< multi_type >::value and not has_extract< multi_type >::value );
+    static_assert( not has_node_insert< multi_type >::value and not has_merge< multi_type >::value );
+    static_assert( not std::is_convertible_v< multi_type &, table_type & > );
+
+    // What remains keeps every element of a group.
+    multi_type htable;
+    for ( int d = 10; d < 13; ++d )
+        htable.insert( 1, d );
+    htable.reserve( 1000 );
+    htable.shrink_to_fit();
+    ASSERT_EQ( 3u, htable.count( 1 ) );
+    ASSERT_EQ( 10, *htable.find( 1 ) );
+    int sum = 0;
+    htable.for_each( [&]( int, int d ){ sum += d; } );
+    ASSERT_EQ( 33, sum );
+    std::ostringstream out;
+    out << htable;
+    ASSERT_NE( std::string::npos, out.str().find( "10\n11\n12\n" ) );
+}
+
+// ============================================================================
+// TESTING QUERY OPERATORS
+// ============================================================================
+
+TEST_F(HTTest, HashJoin)
+{
+    insert_accounts();
+
+    // Transactions: (account key, amount); every third one is for an unknown account.
+    std::vector< std::pair< Account::AcctKey, float > > transactions;
+    for ( int i = 0; i < 300; ++i )
+    {
+        auto acct = m_accounts[ i % m_accounts.size() ];
+        if ( i % 3 == 0 )
+            acct.m_number = -i;
+        transactions.emplace_back( acct.getKey(), float( i ) );
+    }
+
+    for ( std::size_t threads : { 1, 4 } )
+    {
+        std::atomic< int > emitted{ 0 };
+        auto matches = ac::hash_join( ht_accounts, transactions.begin(), transactions.end(),
+            []( const std::pair< Account::AcctKey, float > & t ){ return t.first; },
+            [&]( const std::pair< Account::AcctKey, float > & t, const Account & a ){
+                EXPECT_TRUE( KeyEqual()( t.first, a.getKey() ) );
+                ++emitted;
+            }, threads );
+        ASSERT_EQ( 200u, matches );
+        ASSERT_EQ( 200, emitted );
+    }
+}
+
+TEST_F(HTTest, QueryFunctorThrows)
+{
+    insert_accounts();
+    std::vector< std::pair< Account::AcctKey, float > > transactions;
+    for ( int i = 0; i < 300; ++i )
+        transactions.emplace_back( m_accounts[ i % m_accounts.size() ].getKey(), float( i ) );
+
+    // Thrown on the calling thread (first slice) or on a worker (last slice): every
+    // thread is joined and the exception reaches the caller.
+    for ( int bad : { 0, 299 } )
+        for ( std::size_t threads : { 1, 4 } )
+            ASSERT_THROW( ac::hash_join( ht_accounts, transactions.begin(), transactions.end(),
+                [&]( const std::pair< Account::AcctKey, float > & t ) -> const Account::AcctKey & {
+                    if ( t.second == bad )
+                        throw std::runtime_error( "bad transaction" );
+                    return t.first;
+                },
+                []( const std::pair< Account::AcctKey, float > &, const Account & ){ }, threads ),
+                std::runtime_error );
+}
+
+TEST_F(HTTest, GroupBy)
+{
+    // Many accounts over a few branches.
+    std::vector< Account > accounts;
+    std::map< Account::BranchKey, float > expected;
+    for ( int i = 0; i < 10000; ++i )
+    {
+        accounts.emplace_back( "Client", i % 3, i % 7, i, float( i % 10 ) );
+        expected[ accounts.back().getBranch() ] += accounts.back().m_balance;
+    }
+
+    for ( std::size_t threads : { 1, 4 } )
+    {
+        auto totals = ac::group_by< Account::BranchKey, float, BranchHash >( accounts.begin(), accounts.end(),
+            []( const Account & a ){ return a.getBranch(); },
+            []( float & sum, const Account & a ){ sum += a.m_balance; },
+            []( float & sum, float partial ){ sum += partial; }, threads );
+
+        ASSERT_EQ( expected.size(), totals.size() );
+        for ( const auto & e : expected )
+            ASSERT_FLOAT_EQ( e.second, totals.at( e.first ) );
+    }
+}
+
+// ============================================================================
+// TESTING MEMBERSHIP FILTER
+// ============================================================================
+
+TEST_F(HTTest, CountingFilter)
+{
+    ac::CountingFilter filter( 1000 );
+    std::hash< int > hashf;
+    for ( int i = 0; i < 1000; ++i )
+        filter.add( hashf( i ) );
+
+    // No false negatives, few false positives.
+    int positives = 0;
+    for ( int i = 0; i < 1000; ++i )
+        ASSERT_TRUE( filter.may_contain( hashf( i ) ) );
+    for ( int i = 1000; i < 11000; ++i )
+        positives += filter.may_contain( hashf( i ) );
+    ASSERT_LT( positives, 500 );
+
+    // Removing keys gives their counters back.
+    for ( int i = 0; i < 1000; ++i )
+        filter.remove( hashf( i ) );
+    for ( int i = 0; i < 1000; ++i )
+        ASSERT_FALSE( filter.may_contain( hashf( i ) ) );
+}
+
+TEST_F(HTTest, FilteredLookups)
+{
+    ac::HashTbl<int, int> htable;
+    htable.insert( -1, -1 );
+    htable.membership_filter( true ); // Picks up the existing element.
+    ASSERT_TRUE( htable.membership_filter() );
+
+    for ( int i = 0; i < 2000; ++i )
+        htable.insert( i, i );
+    for ( int i = 2000; i < 3000; ++i )
+        htable[ i ] = i;
+    for ( int i = 0; i < 2900; ++i )
+        ASSERT_TRUE( htable.erase( i ) ); // Also shrinks.
+    ASSERT_FALSE( htable.erase( 0 ) );
+
+    ASSERT_EQ( -1, htable.at( -1 ) );
+    for ( int i = 0; i < 2900; ++i )
+        ASSERT_EQ( nullptr, htable.find( i ) );
+    for ( int i = 2900; i < 3000; ++i )
+        ASSERT_EQ( i, htable.at( i ) );
+
+    auto copy = htable;
+    copy.clear();
+    ASSERT_EQ( nullptr, copy.find( 2950 ) );
+    copy.insert( 2950, 1 );
+    ASSERT_EQ( 1, copy.at( 2950 ) );
+    ASSERT_EQ( 2950, htable.at( 2950 ) );
+
+    htable.membership_filter( false );
+    ASSERT_EQ( 2950, htable.at( 2950 ) );
+}
+
+// ============================================================================
+// TESTING BULK LOADING
+// ============================================================================
+
+TEST_F(HTTest, LoadAccountsCsv)
+{
+    std::vector< Account > accounts( m_accounts.begin(), m_accounts.end() );
+    for ( int i = 0; i < 5000; ++i )
+        accounts.emplace_back( "Client " + std::to_string( i ), i % 3, i % 7, i, i * 0.25f - 100 );
+
+    std::string path = ::testing::TempDir() + "accounts.csv";
+    save_accounts( path, accounts, AccountFormat::CSV );
+
+    for ( std::size_t threads : { 1, 4 } )
+    {
+        AccountTbl table;
+        ASSERT_EQ( accounts.size(), load_accounts( path, table, threads ) );
+        ASSERT_EQ( accounts.size(), table.size() );
+        for ( const auto & acct : accounts )
+            ASSERT_EQ( acct, table.at( acct.getKey() ) );
+    }
+
+    // Blank lines, CRLF and a last line without newline.
+    auto parse = []( const std::string & text_, std::size_t threads_ ) {
+        return parse_accounts( text_.data(), text_.data() + text_.size(), threads_ );
+    };
+    const std::string text = "Ana,1,2,3,4.5\r\n\nBia,6,7,8,-9\nCris,10,11,12,13";
+    auto parsed = parse( text, 2 );
+    ASSERT_EQ( 3u, parsed.size() );
+    ASSERT_EQ( Account( "Ana", 1, 2, 3, 4.5f ), parsed[ 0 ] );
+    ASSERT_EQ( Account( "Cris", 10, 11, 12, 13.f ), parsed[ 2 ] );
+
+    ASSERT_THROW( parse( "Ana,1,2,3\n", 1 ), std::invalid_argument );
+    ASSERT_THROW( parse( "Ana,1,2,x,4\n", 1 ), std::invalid_argument );
+    ASSERT_THROW( parse( "Ana,1,2,3,4,5\n", 1 ), std::invalid_argument );
+}
+
+TEST_F(HTTest, LoadAccountsBinary)
+{
+    std::vector< Account > accounts( m_accounts.begin(), m_accounts.end() );
+    std::string path = ::testing::TempDir() + "accounts.bin";
+    save_accounts( path, accounts, AccountFormat::BINARY );
+
+    insert_accounts();
+    ht_accounts.erase( m_accounts[ 0 ].getKey() );
+    ht_accounts.at( m_accounts[ 1 ].getKey() ).m_balance = -1.f; // Overwritten by the file.
+    ASSERT_EQ( accounts.size(), load_accounts( path, ht_accounts ) );
+    ASSERT_EQ( accounts.size(), ht_accounts.size() );
+    for ( const auto & acct : accounts )
+        ASSERT_EQ( acct, ht_accounts.at( acct.getKey() ) );
+
+    ASSERT_THROW( load_accounts( path + ".missing", ht_accounts ), std::system_error );
+}
+
+TEST_F(HTTest, LoadAccountsInChunks)
+{
+    std::vector< Account > accounts;
+    for ( int i = 0; i < 3000; ++i )
+        accounts.emplace_back( "Client " + std::to_string( i % 2000 ), 1, 2, i % 2000, float( i ) );
+
+    for ( auto format : { AccountFormat::CSV, AccountFormat::BINARY } )
+    {
+        std::string path = ::testing::TempDir() + "chunks.acct";
+        save_accounts( path, accounts, format );
+        for ( std::size_t chunk : { 1, 700, 4096 } )
+        {
+            AccountTbl table;
+            ASSERT_EQ( accounts.size(), load_accounts( path, table, 2, chunk ) );
+            ASSERT_EQ( 2000u, table.size() );
+            // Records repeated in a later chunk replace the earlier ones.
+            for ( std::size_t i = 1000; i < accounts.size(); ++i )
+                ASSERT_EQ( accounts[ i ], table.at( accounts[ i ].getKey() ) );
+            ASSERT_EQ( 2000.f, table.at( accounts[ 0 ].getKey() ).m_balance );
+        }
+    }
+}
+
+// ============================================================================
+// TESTING BATCHED MUTATIONS
+// ============================================================================
+
+TEST_F(HTTest, ApplyBatch)
+{
+    using Mutation = ac::HashTbl<int, int>::mutation_type;
+    std::vector< Mutation > log;
+    for ( int i = 0; i < 3000; ++i )
+    {
+        log.emplace_back( ac::MutationKind::INSERT, i % 1000, i );
+        if ( i % 7 == 0 )
+            log.emplace_back( ac::MutationKind::ERASE, i % 1000 );
+        if ( i % 5 == 0 )
+            log.emplace_back( ac::MutationKind::UPDATE, ( i + 500 ) % 2000, -i );
+    }
+
+    // Reference: one call at a time.
+    ac::HashTbl<int, int> expected;
+    for ( int i = 0; i < 100; ++i )
+        expected.insert( 5000 + i, i );
+    auto start = expected;
+    for ( const auto & m : log )
+    {
+        if ( m.m_kind == ac::MutationKind::INSERT )
+            expected.insert( m.m_key, m.m_data );
+        else if ( m.m_kind == ac::MutationKind::ERASE )
+            expected.erase( m.m_key );
+        else if ( auto data = expected.find( m.m_key ) )
+            *data = m.m_data;
+    }
+
+    for ( std::size_t threads : { 1, 4 } )
+    {
+        auto htable = start;
+        htable.membership_filter( true );
+        auto before = htable.bucket_count();
+        htable.apply_batch( log.begin(), log.end(), threads );
+        ASSERT_GT( htable.bucket_count(), before );
+
+        ASSERT_EQ( expected.size(), htable.size() );
+        for ( int i = -1; i < 6000; ++i )
+        {
+            auto e = expected.find( i ), d = htable.find( i );
+            ASSERT_EQ( e == nullptr, d == nullptr ) << i;
+            if ( e )
+            {
+                ASSERT_EQ( *e, *d ) << i;
+            }
+        }
+    }
+
+    // A batch of erasures shrinks the table at the end.
+    auto htable = expected;
+    std::vector< Mutation > purge;
+    for ( int i = 0; i < 1000; ++i )
+        purge.emplace_back( ac::MutationKind::ERASE, i );
+    htable.apply_batch( purge.begin(), purge.end() );
+    ASSERT_EQ( 100u, htable.size() );
+    ASSERT_LT( htable.bucket_count(), expected.bucket_count() );
+    ASSERT_EQ( 7, htable.at( 5007 ) );
+}
+
+// ============================================================================
+// TESTING SNAPSHOTS
+// ============================================================================
+
+TEST_F(HTTest, Snapshot)
+{
+    ac::CowHashTbl< Account::AcctKey, Account, KeyHash, KeyEqual > live;
+    for ( auto & e : m_accounts )
+        live.insert( e.getKey(), e );
+
+    auto day_end = live.snapshot();
+    ASSERT_EQ( live.size(), day_end.size() );
+
+    // Writes after the snapshot are not seen by it.
+    Account moved = m_accounts[ 2 ];
+    moved.m_balance = 0.f;
+    live.insert( moved.getKey(), moved );
+    live.erase( m_accounts[ 3 ].getKey() );
+    live.insert( Account( "New Client", 1, 2, 3, 4.f ).getKey(), Account( "New Client", 1, 2, 3, 4.f ) );
+
+    Account acct;
+    ASSERT_TRUE( day_end.retrieve( moved.getKey(), acct ) );
+    ASSERT_EQ( m_accounts[ 2 ], acct );
+    ASSERT_TRUE( day_end.retrieve( m_accounts[ 3 ].getKey(), acct ) );
+    ASSERT_EQ( nullptr, day_end.find( Account( "New Client", 1, 2, 3, 4.f ).getKey() ) );
+    ASSERT_EQ( 8u, day_end.size() );
+
+    ASSERT_EQ( 0.f, live.find( moved.getKey() )->m_balance );
+    ASSERT_FALSE( live.retrieve( m_accounts[ 3 ].getKey(), acct ) );
+    ASSERT_EQ( 8u, live.size() );
+
+    float total = 0;
+    day_end.for_each( [&]( const Account::AcctKey &, const Account & a ){ total += a.m_balance; } );
+    ASSERT_FLOAT_EQ( 163420.f, total );
+}
+
+TEST_F(HTTest, SnapshotSharing)
+{
+    ac::CowHashTbl<int, int> live;
+    for ( int i = 0; i < 10000; ++i )
+        live.insert( i, i );
+    ASSERT_EQ( 0u, live.shared_chunks() );
+
+    auto chunks = ( live.bucket_count() + live.CHUNK_BUCKETS - 1 ) / live.CHUNK_BUCKETS;
+    {
+        auto snap = live.snapshot();
+        ASSERT_EQ( chunks, live.shared_chunks() );
+
+        // Only the written chunk is copied.
+        live.insert( 5, -5 );
+        live.erase( 6 );
+        ASSERT_EQ( chunks - 1, live.shared_chunks() );
+        ASSERT_EQ( 5, *snap.find( 5 ) );
+        ASSERT_EQ( 6, *snap.find( 6 ) );
+
+        // A reader keeps a consistent view while the table changes.
+        std::thread reader( [ snap ]{
+            for ( int round = 0; round < 20; ++round )
+            {
+                long sum = 0;
+                snap.for_each( [&]( int, int v_ ){ sum += v_; } );
+                EXPECT_EQ( 10000L * 9999 / 2, sum );
+            }
+        } );
+        for ( int i = 0; i < 20000; ++i )
+            live.insert( i, -i ); // Also grows the table.
+        reader.join();
+    }
+
+    ASSERT_EQ( 0u, live.shared_chunks() );
+    ASSERT_EQ( 20000u, live.size() );
+    ASSERT_EQ( -6, *live.find( 6 ) );
+}
+
+// ============================================================================
+// TESTING NUMA REPLICAS
+// ============================================================================
+
+TEST_F(HTTest, NumaTopology)
+{
+    auto host = ac::NumaTopology::detect();
+    ASSERT_GE( host.nodes(), 1u );
+    ASSERT_FALSE( host.emulated() );
+    ASSERT_LT( host.current_node(), host.nodes() );
+
+    auto topo = ac::NumaTopology::emulated( 3 );
+    ASSERT_EQ( 3u, topo.nodes() );
+    ASSERT_TRUE( topo.emulated() );
+    for ( std::size_t node = 0; node < topo.nodes(); ++node )
+        ASSERT_FALSE( topo.cpus( node ).empty() );
+
+    // Emulated nodes never change the placement of memory.
+    std::vector< char > buffer( 1 << 16 );
+    ASSERT_FALSE( topo.place( buffer.data(), buffer.size(), ac::NumaPolicy::INTERLEAVE ) );
+
+    std::size_t node_seen = 99;
+    topo.run_on_node( 2, [&]{ node_seen = topo.current_node(); } );
+    ASSERT_LT( node_seen, topo.nodes() );
+}
+
+TEST_F(HTTest, ReplicatedTable)
+{
+    auto topo = ac::NumaTopology::emulated( 2 );
+    for ( auto policy : { ac::ReplicaPolicy::PER_NODE, ac::ReplicaPolicy::INTERLEAVED } )
+    {
+        ac::ReplicatedHashTbl< Account::AcctKey, Account, KeyHash, KeyEqual > accounts( topo, policy );
+        ASSERT_EQ( policy == ac::ReplicaPolicy::PER_NODE ? 2u : 1u, accounts.replicas() );
+
+        for ( auto & e : m_accounts )
+            ASSERT_TRUE( accounts.insert( e.getKey(), e ) );
+        ASSERT_TRUE( accounts.erase( m_accounts[ 0 ].getKey() ) );
+        ASSERT_EQ( 7u, accounts.size() );
+
+        // Every node reads the same contents.
+        Account acct;
+        for ( std::size_t node = 0; node < topo.nodes(); ++node )
+        {
+            ASSERT_FALSE( accounts.retrieve( m_accounts[ 0 ].getKey(), acct, node ) );
+            ASSERT_TRUE( accounts.retrieve( m_accounts[ 4 ].getKey(), acct, node ) );
+            ASSERT_EQ( m_accounts[ 4 ], acct );
+        }
+
+        // Batches are applied on every node.
+        std::vector< ac::HashMutation< Account::AcctKey, Account > > log;
+        for ( int i = 0; i < 1000; ++i )
+        {
+            Account a( "Batch", 1, 1, i, float( i ) );
+            log.emplace_back( ac::MutationKind::INSERT, a.getKey(), a );
+        }
+        accounts.apply_batch( log.begin(), log.end() );
+        for ( std::size_t node = 0; node < topo.nodes(); ++node )
+        {
+            ASSERT_TRUE( accounts.retrieve( Account( "Batch", 1, 1, 999 ).getKey(), acct, node ) );
+            ASSERT_EQ( 999.f, acct.m_balance );
+        }
+        ASSERT_EQ( 1007u, accounts.size() );
+    }
+}
+
+TEST_F(HTTest, ReplicatedConcurrentReads)
+{
+    auto topo = ac::NumaTopology::emulated( 2 );
+    ac::ReplicatedHashTbl< int, int > table( topo );
+    for ( int i = 0; i < 1000; ++i )
+        table.insert( i, i );
+
+    // Readers on both nodes, while the values change (and the tables grow).
+    std::atomic< bool > done{ false };
+    std::vector< std::thread > readers;
+    for ( std::size_t node = 0; node < topo.nodes(); ++node )
+        readers.push_back( topo.start_on_node( node, [&, node]{
+            int value;
+            while ( not done )
+                for ( int i = 0; i < 1000; ++i )
+                    if ( table.retrieve( i, value, node ) )
+                    {
+                        EXPECT_TRUE( value == i or value == -i );
+                    }
+        } ) );
+
+    for ( int i = 0; i < 1000; ++i )
+        table.insert( i, -i );
+    for ( int i = 1000; i < 5000; ++i )
+        table.insert( i, i );
+    done = true;
+    for ( auto & r : readers )
+        r.join();
+
+    int value;
+    ASSERT_TRUE( table.retrieve( 10, value, 1 ) );
+    ASSERT_EQ( -10, value );
+    ASSERT_EQ( 5000u, table.size() );
+}
+
+// ============================================================================
+// TESTING UNROLLED CHAINS
+// ============================================================================
+
+TEST_F(HTTest, UnrolledTable)
+{
+    ac::UnrolledHashTbl< Account::AcctKey, Account, KeyHash, KeyEqual > accounts( 4 );
+    ASSERT_TRUE( accounts.empty() );
+    for ( auto & e : m_accounts )
+        ASSERT_TRUE( accounts.insert( e.getKey(), e ) );
+    ASSERT_EQ( 8u, accounts.size() );
+    ASSERT_FALSE( accounts.insert( m_accounts[ 2 ].getKey(), m_accounts[ 3 ] ) );
+
+    Account acct;
+    ASSERT_TRUE( accounts.retrieve( m_accounts[ 2 ].getKey(), acct ) );
+    ASSERT_EQ( m_accounts[ 3 ], acct );
+    ASSERT_EQ( m_accounts[ 5 ], accounts.at( m_accounts[ 5 ].getKey() ) );
+    ASSERT_THROW( accounts.at( Account( "Nobody", 9, 9, 9 ).getKey() ), std::out_of_range );
+
+    ASSERT_TRUE( accounts.erase( m_accounts[ 0 ].getKey() ) );
+    ASSERT_FALSE( accounts.erase( m_accounts[ 0 ].getKey() ) );
+    ASSERT_EQ( nullptr, accounts.find( m_accounts[ 0 ].getKey() ) );
+    ASSERT_EQ( 7u, accounts.size() );
+
+    // Copies are independent.
+    auto copy = accounts;
+    copy.clear();
+    ASSERT_TRUE( copy.empty() );
+    ASSERT_EQ( 0u, copy.block_count() );
+    ASSERT_EQ( 1u, accounts.count( m_accounts[ 7 ].getKey() ) );
+}
+
+TEST_F(HTTest, UnrolledGrowth)
+{
+    ac::UnrolledHashTbl< int, int > table;
+    for ( int i = 0; i < 20000; ++i )
+        table[ i ] = 2 * i;
+    ASSERT_EQ( 20000u, table.size() );
+    ASSERT_LE( table.load_factor(), table.max_load_factor() );
+    // Chains are short: most buckets need a single block.
+    ASSERT_LT( table.block_count(), table.bucket_count() );
+
+    for ( int i = 0; i < 20000; i += 2 )
+        ASSERT_TRUE( table.erase( i ) );
+    for ( int i = 0; i < 20000; ++i )
+    {
+        auto data = table.find( i );
+        if ( i % 2 == 0 )
+            ASSERT_EQ( nullptr, data );
+        else
+            ASSERT_EQ( 2 * i, *data );
+    }
+
+    // Long chains span several blocks.
+    ac::UnrolledHashTbl< int, int > dense( 2 );
+    dense.max_load_factor( 50.f );
+    for ( int i = 0; i < 100; ++i )
+        dense.insert( i, i );
+    ASSERT_EQ( 3u, dense.bucket_count() );
+    ASSERT_GE( dense.block_count(), 100u / decltype( dense )::SLOTS );
+    for ( int i = 0; i < 100; i += 3 )
+        ASSERT_TRUE( dense.erase( i ) );
+    for ( int i = 0; i < 100; ++i )
+        ASSERT_EQ( i % 3 != 0, dense.count( i ) == 1 );
+}
+
+TEST_F(HTTest, UnrolledStablePointers)
+{
+    ac::UnrolledHashTbl< Account::AcctKey, Account, KeyHash, KeyEqual, true > accounts( 2 );
+    for ( auto & e : m_accounts )
+        accounts.insert( e.getKey(), e );
+    Account * first = accounts.find( m_accounts[ 1 ].getKey() );
+
+    // Growth and erasures do not move the entry.
+    for ( int i = 0; i < 1000; ++i )
+        accounts.insert( Account( "Filler", 1, 1, i ).getKey(), Account( "Filler", 1, 1, i ) );
+    for ( int i = 0; i < 1000; i += 2 )
+        accounts.erase( Account( "Filler", 1, 1, i ).getKey() );
+    ASSERT_EQ( first, accounts.find( m_accounts[ 1 ].getKey() ) );
+    ASSERT_EQ( m_accounts[ 1 ], *first );
+    ASSERT_EQ( 508u, accounts.size() );
+}
+
+// ============================================================================
+// TESTING IN-PLACE UPDATES
+// ============================================================================
+
+TEST_F(HTTest, UpdateInPlace)
+{
+    for ( auto & e : m_accounts )
+        ht_accounts.insert( e.getKey(), e );
+
+    ASSERT_TRUE( ht_accounts.update( m_accounts[ 3 ].getKey(), []( Account & a ){ a.m_balance += 100.f; } ) );
+    ASSERT_EQ( m_accounts[ 3 ].m_balance + 100.f, ht_accounts.find( m_accounts[ 3 ].getKey() )->m_balance );
+
+    Account absent( "Nobody", 9, 9, 9, 1.f );
+    int calls = 0;
+    ASSERT_FALSE( ht_accounts.update( absent.getKey(), [&]( Account & ){ ++calls; } ) );
+    ASSERT_EQ( 0, calls );
+    ASSERT_EQ( 8u, ht_accounts.size() );
+
+    // Upsert creates, then modifies.
+    auto deposit = [&]( float amount ){
+        return ht_accounts.upsert( absent.getKey(), [&]{ Account a = absent; a.m_balance = amount; return a; },
+                                   [&]( Account & a ){ a.m_balance += amount; } );
+    };
+    ASSERT_TRUE( deposit( 10.f ) );
+    ASSERT_FALSE( deposit( 5.f ) );
+    ASSERT_EQ( 15.f, ht_accounts.at( absent.getKey() ).m_balance );
+    ASSERT_EQ( 9u, ht_accounts.size() );
+}
+
+TEST_F(HTTest, ComputeInPlace)
+{
+    ac::HashTbl< int, int > counts;
+    counts.membership_filter( true );
+
+    // Absent keys start from a default value; returning false keeps them out.
+    ASSERT_FALSE( counts.compute( 1, []( int &, bool present ){ return present; } ) );
+    ASSERT_EQ( 0u, counts.size() );
+    for ( int i = 0; i < 1000; ++i )
+        ASSERT_TRUE( counts.compute( i % 10, []( int & n, bool ){ ++n; return true; } ) );
+    ASSERT_EQ( 10u, counts.size() );
+    ASSERT_EQ( 100, counts.at( 7 ) );
+
+    // Returning false erases.
+    ASSERT_FALSE( counts.compute( 7, []( int & n, bool present ){ EXPECT_TRUE( present ); return n < 100; } ) );
+    ASSERT_EQ( 9u, counts.size() );
+    ASSERT_EQ( nullptr, counts.find( 7 ) );
+    ASSERT_EQ( 0u, counts.count( 7 ) );
+}
+
+TEST_F(HTTest, ReplicatedUpdates)
+{
+    auto topo = ac::NumaTopology::emulated( 2 );
+    ac::ReplicatedHashTbl< int, int > table( topo );
+
+    // Concurrent increments are atomic per key and reach every replica.
+    std::vector< std::thread > writers;
+    for ( int t = 0; t < 4; ++t )
+        writers.emplace_back( [&]{
+            for ( int i = 0; i < 1000; ++i )
+                table.upsert( i % 50, []{ return 1; }, []( int & n ){ ++n; } );
+        } );
+    for ( auto & w : writers )
+        w.join();
+
+    int value;
+    for ( std::size_t node = 0; node < topo.nodes(); ++node )
+        for ( int k = 0; k < 50; ++k )
+        {
+            ASSERT_TRUE( table.retrieve( k, value, node ) );
+            ASSERT_EQ( 80, value );
+        }
+
+    int calls = 0;
+    ASSERT_TRUE( table.update( 3, [&]( int & n ){ ++calls; n = -n; } ) );
+    ASSERT_EQ( 1, calls );
+    ASSERT_FALSE( table.compute( 4, []( int &, bool ){ return false; } ) );
+    for ( std::size_t node = 0; node < topo.nodes(); ++node )
+    {
+        ASSERT_TRUE( table.retrieve( 3, value, node ) );
+        ASSERT_EQ( -80, value );
+        ASSERT_FALSE( table.retrieve( 4, value, node ) );
+    }
+    ASSERT_EQ( 49u, table.size() );
+}
+
+// ============================================================================
+// TESTING KEY-TYPE SPECIALIZATION
+// ============================================================================
+
+/// A padding-free key with no operator==.
+struct RouteKey { std::uint32_t m_from; std::uint32_t m_to; };
+
+TEST_F(HTTest, FastIntegerKeys)
+{
+    static_assert( std::is_same_v< ac::fast_hash_t< int >, ac::MixHash< int > > );
+    static_assert( std::is_same_v< ac::fast_hash_t< std::string >, std::hash< std::string > > );
+    static_assert( not ac::is_bitwise_key_v< float > );
+
+    // Keys that differ by multiples of the table size are spread over the buckets.
+    ac::FastHashTbl< int, std::string > ids( 10 );
+    ASSERT_EQ( 11u, ids.bucket_count() );
+    for ( int i = 1; i <= 8; ++i )
+        ASSERT_TRUE( ids.insert( 11 * i, std::to_string( i ) ) );
+    std::size_t longest = 0;
+    for ( int i = 1; i <= 8; ++i )
+        longest = std::max( longest, ids.count( 11 * i ) );
+    ASSERT_LT( longest, 8u );
+
+    for ( int i = 1; i <= 8; ++i )
+        ASSERT_EQ( std::to_string( i ), ids.at( 11 * i ) );
+    ASSERT_TRUE( ids.erase( 33 ) );
+    ASSERT_EQ( nullptr, ids.find( 33 ) );
+
+    ac::FastHashTbl< char, int > codes;
+    codes[ 'a' ] = 27;
+    ASSERT_EQ( 27, codes.at( 'a' ) );
+}
+
+TEST_F(HTTest, FastStructKeys)
+{
+    ac::FastHashTbl< RouteKey, int > routes;
+    for ( std::uint32_t i = 0; i < 1000; ++i )
+        ASSERT_TRUE( routes.insert( { i, i + 1 }, int( i ) ) );
+    ASSERT_FALSE( routes.insert( { 5, 6 }, -5 ) );
+    ASSERT_EQ( -5, *routes.find( { 5, 6 } ) );
+    ASSERT_EQ( nullptr, routes.find( { 6, 5 } ) );
+    ASSERT_EQ( 1000u, routes.size() );
+
+    // Hashes depend on every byte.
+    ac::MixHash< RouteKey > hashf;
+    ASSERT_NE( hashf( { 1, 2 } ), hashf( { 2, 1 } ) );
+    ASSERT_NE( hashf( { 0, 1 } ), hashf( { 0, 2 } ) );
+}
+
+// ============================================================================
+// TESTING BUCKET ALLOCATION
+// ============================================================================
+
+TEST_F(HTTest, AllocateArray)
+{
+    auto heap = ac::allocate_array< std::forward_list< int > >( 1000 );
+    ASSERT_EQ( 0u, reinterpret_cast< std::uintptr_t >( heap.get() ) % ac::CACHE_LINE_SIZE );
+    ASSERT_EQ( ac::PagePolicy::DEFAULT, heap.get_deleter().pages() );
+    for ( std::size_t i = 0; i < 1000; ++i )
+        ASSERT_TRUE( heap[ i ].empty() );
+
+    ac::AllocationPolicy huge{ ac::PagePolicy::TRANSPARENT_HUGE, true, 0 };
+    auto mapped = ac::allocate_array< std::forward_list< int > >( 1000, huge );
+    ASSERT_EQ( ac::PagePolicy::TRANSPARENT_HUGE, mapped.get_deleter().pages() );
+    ASSERT_EQ( 0u, reinterpret_cast< std::uintptr_t >( mapped.get() ) % ac::HUGE_PAGE_SIZE );
+    mapped[ 999 ].push_front( 1 );
+
+    // Explicit huge pages fall back to transparent ones when none are reserved.
+    huge.m_pages = ac::PagePolicy::EXPLICIT_HUGE;
+    auto hugetlb = ac::allocate_array< std::forward_list< int > >( 1000, huge );
+    ASSERT_NE( ac::PagePolicy::DEFAULT, hugetlb.get_deleter().pages() );
+    ASSERT_TRUE( hugetlb[ 0 ].empty() );
+}
+
+TEST_F(HTTest, HugePageBuckets)
+{
+    ac::AllocationPolicy policy{ ac::PagePolicy::TRANSPARENT_HUGE, false, 1 << 16 };
+    ac::HashTbl< int, int > table( 11, policy );
+    ASSERT_EQ( ac::PagePolicy::DEFAULT, table.bucket_pages() ); // Below the threshold.
+
+    for ( int i = 0; i < 20000; ++i )
+        table.insert( i, i );
+    ASSERT_EQ( ac::PagePolicy::TRANSPARENT_HUGE, table.bucket_pages() );
+    auto copy = table;
+    ASSERT_EQ( ac::PagePolicy::TRANSPARENT_HUGE, copy.bucket_pages() );
+    ASSERT_EQ( 12345, copy.at( 12345 ) );
+
+    // Changing the policy reallocates the buckets.
+    table.allocation_policy( ac::AllocationPolicy{ } );
+    ASSERT_EQ( ac::PagePolicy::DEFAULT, table.bucket_pages() );
+    for ( int i = 0; i < 20000; ++i )
+        ASSERT_EQ( i, *table.find( i ) );
+    table.clear( true );
+    ASSERT_TRUE( table.empty() );
+}
+
+// ============================================================================
+// TESTING SHARED TABLES
+// ============================================================================
+
+/// A fixed-size account record, storable in a shared table.
+struct Balance { int m_number; float m_balance; };
+
+TEST_F(HTTest, SharedTable)
+{
+    std::string path = ::testing::TempDir() + "balances.tbl";
+    {
+        auto table = ac::SharedHashTbl< int, Balance >::create( path, 1000 );
+        ASSERT_TRUE( table.empty() );
+        for ( int i = 0; i < 1000; ++i )
+            ASSERT_TRUE( table.insert( i, { i, i * 1.5f } ) );
+        ASSERT_THROW( table.insert( 1000, { } ), std::length_error );
+
+        // Erased slots are reused.
+        ASSERT_TRUE( table.erase( 10 ) );
+        ASSERT_FALSE( table.erase( 10 ) );
+        ASSERT_TRUE( table.insert( 1000, { 1000, 1.f } ) );
+        ASSERT_TRUE( table.update( 20, []( Balance & b ){ b.m_balance = -1.f; } ) );
+        table.sync();
+    }
+
+    // Reopening is just mapping the file.
+    auto reader = ac::SharedHashTbl< int, Balance >::open( path );
+    ASSERT_FALSE( reader.writable() );
+    ASSERT_EQ( 1000u, reader.size() );
+    ASSERT_EQ( 1000u, reader.entries().size() );
+    Balance b;
+    ASSERT_FALSE( reader.retrieve( 10, b ) );
+    ASSERT_TRUE( reader.retrieve( 20, b ) );
+    ASSERT_EQ( -1.f, b.m_balance );
+    ASSERT_TRUE( reader.retrieve( 999, b ) );
+    ASSERT_EQ( 999 * 1.5f, b.m_balance );
+    ASSERT_THROW( reader.insert( 1, { } ), std::logic_error );
+
+    // Writes through another mapping are visible at once.
+    auto writer = ac::SharedHashTbl< int, Balance >::open( path, ac::SharedHashTbl< int, Balance >::Access::READ_WRITE );
+    writer.clear();
+    ASSERT_TRUE( reader.empty() );
+    ASSERT_EQ( 0u, reader.count( 20 ) );
+
+    ASSERT_THROW( ( ac::SharedHashTbl< int, int >::open( path ) ), std::invalid_argument );
+    ASSERT_THROW( ( ac::SharedHashTbl< int, Balance >::open( path + ".missing" ) ), std::system_error );
+}
+
+TEST_F(HTTest, SharedAcrossProcesses)
+{
+    using Table = ac::SharedHashTbl< int, Balance >;
+    std::string path = ::testing::TempDir() + "shared.tbl";
+    auto table = Table::create( path, 101 );
+    for ( int i = 0; i < 100; ++i )
+        table.insert( i, { i, 0.f } );
+
+    // A child process keeps updating the balances two at a time (their sum stays 0)...
+    pid_t child = fork();
+    ASSERT_GE( child, 0 );
+    if ( child == 0 )
+    {
+        try
+        {
+            auto writer = Table::open( path, Table::Access::READ_WRITE );
+            for ( int round = 1; round <= 2000; ++round )
+                for ( int i = 0; i < 100; i += 2 )
+                {
+                    writer.update( i, [&]( Balance & b ){ b.m_balance = float( round ); } );
+                    writer.update( i + 1, [&]( Balance & b ){ b.m_balance = float( -round ); } );
+                }
+            writer.insert( -1, { -1, 1.f } ); // Done.
+        }
+        catch ( ... )
+        {
+            _exit( 1 );
+        }
+        _exit( 0 );
+    }
+
+    // ...while this one reads it through a read-only mapping; entries are never torn.
+    auto reader = Table::open( path );
+    Balance b;
+    int status = 0;
+    while ( not reader.retrieve( -1, b ) and waitpid( child, &status, WNOHANG ) == 0 )
+        for ( int i = 0; i < 100; ++i )
+        {
+            ASSERT_TRUE( reader.retrieve( i, b ) );
+            ASSERT_EQ( i, b.m_number );
+        }
+    waitpid( child, &status, 0 );
+    ASSERT_TRUE( WIFEXITED( status ) and WEXITSTATUS( status ) == 0 );
+
+    float sum = 0;
+    for ( const auto & en : reader.entries() )
+        sum += en.m_key >= 0 ? en.m_data.m_balance : 0.f;
+    ASSERT_EQ( 0.f, sum );
+    ASSERT_TRUE( reader.retrieve( 0, b ) );
+    ASSERT_EQ( 2000.f, b.m_balance );
+}
+
+TEST_F(HTTest, SharedWriterDies)
+{
+    using Table = ac::SharedHashTbl< int, Balance >;
+    std::string path = ::testing::TempDir() + "dead.tbl";
+    Balance b;
+    {
+        // Creating a table over a file leaves the processes mapping it alone.
+        auto old_table = Table::create( path, 10 );
+        ASSERT_TRUE( old_table.insert( 1, { 1, 1.f } ) );
+        auto table = Table::create( path, 10 );
+        ASSERT_TRUE( old_table.retrieve( 1, b ) );
+        ASSERT_FALSE( Table::open( path ).retrieve( 1, b ) );
+        ASSERT_TRUE( table.insert( 1, { 1, 1.f } ) );
+    }
+
+    // A child dies in the middle of a write, holding the lock.
+    pid_t child = fork();
+    ASSERT_GE( child, 0 );
+    if ( child == 0 )
+    {
+        try
+        {
+            auto writer = Table::open( path, Table::Access::READ_WRITE );
+            writer.update( 1, []( Balance & ){ _exit( 0 ); } );
+        }
+        catch ( ... ) { }
+        _exit( 1 );
+    }
+    int status = 0;
+    waitpid( child, &status, 0 );
+    ASSERT_TRUE( WIFEXITED( status ) and WEXITSTATUS( status ) == 0 );
+
+    // Readers give up instead of waiting forever; a writable mapping marks the table.
+    auto reader = Table::open( path );
+    auto writer = Table::open( path, Table::Access::READ_WRITE );
+    ASSERT_THROW( reader.retrieve( 1, b ), std::runtime_error );
+    ASSERT_TRUE( reader.consistent() );
+    ASSERT_THROW( writer.retrieve( 1, b ), std::runtime_error );
+    ASSERT_FALSE( reader.consistent() );
+    ASSERT_THROW( reader.entries(), std::runtime_error );
+    ASSERT_THROW( writer.insert( 2, { 2, 2.f } ), std::runtime_error );
+
+    // Clearing makes it usable again.
+    writer.clear();
+    ASSERT_TRUE( reader.consistent() );
+    ASSERT_TRUE( writer.insert( 2, { 2, 2.f } ) );
+    ASSERT_TRUE( reader.retrieve( 2, b ) );
+    ASSERT_EQ( 2.f, b.m_balance );
+}
+
+// ============================================================================
+// TESTING OBSERVERS
+// ============================================================================
+
+/// Records the events of a table.
+struct EventLog : ac::HashTblObserver {
+    std::vector< ac::RehashEvent > m_starts, m_ends;
+    std::vector< std::pair< std::size_t, std::size_t > > m_chains;
+    std::size_t m_failed_bytes = 0;
+
+    void on_rehash_start( const ac::RehashEvent & e_ ) override { m_starts.push_back( e_ ); }
+    void on_rehash_end( const ac::RehashEvent & e_ ) override { m_ends.push_back( e_ ); }
+    void on_long_chain( std::size_t bucket_, std::size_t length_ ) override { m_chains.emplace_back( bucket_, length_ ); }
+    void on_allocation_failure( std::size_t bytes_ ) override { m_failed_bytes = bytes_; }
+};
+
+/// Sends every key to the same bucket.
+struct ConstantHash { std::size_t operator()( int ) const { return 0; } };
+
+TEST_F(HTTest, RehashEvents)
+{
+    EventLog log;
+    ac::HashTbl< int, int > table;
+    table.observer( &log );
+    ASSERT_EQ( &log, table.observer() );
+    for ( int i = 0; i < 1000; ++i )
+        table.insert( i, i );
+
+    ASSERT_FALSE( log.m_starts.empty() );
+    ASSERT_EQ( log.m_starts.size(), log.m_ends.size() );
+    for ( std::size_t i = 0; i < log.m_ends.size(); ++i )
+    {
+        ASSERT_EQ( log.m_starts[ i ].m_new_buckets, log.m_ends[ i ].m_new_buckets );
+        ASSERT_LT( log.m_ends[ i ].m_old_buckets, log.m_ends[ i ].m_new_buckets );
+        ASSERT_GE( log.m_ends[ i ].m_duration.count(), 0 );
+    }
+    ASSERT_EQ( table.bucket_count(), log.m_ends.back().m_new_buckets );
+
+    // Copies do not report to the observer.
+    auto copy = table;
+    ASSERT_EQ( nullptr, copy.observer() );
+    table.observer( nullptr );
+    table.insert( 5000, 0 );
+    table.reserve( 100000 );
+    ASSERT_EQ( log.m_starts.size(), log.m_ends.size() );
+    ASSERT_LT( log.m_ends.back().m_new_buckets, table.bucket_count() );
+}
+
+TEST_F(HTTest, LongChainAndAllocationEvents)
+{
+    EventLog log;
+    ac::HashTbl< int, int, ConstantHash > table;
+    table.observer( &log );
+    table.long_chain_threshold( 4 );
+    for ( int i = 0; i < 6; ++i )
+        table.insert( i, i );
+    ASSERT_EQ( 2u, log.m_chains.size() );
+    ASSERT_EQ( 0u, log.m_chains[ 0 ].first );
+    ASSERT_EQ( 6u, log.m_chains[ 1 ].second );
+
+    // Elements with equal keys make long chains too.
+    EventLog multi_log;
+    ac::HashMultiTbl< int, int > multi;
+    multi.observer( &multi_log );
+    multi.long_chain_threshold( 4 );
+    for ( int i = 0; i < 6; ++i )
+        multi.insert( 7, i );
+    ASSERT_EQ( 2u, multi_log.m_chains.size() );
+    ASSERT_EQ( 6u, multi_log.m_chains.back().second );
+
+    // A batch reports each bucket it grew once, after it is applied.
+    EventLog batch_log;
+    ac::HashTbl< int, int, ConstantHash > batched;
+    batched.observer( &batch_log );
+    batched.long_chain_threshold( 4 );
+    std::vector< ac::HashMutation< int, int > > batch;
+    for ( int i = 0; i < 6; ++i )
+        batch.emplace_back( ac::MutationKind::INSERT, i, i );
+    batched.apply_batch( batch.begin(), batch.end(), 2 );
+    ASSERT_EQ( 1u, batch_log.m_chains.size() );
+    ASSERT_EQ( 6u, batch_log.m_chains[ 0 ].second );
+
+    // A bucket array larger than the policy allows.
+    ac::AllocationPolicy capped;
+    capped.m_max_bytes = 1 << 20;
+    table.allocation_policy( capped );
+    ASSERT_THROW( table.reserve( 1 << 20 ), std::bad_alloc );
+    ASSERT_GT( log.m_failed_bytes, std::size_t( 1 ) << 20 );
+    ASSERT_EQ( 6u, table.size() );
+    ASSERT_EQ( 3, table.at( 3 ) );
+}
+
+// ============================================================================
+// TESTING KEY/DATA SEPARATION
+// ============================================================================
+
+TEST_F(HTTest, SplitTable)
+{
+    ac::SplitHashTbl< Account::AcctKey, Account, KeyHash, KeyEqual > accounts( 4 );
+    for ( auto & e : m_accounts )
+        ASSERT_TRUE( accounts.insert( e.getKey(), e ) );
+    ASSERT_EQ( 8u, accounts.size() );
+    ASSERT_FALSE( accounts.insert( m_accounts[ 1 ].getKey(), m_accounts[ 2 ] ) );
+
+    Account acct;
+    ASSERT_TRUE( accounts.retrieve( m_accounts[ 1 ].getKey(), acct ) );
+    ASSERT_EQ( m_accounts[ 2 ], acct );
+    ASSERT_TRUE( accounts.update( m_accounts[ 3 ].getKey(), []( Account & a ){ a.m_balance = 0.f; } ) );
+    ASSERT_EQ( 0.f, accounts.at( m_accounts[ 3 ].getKey() ).m_balance );
+    ASSERT_THROW( accounts.at( Account( "Nobody" ).getKey() ), std::out_of_range );
+
+    // Data items do not move when the table grows, and erased slots are reused.
+    const Account * fifth = accounts.find( m_accounts[ 5 ].getKey() );
+    for ( int i = 0; i < 1000; ++i )
+        accounts[ Account( "Filler", 1, 1, i ).getKey() ].m_number = i;
+    ASSERT_EQ( fifth, accounts.find( m_accounts[ 5 ].getKey() ) );
+    ASSERT_EQ( 999, accounts.at( Account( "Filler", 1, 1, 999 ).getKey() ).m_number );
+
+    ASSERT_TRUE( accounts.erase( m_accounts[ 0 ].getKey() ) );
+    ASSERT_FALSE( accounts.erase( m_accounts[ 0 ].getKey() ) );
+    ASSERT_EQ( 0u, accounts.count( m_accounts[ 0 ].getKey() ) );
+    ASSERT_TRUE( accounts.insert( m_accounts[ 0 ].getKey(), m_accounts[ 0 ] ) );
+    ASSERT_EQ( 1008u, accounts.size() );
+
+    std::size_t visited = 0;
+    accounts.for_each( [&]( const Account::AcctKey & k, const Account & a ){ visited += ( accounts.find( k ) == &a ); } );
+    ASSERT_EQ( 1008u, visited );
+
+    auto copy = accounts;
+    accounts.clear();
+    ASSERT_TRUE( accounts.empty() );
+    ASSERT_EQ( m_accounts[ 0 ], copy.at( m_accounts[ 0 ].getKey() ) );
+}
+
+// ============================================================================
+// TESTING NODE HANDLES
+// ============================================================================
+
+TEST_F(HTTest, ExtractAndInsertNode)
+{
+    ac::HashTbl< Account::AcctKey, Account, KeyHash, KeyEqual > north{ 4 }, south{ 4 };
+    for ( auto & e : m_accounts )
+        north.insert( e.getKey(), e );
+
+    const Account * stored = north.find( m_accounts[ 2 ].getKey() );
+    auto node = north.extract( m_accounts[ 2 ].getKey() );
+    ASSERT_TRUE( node );
+    ASSERT_EQ( m_accounts[ 2 ].getKey(), node.key() );
+    ASSERT_EQ( stored, &node.data() );
+    ASSERT_EQ( 7u, north.size() );
+    ASSERT_EQ( nullptr, north.find( m_accounts[ 2 ].getKey() ) );
+    ASSERT_FALSE( north.extract( m_accounts[ 2 ].getKey() ) );
+
+    // The element is relinked, not copied.
+    ASSERT_TRUE( south.insert( std::move( node ) ) );
+    ASSERT_TRUE( node.empty() );
+    ASSERT_EQ( stored, south.find( m_accounts[ 2 ].getKey() ) );
+    ASSERT_FALSE( south.insert( std::move( node ) ) );
+
+    // A key already present leaves the element in the handle.
+    auto again = north.extract( m_accounts[ 3 ].getKey() );
+    south.insert( m_accounts[ 3 ].getKey(), m_accounts[ 0 ] );
+    ASSERT_FALSE( south.insert( std::move( again ) ) );
+    ASSERT_EQ( m_accounts[ 3 ], again.data() );
+    ASSERT_EQ( m_accounts[ 0 ], south.at( m_accounts[ 3 ].getKey() ) );
+
+    // A handle can also be made from a key and data, then inserted.
+    ac::HashNode< Account::AcctKey, Account > made( m_accounts[ 4 ].getKey(), m_accounts[ 4 ] );
+    ASSERT_TRUE( south.insert( std::move( made ) ) );
+    ASSERT_EQ( m_accounts[ 4 ], south.at( m_accounts[ 4 ].getKey() ) );
+}
+
+TEST_F(HTTest, MergeTables)
+{
+    ac::HashTbl< Account::AcctKey, Account, KeyHash, KeyEqual > north{ 4 }, south{ 4 };
+    for ( auto & e : m_accounts )
+        north.insert( e.getKey(), e );
+    south.insert( m_accounts[ 0 ].getKey(), m_accounts[ 7 ] );
+    south.insert( m_accounts[ 1 ].getKey(), m_accounts[ 7 ] );
+
+    std::vector< const Account * > stored;
+    for ( auto & e : m_accounts )
+        stored.push_back( north.find( e.getKey() ) );
+
+    ASSERT_EQ( 6u, south.merge( north ) );
+    ASSERT_EQ( 8u, south.size() );
+    ASSERT_EQ( 2u, north.size() );
+    ASSERT_EQ( m_accounts[ 7 ], south.at( m_accounts[ 0 ].getKey() ) );
+    ASSERT_EQ( m_accounts[ 0 ], north.at( m_accounts[ 0 ].getKey() ) );
+    ASSERT_EQ( m_accounts[ 1 ], north.at( m_accounts[ 1 ].getKey() ) );
+    for ( std::size_t i = 2; i < m_accounts.size(); ++i )
+    {
+        ASSERT_EQ( stored[ i ], south.find( m_accounts[ i ].getKey() ) );
+        ASSERT_EQ( nullptr, north.find( m_accounts[ i ].getKey() ) );
+    }
+    ASSERT_EQ( 0u, south.merge( south ) );
+
+    // Tables hashing differently merge too.
+    ac::FastHashTbl< int, int > ints;
+    ac::HashTbl< int, int > plain;
+    for ( int i = 0; i < 100; ++i )
+        plain.insert( i, i * i );
+    ASSERT_EQ( 100u, ints.merge( plain ) );
+    ASSERT_TRUE( plain.empty() );
+    ASSERT_EQ( 81, ints.at( 9 ) );
+    ASSERT_EQ( 100u, ints.size() );
+}
+
+// ============================================================================
+// TESTING COMPACT LAYOUT
+// ============================================================================
+
+TEST_F(HTTest, CompactTable)
+{
+    ac::CompactHashTbl< Account::AcctKey, Account, KeyHash, KeyEqual > accounts( 4 );
+    for ( auto & e : m_accounts )
+        ASSERT_TRUE( accounts.insert( e.getKey(), e ) );
+    ASSERT_EQ( 8u, accounts.size() );
+    ASSERT_FALSE( accounts.insert( m_accounts[ 1 ].getKey(), m_accounts[ 1 ] ) );
+
+    Account acct;
+    ASSERT_TRUE( accounts.retrieve( m_accounts[ 4 ].getKey(), acct ) );
+    ASSERT_EQ( m_accounts[ 4 ], acct );
+    ASSERT_TRUE( accounts.update( m_accounts[ 4 ].getKey(), []( Account & a ){ a.m_balance = 0.f; } ) );
+    ASSERT_EQ( 0.f, accounts.at( m_accounts[ 4 ].getKey() ).m_balance );
+    ASSERT_THROW( accounts.at( Account( "Nobody" ).getKey() ), std::out_of_range );
+    ASSERT_EQ( 1u, accounts.count( m_accounts[ 7 ].getKey() ) );
+
+    // Iteration follows insertion order.
+    std::size_t i = 0;
+    for ( const auto & en : accounts )
+        ASSERT_EQ( m_accounts[ i++ ].getKey(), en.m_key );
+    ASSERT_EQ( 8u, i );
+}
+
+TEST_F(HTTest, CompactInsertionOrder)
+{
+    ac::CompactHashTbl< int, int > table;
+    for ( int i = 0; i < 1000; ++i )
+        table[ 999 - i ] = i;
+    ASSERT_EQ( 1000u, table.size() );
+    ASSERT_LE( table.load_factor(), table.max_load_factor() );
+
+    for ( int i = 0; i < 1000; i += 2 )
+        ASSERT_TRUE( table.erase( i ) );
+    ASSERT_FALSE( table.erase( 0 ) );
+    ASSERT_EQ( 500u, table.size() );
+    table.insert( 0, -1 );
+
+    // Growing, erasing and compacting never reorder the entries.
+    std::vector< int > keys;
+    table.for_each( [&]( int k, int ){ keys.push_back( k ); } );
+    ASSERT_EQ( 501u, keys.size() );
+    for ( std::size_t j = 0; j < 500; ++j )
+        ASSERT_EQ( 999 - 2 * int( j ), keys[ j ] );
+    ASSERT_EQ( 0, keys.back() );
+
+    table.shrink_to_fit();
+    ASSERT_EQ( 0u, table.holes() );
+    ASSERT_EQ( keys.front(), table.begin()->m_key );
+    ASSERT_EQ( -1, table.at( 0 ) );
+    ASSERT_EQ( 8, table.at( 991 ) );
+    ASSERT_EQ( nullptr, table.find( 998 ) );
+
+    std::ostringstream os;
+    ac::CompactHashTbl< int, int > small;
+    small.insert( 3, 30 );
+    small.insert( 1, 10 );
+    small.insert( 2, 20 );
+    os << small;
+    ASSERT_EQ( "30\n10\n20\n", os.str() );
+
+    table.clear();
+    ASSERT_TRUE( table.empty() );
+    ASSERT_TRUE( table.begin() == table.end() );
+}
+
+TEST_F(HTTest, CompactFullIndex)
+{
+    // Misses end at an EMPTY slot, which even the highest load factor leaves.
+    ac::CompactHashTbl< int, int > table( 0 );
+    table.max_load_factor( 1.0f );
+    ASSERT_EQ( 1.0f, table.max_load_factor() );
+    for ( int i = 0; i < 64; ++i )
+    {
+        table.insert( i, i );
+        ASSERT_LT( table.size(), table.bucket_count() );
+        ASSERT_EQ( nullptr, table.find( 12345 ) );
+    }
+
+    table.max_load_factor( 4.0f );
+    ASSERT_EQ( 1.0f, table.max_load_factor() );
+    table.max_load_factor( 0.0f );
+    ASSERT_LT( 0.0f, table.max_load_factor() );
+    for ( int i = 64; i < 128; ++i )
+        table.insert( i, i );
+    ASSERT_EQ( nullptr, table.find( 12345 ) );
+    ASSERT_EQ( 127, table.at( 127 ) );
+}
+
+// ============================================================================
+// TESTING BATCH HASHING
+// ============================================================================
+
+struct FlowKey { std::uint64_t m_src; std::uint64_t m_dst; std::uint64_t m_port; };
+enum class Region : std::uint32_t { NORTH = 1, SOUTH = 0xffffffffu };
+
+// Every kernel the processor has must agree with MixHash, tail included.
+template< class KeyType >
+static void expect_batch_matches( const std::vector< KeyType > & keys_ )
+{
+    ac::MixHash< KeyType > hashf;
+    for ( auto level : { ac::SimdLevel::SCALAR, ac::SimdLevel::AVX2, ac::SimdLevel::AVX512 } )
+    {
+        if ( level > ac::cpu_simd_level() )
+            continue;
+        std::vector< std::size_t > out( keys_.size() );
+        ac::hash_batch( hashf, keys_.data(), keys_.size(), out.data(), level );
+        for ( std::size_t i = 0; i < keys_.size(); ++i )
+            ASSERT_EQ( hashf( keys_[ i ] ), out[ i ] ) << "level " << int( level ) << ", key " << i;
+    }
+}
+
+TEST_F(HTTest, BatchHashKernels)
+{
+    static_assert( ac::has_batch_kernel_v< ac::MixHash< int >, int > );
+    static_assert( ac::has_batch_kernel_v< ac::MixHash< FlowKey >, FlowKey > );
+    static_assert( not ac::has_batch_kernel_v< ac::MixHash< short >, short > );
+    static_assert( not ac::has_batch_kernel_v< std::hash< int >, int > );
+
+    std::vector< int > ints;
+    std::vector< std::uint32_t > uints;
+    std::vector< std::int64_t > longs;
+    std::vector< Region > regions;
+    std::vector< FlowKey > flows;
+    std::vector< RouteKey > routes;
+    for ( int i = 0; i < 1003; ++i )
+    {
+        ints.push_back( i * 7919 - 4000000 );
+        uints.push_back( 0xfffffff0u + i );
+        longs.push_back( std::int64_t( i ) * -123456789012LL );
+        regions.push_back( i % 2 ? Region::NORTH : Region::SOUTH );
+        flows.push_back( { std::uint64_t( i ), ~std::uint64_t( i ), std::uint64_t( i ) << 40 } );
+        routes.push_back( { std::uint32_t( i ), std::uint32_t( -i ) } );
+    }
+    expect_batch_matches( ints );
+    expect_batch_matches( uints );
+    expect_batch_matches( longs );
+    expect_batch_matches( regions );
+    expect_batch_matches( flows );
+    expect_batch_matches( routes );
+
+    // Any other hash is applied key by key.
+    std::vector< std::string > words{ "one", "two", "three" };
+    std::vector< std::size_t > out( words.size() );
+    ac::hash_batch( std::hash< std::string >{}, words.data(), words.size(), out.data() );
+    ASSERT_EQ( std::hash< std::string >{}( "two" ), out[ 1 ] );
+}
+
+TEST_F(HTTest, BatchInsertAndFind)
+{
+    ac::FastHashTbl< std::int64_t, int > table;
+    std::vector< std::int64_t > keys;
+    std::vector< int > data;
+    for ( int i = 0; i < 5000; ++i )
+    {
+        keys.push_back( std::int64_t( i % 4000 ) * 1000003 );
+        data.push_back( i );
+    }
+
+    // Grown once, then rehashed through the batch path.
+    ASSERT_EQ( 4000u, table.insert_batch( keys.data(), data.data(), keys.size() ) );
+    ASSERT_EQ( 4000u, table.size() );
+    ASSERT_LE( table.load_factor(), table.max_load_factor() );
+    table.reserve( 20000 );
+    table.membership_filter( true );
+
+    std::vector< std::int64_t > wanted{ 0, 999 * 1000003LL, 3999 * 1000003LL, 7, -1000003 };
+    std::vector< const int * > found( wanted.size() );
+    ASSERT_EQ( 3u, table.find_batch( wanted.data(), wanted.size(), found.data() ) );
+    ASSERT_EQ( 4000, *found[ 0 ] );
+    ASSERT_EQ( 4999, *found[ 1 ] );
+    ASSERT_EQ( 3999, *found[ 2 ] );
+    ASSERT_EQ( nullptr, found[ 3 ] );
+    ASSERT_EQ( nullptr, found[ 4 ] );
+
+    table.shrink_to_fit();
+    for ( int i = 0; i < 4000; ++i )
+        ASSERT_EQ( i < 1000 ? i + 4000 : i, table.at( std::int64_t( i ) * 1000003 ) );
+
+    // Batches of mutations hash their keys together as well.
+    std::vector< ac::HashMutation< std::int64_t, int > > log;
+    for ( int i = 0; i < 600; ++i )
+        log.emplace_back( ac::MutationKind::ERASE, std::int64_t( i ) * 1000003 );
+    table.apply_batch( log.begin(), log.end() );
+    ASSERT_EQ( 3400u, table.size() );
+    ASSERT_EQ( 0u, table.find_batch( wanted.data(), 1, found.data() ) );
+}
+
+// ============================================================================
+// TESTING FLAT COMBINING
+// ============================================================================
+
+TEST_F(HTTest, CombiningTable)
+{
+    ac::CombiningHashTbl< Account::AcctKey, Account, KeyHash, KeyEqual > accounts( 4, 2 );
+    for ( auto & e : m_accounts )
+        ASSERT_TRUE( accounts.insert( e.getKey(), e ) );
+    ASSERT_EQ( 8u, accounts.size() );
+    ASSERT_FALSE( accounts.insert( m_accounts[ 0 ].getKey(), m_accounts[ 0 ] ) );
+
+    Account acct;
+    ASSERT_TRUE( accounts.update( m_accounts[ 1 ].getKey(), []( Account & a ){ a.m_balance += 1.f; } ) );
+    ASSERT_TRUE( accounts.retrieve( m_accounts[ 1 ].getKey(), acct ) );
+    ASSERT_EQ( m_accounts[ 1 ].m_balance + 1.f, acct.m_balance );
+    ASSERT_TRUE( accounts.erase( m_accounts[ 1 ].getKey() ) );
+    ASSERT_EQ( 0u, accounts.count( m_accounts[ 1 ].getKey() ) );
+    ASSERT_EQ( 7u, accounts.size() );
+
+    // Exceptions of the combined operations reach their caller.
+    ASSERT_THROW( accounts.update( m_accounts[ 2 ].getKey(), []( Account & ){ throw std::runtime_error( "rejected" ); } ),
+                  std::runtime_error );
+
+    std::size_t total = 0;
+    accounts.execute( [&]( const auto & table ){ total = table.size(); return true; } );
+    ASSERT_EQ( 7u, total );
+    accounts.clear();
+    ASSERT_TRUE( accounts.empty() );
+}
+
+TEST_F(HTTest, CombiningHotKeys)
+{
+    // More threads than slots, all writing the same few keys.
+    ac::CombiningHashTbl< int, long > counters( 11, 3 );
+    const int n_threads = 6, n_ops = 2000, n_keys = 4;
+
+    std::vector< std::thread > threads;
+    for ( int t = 0; t < n_threads; ++t )
+        threads.emplace_back( [&, t ]{
+            for ( int i = 0; i < n_ops; ++i )
+            {
+                counters.upsert( i % n_keys, []{ return 1L; }, []( long & c ){ ++c; } );
+                if ( i % 100 == 0 )
+                {
+                    counters.insert( 1000 + t, i );
+                    counters.erase( 1000 + t );
+                }
+            }
+        } );
+    for ( auto & th : threads )
+        th.join();
+
+    ASSERT_EQ( std::size_t( n_keys ), counters.size() );
+    long sum = 0, c = 0;
+    for ( int k = 0; k < n_keys; ++k )
+    {
+        ASSERT_TRUE( counters.retrieve( k, c ) );
+        ASSERT_EQ( long( n_threads * n_ops / n_keys ), c );
+        sum += c;
+    }
+    ASSERT_EQ( long( n_threads * n_ops ), sum );
+}
+
+// ============================================================================
+// TESTING HASH FLOODING
+// ============================================================================
+
+TEST_F(HTTest, HardenedTable)
+{
+    ac::HardenedHashTbl< Account::AcctKey, Account, KeyHash, KeyEqual > accounts( 2 );
+    for ( const auto & a : m_accounts )
+        ASSERT_TRUE( accounts.insert( a.getKey(), a ) );
+    ASSERT_FALSE( accounts.insert( m_accounts[ 0 ].getKey(), m_accounts[ 0 ] ) );
+    ASSERT_EQ( m_accounts.size(), accounts.size() );
+    ASSERT_EQ( 0u, accounts.tree_count() );
+
+    Account acct;
+    for ( const auto & a : m_accounts )
+    {
+        ASSERT_TRUE( accounts.retrieve( a.getKey(), acct ) );
+        ASSERT_EQ( a, acct );
+    }
+
+    auto copy = accounts;
+    ASSERT_EQ( accounts.seed(), copy.seed() );
+    ASSERT_TRUE( accounts.erase( m_accounts[ 3 ].getKey() ) );
+    ASSERT_FALSE( accounts.erase( m_accounts[ 3 ].getKey() ) );
+    ASSERT_THROW( accounts.at( m_accounts[ 3 ].getKey() ), std::out_of_range );
+    ASSERT_EQ( m_accounts[ 3 ], copy.at( m_accounts[ 3 ].getKey() ) );
+
+    accounts[ m_accounts[ 3 ].getKey() ] = m_accounts[ 3 ];
+    ASSERT_EQ( m_accounts.size(), accounts.size() );
+    accounts.clear();
+    ASSERT_TRUE( accounts.empty() );
+    ASSERT_EQ( m_accounts.size(), copy.size() );
+}
+
+TEST_F(HTTest, SeededHash)
+{
+    // SipHash-2-4 reference vectors: key 00..0f, messages 00..(n - 1).
+    const std::uint64_t k0 = 0x0706050403020100ULL, k1 = 0x0f0e0d0c0b0a0908ULL;
+    unsigned char msg[ 15 ];
+    for ( int i = 0; i < 15; ++i )
+        msg[ i ] = i;
+    ASSERT_EQ( 0x726fdb47dd0e0e31ULL, ac::siphash24( msg, 0, k0, k1 ) );
+    ASSERT_EQ( 0xa129ca6149be45e5ULL, ac::siphash24( msg, 15, k0, k1 ) );
+
+    ac::SeededHash< std::string > hashf;
+    ASSERT_EQ( hashf( "Bob", 1 ), hashf( "Bob", 1 ) );
+    ASSERT_NE( hashf( "Bob", 1 ), hashf( "Bob", 2 ) );
+    ASSERT_EQ( hashf( "Bob", 7 ), ac::SeededHash< std::string_view >{ }( "Bob", 7 ) );
+    ASSERT_NE( ac::SeededHash< int >{ }( 42, 1 ), ac::SeededHash< int >{ }( 42, 2 ) );
+
+    // Tables pick their own seeds, unless given one.
+    ac::HardenedHashTbl< std::string, int > a, b, c( 11, 1234 );
+    ASSERT_NE( a.seed(), b.seed() );
+    ASSERT_EQ( 1234u, c.seed() );
+    for ( int i = 0; i < 100; ++i )
+        c.insert( std::to_string( i ), i );
+    int value = -1;
+    ASSERT_TRUE( c.retrieve( "42", value ) );
+    ASSERT_EQ( 42, value );
+}
+
+TEST_F(HTTest, TreeifiedChains)
+{
+    // Every key collides: seeding cannot separate them, the trees keep lookups logarithmic.
+    ac::HardenedHashTbl< int, int, ConstantHash > flooded;
+    const int n = 5000;
+    for ( int i = 0; i < n; ++i )
+        ASSERT_TRUE( flooded.insert( i, 2 * i ) );
+    ASSERT_EQ( std::size_t( n ), flooded.size() );
+    ASSERT_EQ( 1u, flooded.tree_count() );
+    for ( int i = 0; i < n; ++i )
+    {
+        ASSERT_NE( nullptr, flooded.find( i ) );
+        ASSERT_EQ( 2 * i, *flooded.find( i ) );
+    }
+    ASSERT_EQ( nullptr, flooded.find( n ) );
+
+    std::size_t visited = 0;
+    flooded.for_each( [&]( int k, int d ){ visited += ( d == 2 * k ); } );
+    ASSERT_EQ( std::size_t( n ), visited );
+
+    // Back to a chain once the tree has shrunk to half the threshold.
+    for ( int i = 0; i < n - 4; ++i )
+        ASSERT_TRUE( flooded.erase( i ) );
+    ASSERT_EQ( 0u, flooded.tree_count() );
+    for ( int i = n - 4; i < n; ++i )
+        ASSERT_EQ( 2 * i, flooded.at( i ) );
+
+    // A threshold of 0 never treeifies.
+    ac::HardenedHashTbl< int, int, ConstantHash > chained;
+    chained.treeify_threshold( 0 );
+    for ( int i = 0; i < 100; ++i )
+        chained.insert( i, i );
+    ASSERT_EQ( 0u, chained.tree_count() );
+    ASSERT_EQ( 99, chained.at( 99 ) );
+
+    // Chain lengths stay right meanwhile: a short chain is not treeified later.
+    ac::HardenedHashTbl< int, int, ConstantHash > toggled( 1000 );
+    toggled.treeify_threshold( 0 );
+    toggled.insert( 1, 1 );
+    toggled.insert( 2, 2 );
+    ASSERT_TRUE( toggled.erase( 1 ) );
+    ASSERT_TRUE( toggled.erase( 2 ) );
+    toggled.treeify_threshold( 8 );
+    toggled.insert( 3, 3 );
+    ASSERT_EQ( 0u, toggled.tree_count() );
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);